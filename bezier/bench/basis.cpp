@@ -0,0 +1,147 @@
+/*
+ * bezier_basis: tessellate a curve into uniform segments over and over, evaluating every
+ * sample with allBernstein as draw used to or taking the weights from the basis table, and
+ * report as JSON what a tessellation cost each way, how far apart the samples came out and
+ * how far they strayed from de Casteljau's in double
+ *
+ * usage: bezier_basis [-count n] [-segments n] [-repeat n] [-seed n]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "BezierCurve.h"
+
+/* farthest in pixels a sample may lie from de Casteljau's */
+#define BASIS_MAX_ERROR 0.01f
+
+/* benchmark parameters */
+struct options {
+	int count;
+	int segments;
+	int repeat;
+	unsigned int seed;
+} options = { 100, 50, 2000, 1 };
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void parseArgs(int argc, char** argv) {
+	for(int i = 1; i < argc; i++) {
+		if(i + 1 >= argc) {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		} else if(strcmp(argv[i], "-count") == 0) {
+			options.count = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-segments") == 0) {
+			options.segments = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-repeat") == 0) {
+			options.repeat = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-seed") == 0) {
+			options.seed = (unsigned int) strtoul(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		}
+	}
+}
+
+/* a curve tessellated uniformly, without drawing */
+class BenchCurve : public BezierCurve {
+public:
+    BenchCurve() {
+        srand(options.seed);
+        for(int i = 0; i < options.count; i++) {
+            const float x = 640.0f * rand() / RAND_MAX;
+            appendPoint(x, 480.0f * rand() / RAND_MAX);
+        }
+    }
+
+    int getCount() { return net.getCount(); }
+
+    void tessellateDirect(point2d_t* out) {
+        for(int i = 0; i <= options.segments; i++) {
+            out[i] = getPoint((1.0f * i) / options.segments);
+        }
+    }
+
+    void tessellateTable(point2d_t* out) {
+        basis.prepare(net.getCount(), options.segments);
+        for(int i = 0; i <= options.segments; i++) {
+            int first, width;
+            const float* weights = basis.getRow(i, &first, &width);
+            out[i] = getPoint(weights, first, width);
+        }
+    }
+
+    /* de Casteljau in double, O(n^2) a sample but stable at any degree */
+    point2d_t getExactPoint(double u) {
+        const int count = net.getCount();
+        std::vector<double> x(net.getX(), net.getX() + count), y(net.getY(), net.getY() + count);
+        for(int j = 1; j < count; j++) {
+            for(int i = 0; i < count - j; i++) {
+                x[i] = (1.0 - u) * x[i] + u * x[i + 1];
+                y[i] = (1.0 - u) * y[i] + u * y[i + 1];
+            }
+        }
+        point2d_t pt = { (float) x[0], (float) y[0] };
+        return pt;
+    }
+};
+
+int main(int argc, char** argv) {
+	parseArgs(argc, argv);
+	if(options.segments < 1 || options.segments > BC_MAX_SEGMENTS) {
+		fprintf(stderr, "Segments must be between 1 and %d\n", BC_MAX_SEGMENTS);
+		return 1;
+	}
+
+	BenchCurve curve;
+	point2d_t direct[BC_MAX_SEGMENTS + 1], table[BC_MAX_SEGMENTS + 1];
+
+	double start = now();
+	for(int r = 0; r < options.repeat; r++) {
+		curve.tessellateDirect(direct);
+	}
+	const double directTime = (now() - start) / options.repeat;
+
+	// the first tessellation builds the table, as the first draw does
+	start = now();
+	curve.tessellateTable(table);
+	const double build = now() - start;
+
+	start = now();
+	for(int r = 0; r < options.repeat; r++) {
+		curve.tessellateTable(table);
+	}
+	const double tableTime = (now() - start) / options.repeat;
+
+	float worst = 0.0f;
+	for(int i = 0; i <= options.segments; i++) {
+		worst = fmaxf(worst, fmaxf(fabsf(direct[i].x - table[i].x), fabsf(direct[i].y - table[i].y)));
+	}
+
+	float error = 0.0f;
+	for(int i = 0; i <= options.segments; i++) {
+		const point2d_t exact = curve.getExactPoint((1.0 * i) / options.segments);
+		error = fmaxf(error, hypotf(table[i].x - exact.x, table[i].y - exact.y));
+	}
+
+	printf("{\n");
+	printf("  \"degree\": %d,\n", curve.getCount() - 1);
+	printf("  \"samples\": %d,\n", options.segments + 1);
+	printf("  \"direct_us\": %.2f,\n", directTime * 1e6);
+	printf("  \"table_build_us\": %.2f,\n", build * 1e6);
+	printf("  \"table_us\": %.2f,\n", tableTime * 1e6);
+	printf("  \"speedup\": %.1f,\n", tableTime > 0.0 ? directTime / tableTime : 0.0);
+	printf("  \"max_difference\": %g,\n", worst);
+	printf("  \"max_error\": %g\n", error);
+	printf("}\n");
+
+	return worst == 0.0f && error < BASIS_MAX_ERROR ? 0 : 1;
+}
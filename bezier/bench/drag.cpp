@@ -0,0 +1,119 @@
+/*
+ * bezier_drag: drag random points of a long curve around, bringing its samples up to date
+ * after every move by following the move with a delta or by tessellating again, and report
+ * as JSON what a drag cost each way and how far the followed samples drifted
+ *
+ * usage: bezier_drag [-count n] [-drags n] [-seed n]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "BezierCurve.h"
+
+/* farthest in pixels the followed samples may drift from tessellated ones */
+#define DRAG_MAX_DRIFT 0.01f
+
+/* benchmark parameters */
+struct options {
+	int count;
+	int drags;
+	unsigned int seed;
+} options = { 1000, 1000, 1 };
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void parseArgs(int argc, char** argv) {
+	for(int i = 1; i < argc; i++) {
+		if(i + 1 >= argc) {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		} else if(strcmp(argv[i], "-count") == 0) {
+			options.count = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-drags") == 0) {
+			options.drags = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-seed") == 0) {
+			options.seed = (unsigned int) strtoul(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		}
+	}
+}
+
+/* a curve dragged and brought up to date as draw does, without drawing */
+class BenchCurve : public BezierCurve {
+public:
+    BenchCurve() {
+        srand(options.seed);
+        for(int i = 0; i < options.count; i++) {
+            const float x = 640.0f * rand() / RAND_MAX;
+            appendPoint(x, 480.0f * rand() / RAND_MAX);
+        }
+    }
+
+    int getSegments() { return cachedSegments; }
+    const std::vector<point2d_t>& getSamples() { return samples; }
+    bool isCached() { return cached; }
+
+    void drag(int point, int x, int y) {
+        selected = point;
+        modifySelectedControlPoint(x, y);
+    }
+
+    void update(bool full) {
+        if(full) cached = false;
+        refresh();
+    }
+};
+
+int main(int argc, char** argv) {
+	parseArgs(argc, argv);
+
+	BenchCurve incremental, full;
+	incremental.update(false);
+	full.update(false);
+
+	// a drag is the move and bringing the samples up to date after it
+	double incrementalTime = 0.0, fullTime = 0.0;
+	int followed = 0;
+	float drift = 0.0f;
+	for(int d = 0; d < options.drags; d++) {
+		const int point = rand() % options.count;
+		const int x = (int) (640.0f * rand() / RAND_MAX);
+		const int y = (int) (480.0f * rand() / RAND_MAX);
+
+		double start = now();
+		incremental.drag(point, x, y);
+		if(incremental.isCached()) followed++;
+		incremental.update(false);
+		incrementalTime += now() - start;
+
+		start = now();
+		full.drag(point, x, y);
+		full.update(true);
+		fullTime += now() - start;
+
+		const std::vector<point2d_t>& a = incremental.getSamples();
+		const std::vector<point2d_t>& b = full.getSamples();
+		for(size_t i = 0; i < a.size() && a.size() == b.size(); i++) {
+			drift = fmaxf(drift, hypotf(a[i].x - b[i].x, a[i].y - b[i].y));
+		}
+	}
+
+	printf("{\n");
+	printf("  \"points\": %d,\n", options.count);
+	printf("  \"segments\": %d,\n", incremental.getSegments());
+	printf("  \"followed_by_delta\": %d,\n", followed);
+	printf("  \"incremental_drag_us\": %.2f,\n", incrementalTime / options.drags * 1e6);
+	printf("  \"full_drag_us\": %.2f,\n", fullTime / options.drags * 1e6);
+	printf("  \"speedup\": %.1f,\n", incrementalTime > 0.0 ? fullTime / incrementalTime : 0.0);
+	printf("  \"max_drift\": %g\n", drift);
+	printf("}\n");
+
+	return drift < DRAG_MAX_DRIFT ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/*
+ * bezier_evaluators: tessellate a curve over and over with each evaluator, check every sample
+ * against getPoint at its u and every segment's midpoint against its chord, and report as JSON
+ * how long a tessellation took, how many segments it made and how far it strayed
+ *
+ * usage: bezier_evaluators [-count n] [-tolerance f] [-repeat n] [-seed n]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "BezierCurve.h"
+
+/* benchmark parameters */
+struct options {
+	int count;
+	float tolerance;
+	int repeat;
+	unsigned int seed;
+} options = { 4, BC_TOLERANCE, 200, 1 };
+
+/** what one evaluator made of the curve */
+struct result {
+	const char* name;
+	int evaluator;
+	int segments;
+	double time;
+	float error, deviation;
+};
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void parseArgs(int argc, char** argv) {
+	for(int i = 1; i < argc; i++) {
+		if(i + 1 >= argc) {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		} else if(strcmp(argv[i], "-count") == 0) {
+			options.count = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-tolerance") == 0) {
+			options.tolerance = atof(argv[++i]);
+		} else if(strcmp(argv[i], "-repeat") == 0) {
+			options.repeat = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-seed") == 0) {
+			options.seed = (unsigned int) strtoul(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		}
+	}
+}
+
+static float distance(point2d_t a, point2d_t b) {
+	return hypotf(a.x - b.x, a.y - b.y);
+}
+
+/* a curve tessellated the way draw does, without drawing */
+class BenchCurve : public BezierCurve {
+public:
+    BenchCurve() {
+        srand(options.seed);
+        for(int i = 0; i < options.count; i++) {
+            const float x = 640.0f * rand() / RAND_MAX;
+            appendPoint(x, 480.0f * rand() / RAND_MAX);
+        }
+        setTolerance(options.tolerance);
+    }
+
+    void run(struct result& r) {
+        setEvaluator(r.evaluator);
+
+        double start = now();
+        for(int i = 0; i < options.repeat; i++) {
+            tessellate();
+        }
+        r.time = (now() - start) / options.repeat;
+        r.segments = (int) samples.size() - 1;
+
+        r.error = r.deviation = 0.0f;
+        for(size_t i = 0; i < samples.size(); i++) {
+            r.error = fmaxf(r.error, distance(samples[i], getPoint(params[i])));
+        }
+        for(size_t i = 0; i + 1 < samples.size(); i++) {
+            r.deviation = fmaxf(r.deviation, chordDistance(samples[i], samples[i + 1],
+                getPoint(0.5f * (params[i] + params[i + 1]))));
+        }
+    }
+
+protected:
+    /* how far p lies from the segment a .. b */
+    static float chordDistance(point2d_t a, point2d_t b, point2d_t p) {
+        const float dx = b.x - a.x, dy = b.y - a.y;
+        const float length2 = dx * dx + dy * dy;
+        float t = length2 > 0.0f ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length2 : 0.0f;
+        t = fminf(fmaxf(t, 0.0f), 1.0f);
+        point2d_t q = { a.x + t * dx, a.y + t * dy };
+        return distance(p, q);
+    }
+};
+
+static void report(const struct result& r, bool last) {
+	printf("    \"%s\": {\n", r.name);
+	printf("      \"segments\": %d,\n", r.segments);
+	printf("      \"tessellate_us\": %.2f,\n", r.time * 1e6);
+	printf("      \"max_error\": %g,\n", r.error);
+	printf("      \"max_deviation\": %g\n", r.deviation);
+	printf("    }%s\n", last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+	parseArgs(argc, argv);
+
+	BenchCurve curve;
+	struct result results[] = {
+		{ "bernstein", BC_BERNSTEIN, 0, 0.0, 0.0f, 0.0f },
+		{ "table", BC_TABLE, 0, 0.0, 0.0f, 0.0f },
+		{ "forward", BC_FORWARD, 0, 0.0, 0.0f, 0.0f },
+		{ "subdivide", BC_SUBDIVIDE, 0, 0.0, 0.0f, 0.0f }
+	};
+	const int n = sizeof(results) / sizeof(results[0]);
+
+	bool within = true;
+	for(int i = 0; i < n; i++) {
+		curve.run(results[i]);
+		within = within && results[i].error <= options.tolerance &&
+			results[i].deviation <= options.tolerance;
+	}
+
+	printf("{\n");
+	printf("  \"degree\": %d,\n", options.count - 1);
+	printf("  \"tolerance\": %g,\n", options.tolerance);
+	printf("  \"evaluators\": {\n");
+	for(int i = 0; i < n; i++) {
+		report(results[i], i == n - 1);
+	}
+	printf("  },\n");
+	printf("  \"within_tolerance\": %s\n", within ? "true" : "false");
+	printf("}\n");
+
+	return within ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+/*
+ * bezier_spline: check BSplineCurve against a Bezier curve of the same points and against a
+ * circle made as a rational quadratic, then drag random points of a long spline around and
+ * report as JSON what bringing it up to date cost evaluating only the spans that moved and
+ * evaluating all of them
+ *
+ * usage: bezier_spline [-count n] [-drags n] [-seed n]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "BSplineCurve.h"
+#include "BezierCurve.h"
+
+/* farthest in pixels the checks allow the curves to be apart */
+#define SPLINE_MAX_ERROR 0.01f
+
+/* benchmark parameters */
+struct options {
+	int count;
+	int drags;
+	unsigned int seed;
+} options = { 5000, 1000, 1 };
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void parseArgs(int argc, char** argv) {
+	for(int i = 1; i < argc; i++) {
+		if(i + 1 >= argc) {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		} else if(strcmp(argv[i], "-count") == 0) {
+			options.count = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-drags") == 0) {
+			options.drags = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-seed") == 0) {
+			options.seed = (unsigned int) strtoul(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		}
+	}
+}
+
+/* a Bezier curve that hands out its points */
+class BenchBezier : public BezierCurve {
+public:
+    void add(float x, float y) { appendPoint(x, y); }
+    point2d_t at(float u) { return getPoint(u); }
+};
+
+/* a spline that can be dragged and brought up to date without drawing */
+class BenchSpline : public BSplineCurve {
+public:
+    void add(float x, float y, float weight = 1.0f) { appendPoint(x, y, weight); }
+    point2d_t at(float t) { return getPoint(t); }
+    int getSpans() { return (int) spans.size(); }
+    const std::vector<point2d_t>& getSamples() { tessellate(); return samples; }
+
+    void drag(int point, float x, float y) {
+        selected = point;
+        modifySelectedControlPoint((int) x, (int) y);
+    }
+
+    /* how many spans the next update evaluates */
+    int getDirty() {
+        int n = 0;
+        for(size_t j = 0; j < dirty.size(); j++) n += dirty[j];
+        return n;
+    }
+
+    void update(bool all) {
+        if(all) dirty.assign(dirty.size(), 1);
+        tessellate();
+    }
+};
+
+/* with as many points as the degree + 1 and clamped knots a spline is that Bezier curve */
+static float checkBezier() {
+	BenchBezier bezier;
+	BenchSpline spline;
+	srand(options.seed);
+	for(int i = 0; i <= BSC_DEGREE; i++) {
+		const float x = 640.0f * rand() / RAND_MAX;
+		const float y = 480.0f * rand() / RAND_MAX;
+		bezier.add(x, y);
+		spline.add(x, y);
+	}
+
+	float error = 0.0f;
+	const std::vector<point2d_t>& samples = spline.getSamples();
+	for(size_t i = 0; i < samples.size(); i++) {
+		const point2d_t b = bezier.at((1.0f * i) / (samples.size() - 1));
+		error = fmaxf(error, hypotf(samples[i].x - b.x, samples[i].y - b.y));
+	}
+	return error;
+}
+
+/* a circle of radius 200 as nine weighted points on a quadratic with doubled interior knots */
+static float checkCircle() {
+	static const float corners[9][2] = {
+		{ 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }, { 1, 0 }
+	};
+	static const float knots[12] = { 0, 0, 0, 0.25f, 0.25f, 0.5f, 0.5f, 0.75f, 0.75f, 1, 1, 1 };
+
+	BenchSpline spline;
+	spline.setDegree(2);
+	for(int i = 0; i < 9; i++) {
+		spline.add(320 + 200 * corners[i][0], 240 + 200 * corners[i][1], i % 2 ? M_SQRT1_2 : 1.0f);
+	}
+	if(!spline.setKnots(knots, 12)) return INFINITY;
+
+	float error = 0.0f;
+	const std::vector<point2d_t>& samples = spline.getSamples();
+	for(size_t i = 0; i < samples.size(); i++) {
+		error = fmaxf(error, fabsf(hypotf(samples[i].x - 320, samples[i].y - 240) - 200));
+	}
+	return error;
+}
+
+int main(int argc, char** argv) {
+	parseArgs(argc, argv);
+
+	const float bezierError = checkBezier();
+	const float circleError = checkCircle();
+
+	BenchSpline local, full;
+	srand(options.seed);
+	for(int i = 0; i < options.count; i++) {
+		const float x = 640.0f * rand() / RAND_MAX;
+		const float y = 480.0f * rand() / RAND_MAX;
+		local.add(x, y);
+		full.add(x, y);
+	}
+
+	double start = now();
+	local.update(false);
+	const double first = now() - start;
+	full.update(false);
+
+	double localTime = 0.0, fullTime = 0.0;
+	long spans = 0;
+	for(int d = 0; d < options.drags; d++) {
+		const int point = rand() % options.count;
+		const float x = 640.0f * rand() / RAND_MAX;
+		const float y = 480.0f * rand() / RAND_MAX;
+		local.drag(point, x, y);
+		full.drag(point, x, y);
+		spans += local.getDirty();
+
+		start = now();
+		local.update(false);
+		localTime += now() - start;
+
+		start = now();
+		full.update(true);
+		fullTime += now() - start;
+	}
+
+	const bool same = memcmp(&local.getSamples()[0], &full.getSamples()[0],
+		local.getSamples().size() * sizeof(point2d_t)) == 0;
+	const bool right = bezierError < SPLINE_MAX_ERROR && circleError < SPLINE_MAX_ERROR && same;
+
+	printf("{\n");
+	printf("  \"bezier_max_error\": %g,\n", bezierError);
+	printf("  \"circle_max_error\": %g,\n", circleError);
+	printf("  \"points\": %d,\n", options.count);
+	printf("  \"spans\": %d,\n", local.getSpans());
+	printf("  \"first_tessellation_us\": %.2f,\n", first * 1e6);
+	printf("  \"spans_per_drag\": %.2f,\n", (double) spans / options.drags);
+	printf("  \"local_drag_us\": %.2f,\n", localTime / options.drags * 1e6);
+	printf("  \"full_drag_us\": %.2f,\n", fullTime / options.drags * 1e6);
+	printf("  \"same_samples\": %s\n", same ? "true" : "false");
+	printf("}\n");
+
+	return right ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+#ifndef BSPLINECURVE_H_
+#define BSPLINECURVE_H_
+
+#include <vector>
+
+#include "BezierCurve.h"
+#include "ControlNet.h"
+
+/* degree a new spline has */
+#define BSC_DEGREE 3
+
+/* highest degree supported */
+#define BSC_MAX_DEGREE 7
+
+/* line segments every span of the curve is drawn with */
+#define BSC_SPAN_SEGMENTS 16
+
+/*
+ * A 2D NURBS curve: piecewise polynomials of a chosen degree joined at a clamped knot vector,
+ * with a weight per control point.  Each point only moves the degree + 1 spans its basis
+ * function is nonzero over, so samples are kept per span and moving a point re-evaluates just
+ * those.  The basis functions at every sample are kept too, leaving O(degree) work a sample.
+ *
+ * Knots are uniform unless setKnots gives others; adding a point or changing the degree goes
+ * back to uniform ones.
+ */
+class BSplineCurve {
+public:
+    BSplineCurve();
+    ~BSplineCurve();
+
+    void addControlPoint(int x, int y);
+    void selectControlPoint(int x, int y);
+    void modifySelectedControlPoint(int x, int y);
+    void setTangentU(float u) { tangentU = u; }
+
+    void setDegree(int degree);
+    void setSelectedWeight(float weight);
+
+    /*
+     * count + degree + 1 nondecreasing knots, the first degree + 1 and the last degree + 1
+     * equal so the curve starts and ends at its end points
+     *
+     * @return false, keeping the knots there were, if these do not fit
+     */
+    bool setKnots(const float* knots, int count);
+
+    void draw();
+
+protected:
+    void appendPoint(float x, float y, float weight = 1.0f);
+    int getDegree() const;
+
+    void updateKnots();
+    void basisFuns(int span, float u, int degree, float* N) const;
+    int findSpan(float u) const;
+    point2d_t getPoint(float t);
+    point2d_t getTangent();
+    void markSpans(int point);
+    void tessellateSpan(int j);
+    void tessellate();
+
+    int selected;
+    float tangentU;
+    int degree;
+
+    ControlNet net;
+    std::vector<float> W;
+
+    /* knots, and whether setKnots chose them */
+    std::vector<float> knots;
+    bool customKnots;
+    bool knotsChanged;
+
+    /* the knot index every span with nonzero length starts at */
+    std::vector<int> spans;
+
+    /* for every sample of every span, the degree + 1 basis functions that are nonzero there */
+    std::vector<float> basis;
+
+    /* BSC_SPAN_SEGMENTS + 1 samples a span, neighbours sharing their ends, and which spans moved */
+    std::vector<point2d_t> samples;
+    std::vector<char> dirty;
+};
+
+#endif /*BSPLINECURVE_H_*/
@@ -0,0 +1,46 @@
+#ifndef BASISTABLE_H_
+#define BASISTABLE_H_
+
+#include <vector>
+
+/* most points the Bernstein weights are built by the O(n^2) recurrence for, where it is cheaper */
+#define BT_RECURRENCE_MAX_PTS 16
+
+/* weights below this fraction of the largest at a u are left out as 0 */
+#define BT_EPSILON 1e-10
+
+/*
+ * Bernstein weights for count control points at segments + 1 evenly spaced parameters, one
+ * row per sample: row i holds the weights at u = i / segments that are not negligible, for a
+ * run of points starting at first.  Building it costs what evaluating every sample did, after
+ * that a sample is a dot product of a row with those points.
+ */
+class BasisTable {
+public:
+    BasisTable();
+
+    /* make the table hold count points and segments, rebuilt only if either changed */
+    void prepare(int count, int segments);
+
+    /* the weights of row i, for points first .. first + width - 1 */
+    const float* getRow(int i, int* first, int* width) const;
+
+    /*
+     * The Bernstein weights of count points at u into B[first] .. B[last - 1], all others being
+     * negligible.  Up to BT_RECURRENCE_MAX_PTS points that is every weight, by the recurrence;
+     * past that the largest weight comes from lgamma in double and the rest from the ratio of
+     * neighbours, walking out until they drop below BT_EPSILON of it, so nothing underflows
+     * and a sample costs O(sqrt(n)) however high the degree.
+     */
+    static void evaluate(int count, float u, float* B, int* first, int* last);
+
+protected:
+    void build();
+
+    int count, segments;
+    std::vector<float> weights;
+    std::vector<int> firsts, offsets;
+    std::vector<float> scratch;
+};
+
+#endif /*BASISTABLE_H_*/
@@ -1,16 +1,41 @@
 #ifndef BEZIERCURVE_H_
 #define BEZIERCURVE_H_
 
-/* max # of points supported */
-#define BC_MAX_PTS 100
+#include <vector>
 
-/* total # of line segments for the curve */
-#define BC_MAX_SEGMENTS 50
+#include "BasisTable.h"
+#include "ControlNet.h"
+
+/* default distance in pixels the drawn line segments may stray from the curve */
+#define BC_TOLERANCE 0.5f
+
+/* most line segments the uniform evaluators split the curve into */
+#define BC_MAX_SEGMENTS 1024
+
+/* deepest the subdividing evaluator halves the curve */
+#define BC_MAX_DEPTH 16
+
+/* highest degree forward differencing stays accurate at; above it the basis table is used */
+#define BC_FORWARD_MAX_DEGREE 6
+
+/* highest degree subdividing is quick enough for at O(n^2) a split; above it the table is used */
+#define BC_SUBDIVIDE_MAX_DEGREE 255
+
+/* drags the cached samples follow by deltas before they are evaluated afresh, bounding drift */
+#define BC_MAX_DELTAS 256
 
 typedef struct {
 	float x, y;
 } point2d_t;
 
+/* ways of turning the curve into line segments */
+enum {
+	BC_BERNSTEIN,	/* every sample through allBernstein, O(n^2) each */
+	BC_TABLE,		/* uniform samples from the basis table, O(n) each */
+	BC_FORWARD,		/* uniform samples by forward differencing, O(n) each after setup */
+	BC_SUBDIVIDE	/* adaptive de Casteljau halving until the pieces are flat */
+};
+
 class BezierCurve {
 public:
     BezierCurve();
@@ -20,22 +45,54 @@ public:
     void selectControlPoint(int x, int y);
     void modifySelectedControlPoint(int x, int y);
     void setTangentU(float u) { tangentU = u; }
+    void setEvaluator(int evaluator) { this->evaluator = evaluator; cached = false; }
+    void setTolerance(float tolerance) { this->tolerance = tolerance; cached = false; }
 
     void draw();
 
 protected:
 
+    void appendPoint(float x, float y);
     void allBernstein(float u, int countOffset = 0);
     point2d_t getPoint(float u);
+    point2d_t getPoint(const float* weights, int first, int width);
     point2d_t getTangent();
 
-    int count;
+    /* fill samples and params with the curve as line segments, the way evaluator says */
+    void tessellate();
+    void refresh();
+    void addDelta(int point, float dx, float dy);
+    int getSegments();
+    void forwardDifference(int segments);
+    void subdivide(const point2d_t* P, float u0, float u1, int depth);
+    bool isFlat(const point2d_t* P);
+
     int selected;
     float tangentU;
+    int evaluator;
+    float tolerance;
+
+    ControlNet net;
+
+    /* allBernstein's weights, of which only B[first] .. B[last - 1] matter */
+    std::vector<float> B;
+    int first, last;
+
+    /* weights for every uniform sample, kept until count or the segments change */
+    BasisTable basis;
+
+    /* the last tessellation: points on the curve and the u each lies at */
+    std::vector<point2d_t> samples;
+    std::vector<float> params;
+
+    /* whether samples still match the points, came from the table and how many deltas ago */
+    bool cached;
+    bool fromTable;
+    int cachedSegments;
+    int deltas;
 
-    float X[BC_MAX_PTS];
-    float Y[BC_MAX_PTS];
-    float B[BC_MAX_PTS];
+    /* halves of the control polygon for every level subdivide recurses to */
+    std::vector<point2d_t> work;
 };
 
 #endif /*BEZIERCURVE_H_*/
@@ -1,9 +1,9 @@
 #ifndef BEZIERSURFACE_H_
 #define BEZIERSURFACE_H_
 
-/* max # of points supported */
-#define BS_MAX_PTS_X 10
-#define BS_MAX_PTS_Y 10
+#include <vector>
+
+#include "ControlNet.h"
 
 /* total # of line segments for the curve */
 #define BS_MAX_SEGMENTS 50
@@ -15,6 +15,7 @@ typedef struct {
 class BezierSurface {
 public:
     BezierSurface();
+    BezierSurface(int countHoriz, int countVert);
     ~BezierSurface();
 
     void draw();
@@ -24,14 +25,20 @@ protected:
     void allBernsteinU(float u, int countOffset = 0);
     void allBernsteinV(float v, int countOffset = 0);
     point3d_t getPoint(float u, float v);
+    void tessellate();
 
     int countHoriz, countVert;
 
-    float X[BS_MAX_PTS_X][BS_MAX_PTS_Y];
-    float Y[BS_MAX_PTS_X][BS_MAX_PTS_Y];
-    float Z[BS_MAX_PTS_X][BS_MAX_PTS_Y];
-    float Bn[BS_MAX_PTS_X];
-    float Bm[BS_MAX_PTS_Y];
+    /* countHoriz rows of countVert points, row i at i * countVert */
+    ControlNet net;
+
+    /* weights along each direction, of which only [first, last) matter */
+    std::vector<float> Bn, Bm;
+    int nFirst, nLast, mFirst, mLast;
+
+    /* the surface at every grid point, and the grid points every quad strip takes */
+    std::vector<point3d_t> grid;
+    std::vector<unsigned int> strips;
 };
 
 #endif /*BEZIERSURFACE_H_*/
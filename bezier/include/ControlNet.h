@@ -0,0 +1,42 @@
+#ifndef CONTROLNET_H_
+#define CONTROLNET_H_
+
+/* bytes every coordinate array is aligned to, one cache line */
+#define CN_ALIGNMENT 64
+
+/* points a net makes room for the first time it grows */
+#define CN_INITIAL_CAPACITY 16
+
+/*
+ * Control points stored as separate x, y and z arrays, each cache line aligned, so the sums
+ * over the points read straight through memory.  Room doubles whenever it runs out, so adding
+ * a point is amortized O(1) however many there are.  A surface keeps its rows one after another.
+ */
+class ControlNet {
+public:
+    ControlNet();
+    ~ControlNet();
+
+    void append(float x, float y, float z = 0.0f);
+    void clear() { count = 0; }
+
+    int getCount() const { return count; }
+    float* getX() { return x; }
+    float* getY() { return y; }
+    float* getZ() { return z; }
+    const float* getX() const { return x; }
+    const float* getY() const { return y; }
+    const float* getZ() const { return z; }
+
+protected:
+    void grow(int capacity);
+
+    int count, capacity;
+    float *x, *y, *z;
+
+private:
+    ControlNet(const ControlNet&);
+    ControlNet& operator=(const ControlNet&);
+};
+
+#endif /*CONTROLNET_H_*/
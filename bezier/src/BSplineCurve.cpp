@@ -0,0 +1,330 @@
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include <GL/glut.h>
+
+#include "BSplineCurve.h"
+
+BSplineCurve::BSplineCurve() {
+    selected = -1;
+    tangentU = -1;
+    degree = BSC_DEGREE;
+    customKnots = false;
+    knotsChanged = true;
+}
+
+BSplineCurve::~BSplineCurve() {
+}
+
+void BSplineCurve::addControlPoint(int x, int y) {
+    appendPoint((float) x, (float) y);
+}
+
+void BSplineCurve::appendPoint(float x, float y, float weight) {
+    net.append(x, y);
+    W.push_back(weight);
+    customKnots = false;
+    knotsChanged = true;
+}
+
+void BSplineCurve::setDegree(int degree) {
+    if(degree < 1 || degree > BSC_MAX_DEGREE || degree == this->degree) return;
+    this->degree = degree;
+    customKnots = false;
+    knotsChanged = true;
+}
+
+/* the degree the curve has with the points there are, no more than one less than their count */
+int BSplineCurve::getDegree() const {
+    return std::min(degree, net.getCount() - 1);
+}
+
+bool BSplineCurve::setKnots(const float* knots, int count) {
+    const int n = net.getCount();
+    const int p = getDegree();
+    if(p < 1 || count != n + p + 1 || !(knots[p] < knots[n])) return false;
+    for(int i = 1; i < count; i++) {
+        if(knots[i] < knots[i - 1]) return false;
+    }
+    for(int i = 1; i <= p; i++) {
+        if(knots[i] != knots[0] || knots[count - 1 - i] != knots[count - 1]) return false;
+    }
+
+    this->knots.assign(knots, knots + count);
+    customKnots = true;
+    knotsChanged = true;
+    return true;
+}
+
+void BSplineCurve::draw() {
+    const int count = net.getCount();
+    const float* X = net.getX();
+    const float* Y = net.getY();
+
+    // Draw control points
+    glColor3f(1.0f, 0.0f, 0.0f);
+    glPointSize(10);
+    glBegin(GL_POINTS);
+    for(int i = 0; i < count; i++) {
+        glVertex2f(X[i], Y[i]);
+    }
+    glEnd();
+
+    // Draw lines between control points
+    glColor3f(0.0f, 0.0f, 1.0f);
+    glLineWidth(1);
+    glBegin(GL_LINE_STRIP);
+    for(int i = 0; i < count; i++) {
+        glVertex2f(X[i], Y[i]);
+    }
+    glEnd();
+
+    if(count < 3) return;
+
+    // Draw curve
+    glLineWidth(2);
+    glColor3f(1.0f, 1.0f, 0.0f);
+
+    tessellate();
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(point2d_t), &samples[0]);
+    glDrawArrays(GL_LINE_STRIP, 0, samples.size());
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+	// Draw tangent and normal lines
+	if(tangentU >= 0) {
+		point2d_t pt = getPoint(tangentU);
+		point2d_t tan = getTangent();
+
+		// tangent, point + vector
+		glColor3f(0.0f, 1.0f, 0.0f);
+		glBegin(GL_LINE_STRIP);
+			glVertex2f(pt.x, pt.y);
+			glVertex2f(pt.x + tan.x, pt.y + tan.y);
+		glEnd();
+
+		// normal -> point + perp vector
+		glColor3f(0.0f, 0.0f, 1.0f);
+		glBegin(GL_LINE_STRIP);
+			glVertex2f(pt.x, pt.y);
+			glVertex2f(pt.x - tan.y, pt.y + tan.x);
+		glEnd();
+	}
+}
+
+void BSplineCurve::selectControlPoint(int x, int y) {
+    const int count = net.getCount();
+    const float* X = net.getX();
+    const float* Y = net.getY();
+
+    selected = -1;
+    for(int i = 0; i < count; i++) {
+        int deltaX = x - X[i];
+        int deltaY = y - Y[i];
+        if (deltaX < 0) deltaX = -deltaX;
+        if (deltaY < 0) deltaY = -deltaY;
+
+        // Selection with a reasonable range
+        if (deltaX < 8 && deltaY < 8) {
+            selected = i;
+            break;
+        }
+    }
+}
+
+void BSplineCurve::modifySelectedControlPoint(int x, int y) {
+    if (selected != -1) {
+        net.getX()[selected] = x;
+        net.getY()[selected] = y;
+        markSpans(selected);
+    }
+}
+
+void BSplineCurve::setSelectedWeight(float weight) {
+    if (selected != -1 && weight > 0.0f) {
+        W[selected] = weight;
+        markSpans(selected);
+    }
+}
+
+/*
+ * Clamped uniform knots unless setKnots gave some, the spans between them, and the basis
+ * functions at every sample of those spans.  Every span has to be evaluated again after.
+ */
+void BSplineCurve::updateKnots() {
+    const int count = net.getCount();
+    const int p = getDegree();
+    knotsChanged = false;
+
+    spans.clear();
+    if(p < 1) {
+        samples.clear();
+        dirty.clear();
+        return;
+    }
+
+    if(!customKnots) {
+        knots.resize(count + p + 1);
+        for(int i = 0; i <= p; i++) {
+            knots[i] = 0.0f;
+            knots[count + i] = 1.0f;
+        }
+        for(int i = p + 1; i < count; i++) {
+            knots[i] = (1.0f * (i - p)) / (count - p);
+        }
+    }
+
+    for(int k = p; k < count; k++) {
+        if(knots[k] < knots[k + 1]) spans.push_back(k);
+    }
+
+    const int rows = BSC_SPAN_SEGMENTS + 1;
+    basis.resize(spans.size() * rows * (p + 1));
+    for(size_t j = 0; j < spans.size(); j++) {
+        const int k = spans[j];
+        for(int s = 0; s < rows; s++) {
+            const float u = knots[k] + (knots[k + 1] - knots[k]) * s / BSC_SPAN_SEGMENTS;
+            basisFuns(k, u, p, &basis[(j * rows + s) * (p + 1)]);
+        }
+    }
+
+    samples.resize(spans.size() * BSC_SPAN_SEGMENTS + 1);
+    dirty.assign(spans.size(), 1);
+}
+
+/*
+ * The degree + 1 basis functions of the given degree that are nonzero over the span starting
+ * at knot span, at u, into N: N[0] belongs to point span - degree.  Cox-de Boor, as in
+ * Piegl & Tiller's "The NURBS Book", A2.2.
+ */
+void BSplineCurve::basisFuns(int span, float u, int degree, float* N) const {
+    float left[BSC_MAX_DEGREE + 1], right[BSC_MAX_DEGREE + 1];
+    N[0] = 1.0f;
+    for(int j = 1; j <= degree; j++) {
+        left[j] = u - knots[span + 1 - j];
+        right[j] = knots[span + j] - u;
+        float saved = 0.0f;
+        for(int r = 0; r < j; r++) {
+            const float temp = N[r] / (right[r + 1] + left[j - r]);
+            N[r] = saved + right[r + 1] * temp;
+            saved = left[j - r] * temp;
+        }
+        N[j] = saved;
+    }
+}
+
+/* the span u lies in, the last one for the very end */
+int BSplineCurve::findSpan(float u) const {
+    const int count = net.getCount();
+    const int p = getDegree();
+    if(u >= knots[count]) return spans.back();
+    if(u <= knots[p]) return spans.front();
+    return std::upper_bound(knots.begin() + p, knots.begin() + count + 1, u) - knots.begin() - 1;
+}
+
+/* Compute point on the curve, t running from 0 to 1 over it */
+point2d_t BSplineCurve::getPoint(float t) {
+    const int count = net.getCount();
+    const int p = getDegree();
+    const float u = knots[p] + t * (knots[count] - knots[p]);
+    const int span = findSpan(u);
+
+    float N[BSC_MAX_DEGREE + 1];
+    basisFuns(span, u, p, N);
+
+    float wx = 0.0f, wy = 0.0f, w = 0.0f;
+    for(int r = 0; r <= p; r++) {
+        const int i = span - p + r;
+        const float b = N[r] * W[i];
+        wx += b * net.getX()[i];
+        wy += b * net.getY()[i];
+        w += b;
+    }
+    point2d_t c = { wx / w, wy / w };
+    return c;
+}
+
+/*
+ * The derivative at tangentU, divided by the degree as BezierCurve's is.  The weighted points
+ * and the weights are differentiated as B-splines of one degree less, and the quotient rule
+ * gives the curve's.
+ */
+point2d_t BSplineCurve::getTangent() {
+	const int count = net.getCount();
+	const int p = getDegree();
+	const float* X = net.getX();
+	const float* Y = net.getY();
+	const float length = knots[count] - knots[p];
+	const float u = knots[p] + tangentU * length;
+	const int span = findSpan(u);
+
+	float N[BSC_MAX_DEGREE + 1], D[BSC_MAX_DEGREE + 1];
+	basisFuns(span, u, p, N);
+	basisFuns(span, u, p - 1, D);
+
+	float wx = 0.0f, wy = 0.0f, w = 0.0f;
+	for(int r = 0; r <= p; r++) {
+		const int i = span - p + r;
+		wx += N[r] * W[i] * X[i];
+		wy += N[r] * W[i] * Y[i];
+		w += N[r] * W[i];
+	}
+
+	float dx = 0.0f, dy = 0.0f, dw = 0.0f;
+	for(int r = 0; r < p; r++) {
+		const int i = span - p + 1 + r;
+		const float scale = D[r] * p / (knots[i + p] - knots[i]);
+		dx += scale * (W[i] * X[i] - W[i - 1] * X[i - 1]);
+		dy += scale * (W[i] * Y[i] - W[i - 1] * Y[i - 1]);
+		dw += scale * (W[i] - W[i - 1]);
+	}
+
+	point2d_t t = {
+		(dx - dw * wx / w) / w * length / p,
+		(dy - dw * wy / w) / w * length / p
+	};
+	return t;
+}
+
+/* point moves the spans its basis function is nonzero over, from knot point to point + degree + 1 */
+void BSplineCurve::markSpans(int point) {
+	if(knotsChanged) return;
+	const int p = getDegree();
+	std::vector<int>::iterator it = std::lower_bound(spans.begin(), spans.end(), point);
+	for(; it != spans.end() && *it <= point + p; ++it) {
+		dirty[it - spans.begin()] = 1;
+	}
+}
+
+void BSplineCurve::tessellateSpan(int j) {
+	const int p = getDegree();
+	const int k = spans[j];
+	const float* X = net.getX() + k - p;
+	const float* Y = net.getY() + k - p;
+	const float* weights = &W[k - p];
+
+	// a span's end is the next one's start, and that one evaluates it
+	const int last = j + 1 == (int) spans.size() ? BSC_SPAN_SEGMENTS : BSC_SPAN_SEGMENTS - 1;
+	for(int s = 0; s <= last; s++) {
+		const float* N = &basis[(j * (BSC_SPAN_SEGMENTS + 1) + s) * (p + 1)];
+		float wx = 0.0f, wy = 0.0f, w = 0.0f;
+		for(int r = 0; r <= p; r++) {
+			const float b = N[r] * weights[r];
+			wx += b * X[r];
+			wy += b * Y[r];
+			w += b;
+		}
+		point2d_t pt = { wx / w, wy / w };
+		samples[j * BSC_SPAN_SEGMENTS + s] = pt;
+	}
+	dirty[j] = 0;
+}
+
+/* bring the samples up to date, evaluating only the spans that moved */
+void BSplineCurve::tessellate() {
+	if(knotsChanged) updateKnots();
+	for(size_t j = 0; j < spans.size(); j++) {
+		if(dirty[j]) tessellateSpan(j);
+	}
+}
@@ -0,0 +1,98 @@
+#include <math.h>
+
+#include <algorithm>
+
+#include "BasisTable.h"
+
+BasisTable::BasisTable() {
+	count = segments = 0;
+}
+
+void BasisTable::prepare(int count, int segments) {
+	if(offsets.empty() || count != this->count || segments != this->segments) {
+		this->count = count;
+		this->segments = segments;
+		build();
+	}
+}
+
+const float* BasisTable::getRow(int i, int* first, int* width) const {
+	*first = firsts[i];
+	*width = offsets[i + 1] - offsets[i];
+	return &weights[offsets[i]];
+}
+
+void BasisTable::build() {
+	weights.clear();
+	firsts.resize(segments + 1);
+	offsets.resize(segments + 2);
+	scratch.resize(count);
+
+	offsets[0] = 0;
+	for(int i = 0; i <= segments; i++) {
+		int first, last;
+		evaluate(count, (1.0f * i) / segments, &scratch[0], &first, &last);
+		weights.insert(weights.end(), scratch.begin() + first, scratch.begin() + last);
+		firsts[i] = first;
+		offsets[i + 1] = weights.size();
+	}
+}
+
+void BasisTable::evaluate(int count, float u, float* B, int* first, int* last) {
+	if(count <= 0) {
+		*first = *last = 0;
+		return;
+	}
+	if(count <= BT_RECURRENCE_MAX_PTS) {
+		float u1 = 1.0 - u;
+		B[0] = 1.0;
+
+		for(int j = 1; j < count; j++) {
+			float saved = 0.0;
+			for(int k = 0; k < j; k++) {
+				float temp = B[k];
+				B[k] = saved + u1 * temp;
+				saved = u * temp;
+			}
+			B[j] = saved;
+		}
+		*first = 0;
+		*last = count;
+		return;
+	}
+
+	const int n = count - 1;
+	if(u <= 0.0f || u >= 1.0f) {
+		const int k = u <= 0.0f ? 0 : n;
+		B[k] = 1.0f;
+		*first = k;
+		*last = k + 1;
+		return;
+	}
+
+	// the mode of the binomial distribution is the largest weight
+	const int peak = std::min(n, (int) floor((n + 1) * (double) u));
+	const double largest = exp(lgamma(n + 1.0) - lgamma(peak + 1.0) - lgamma(n - peak + 1.0) +
+		peak * log((double) u) + (n - peak) * log(1.0 - u));
+	const double ratio = u / (1.0 - u);
+	B[peak] = (float) largest;
+
+	// B[k + 1] = B[k] * (n - k) / (k + 1) * u / (1 - u)
+	double b = largest;
+	int k = peak;
+	while(k < n) {
+		b *= ratio * (n - k) / (k + 1);
+		if(b < largest * BT_EPSILON) break;
+		B[++k] = (float) b;
+	}
+	*last = k + 1;
+
+	b = largest;
+	k = peak;
+	while(k > 0) {
+		b *= k / (ratio * (n - k + 1));
+		if(b < largest * BT_EPSILON) break;
+		B[--k] = (float) b;
+	}
+	*first = k;
+}
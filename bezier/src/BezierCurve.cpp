@@ -1,3 +1,4 @@
+#include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -6,9 +7,13 @@
 #include "BezierCurve.h"
 
 BezierCurve::BezierCurve() {
-    count = 0;
     selected = -1;
     tangentU = -1;
+    evaluator = BC_TABLE;
+    tolerance = BC_TOLERANCE;
+    first = last = 0;
+    cached = fromTable = false;
+    cachedSegments = deltas = 0;
 }
 
 BezierCurve::~BezierCurve() {
@@ -16,16 +21,20 @@ BezierCurve::~BezierCurve() {
 
 void BezierCurve::addControlPoint(int x, int y) {
 	printf("%d,%d\n",x,y);
-    if (count < BC_MAX_PTS) {
-        X[count] = (float) x;
-        Y[count] = (float) y;
-        count++;
-    } else {
-    	// WARN("Max points reached.");
-    }
+    appendPoint((float) x, (float) y);
+}
+
+void BezierCurve::appendPoint(float x, float y) {
+    net.append(x, y);
+    B.resize(net.getCount());
+    cached = false;
 }
 
 void BezierCurve::draw() {
+    const int count = net.getCount();
+    const float* X = net.getX();
+    const float* Y = net.getY();
+
     // Draw control points
     glColor3f(1.0f, 0.0f, 0.0f);
     glPointSize( 10 );
@@ -48,14 +57,12 @@ void BezierCurve::draw() {
     if (count > 2) {
         glLineWidth(2);
         glColor3f(1.0f, 1.0f, 0.0f);
-        glBegin(GL_LINE_STRIP);
 
-        for(int i = 0; i <= BC_MAX_SEGMENTS; i++) {
-            point2d_t pt = getPoint((1.0f * i) / BC_MAX_SEGMENTS);
-            glVertex2f(pt.x, pt.y);
-        }
-
-        glEnd();
+        refresh();
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glVertexPointer(2, GL_FLOAT, sizeof(point2d_t), &samples[0]);
+        glDrawArrays(GL_LINE_STRIP, 0, samples.size());
+        glDisableClientState(GL_VERTEX_ARRAY);
     }
 
 	// Draw tangent and normal lines
@@ -80,6 +87,10 @@ void BezierCurve::draw() {
 }
 
 void BezierCurve::selectControlPoint(int x, int y) {
+    const int count = net.getCount();
+    const float* X = net.getX();
+    const float* Y = net.getY();
+
     selected = -1;
     for(int i = 0; i < count; i++) {
         int deltaX = x - X[i];
@@ -97,51 +108,255 @@ void BezierCurve::selectControlPoint(int x, int y) {
 
 void BezierCurve::modifySelectedControlPoint(int x, int y) {
     if (selected != -1) {
-        X[selected] = x;
-        Y[selected] = y;
+        const float dx = x - net.getX()[selected];
+        const float dy = y - net.getY()[selected];
+        net.getX()[selected] = x;
+        net.getY()[selected] = y;
+
+        // the table's samples move by the point's weight at each, if the segments stay the same
+        if(cached && fromTable && deltas < BC_MAX_DELTAS && getSegments() == cachedSegments) {
+            addDelta(selected, dx, dy);
+        } else {
+            cached = false;
+        }
     }
 }
 
 void BezierCurve::allBernstein(float u, int countOffset) {
-    /* Compute all n-th degree Bernstein Polynomials */
-    /* Input: n, u */
-    /* Output: B (an array, B[0], �K, B[n]) */
-    int k = 0;
-    float u1 = 1.0 - u;
-    float saved = 0.0f;
-    float temp = 0.0f;
-    B[0] = 1.0;
-
-    for(int j = 1; j < count + countOffset; j++) {
-        saved = 0.0;
-        for(k = 0; k < j; k++) {
-            temp = B[k];
-            B[k] = saved + u1 * temp;
-            saved = u * temp;
-        }
-
-        B[j] = saved;
-    }
+    /* Compute all n-th degree Bernstein Polynomials that matter */
+    float* weights = B.empty() ? NULL : &B[0];
+    BasisTable::evaluate(net.getCount() + countOffset, u, weights, &first, &last);
 }
 
 /* Compute point on Bezier curve */
 point2d_t BezierCurve::getPoint(float u) {
-    allBernstein(u); /* B is a local array */
+    allBernstein(u); /* B is a member array */
+    const float* X = net.getX();
+    const float* Y = net.getY();
     point2d_t c = { 0.0f, 0.0f };
-    for(int k = 0; k < count; k++) {
+    for(int k = first; k < last; k++) {
     	c.x += B[k] * X[k];
     	c.y += B[k] * Y[k];
     }
     return c;
 }
 
+/* Compute point on Bezier curve from a row of the basis table */
+point2d_t BezierCurve::getPoint(const float* weights, int first, int width) {
+    const float* X = net.getX() + first;
+    const float* Y = net.getY() + first;
+    point2d_t c = { 0.0f, 0.0f };
+    for(int k = 0; k < width; k++) {
+    	c.x += weights[k] * X[k];
+    	c.y += weights[k] * Y[k];
+    }
+    return c;
+}
+
 point2d_t BezierCurve::getTangent() {
 	allBernstein(tangentU, -1);
+	const float* X = net.getX();
+	const float* Y = net.getY();
 	point2d_t t = { 0.0f, 0.0f };
-	int n = count - 1;
-	for(int k = 0; k < n; k++) {
+	for(int k = first; k < last; k++) {
 		t.x += B[k] * (X[k + 1] - X[k]);
 		t.y += B[k] * (Y[k + 1] - Y[k]);
 	}
 	return t;
 }
+
+void BezierCurve::tessellate() {
+	const int count = net.getCount();
+	const float* X = net.getX();
+	const float* Y = net.getY();
+
+	samples.clear();
+	params.clear();
+	cached = true;
+	fromTable = false;
+	deltas = 0;
+	if(count < 2) return;
+
+	if(evaluator == BC_SUBDIVIDE && count - 1 <= BC_SUBDIVIDE_MAX_DEGREE) {
+		// the control polygon first, then two halves of it for every level
+		work.resize(count * (1 + 2 * BC_MAX_DEPTH));
+		for(int i = 0; i < count; i++) {
+			work[i].x = X[i];
+			work[i].y = Y[i];
+		}
+		samples.push_back(work[0]);
+		params.push_back(0.0f);
+		subdivide(&work[0], 0.0f, 1.0f, 0);
+		return;
+	}
+
+	const int segments = getSegments();
+	cachedSegments = segments;
+	if(evaluator == BC_FORWARD && count - 1 <= BC_FORWARD_MAX_DEGREE) {
+		forwardDifference(segments);
+		return;
+	}
+
+	fromTable = evaluator != BC_BERNSTEIN;
+	if(fromTable) basis.prepare(count, segments);
+	for(int i = 0; i <= segments; i++) {
+		const float u = (1.0f * i) / segments;
+		if(evaluator == BC_BERNSTEIN) {
+			samples.push_back(getPoint(u));
+		} else {
+			int first, width;
+			const float* weights = basis.getRow(i, &first, &width);
+			samples.push_back(getPoint(weights, first, width));
+		}
+		params.push_back(u);
+	}
+}
+
+/* tessellate again only if the points moved in a way deltas did not follow */
+void BezierCurve::refresh() {
+	if(!cached) tessellate();
+}
+
+/*
+ * A point moving by dx, dy moves every sample by its weight there times that, so following a
+ * drag takes one column of the basis table instead of a tessellation.
+ */
+void BezierCurve::addDelta(int point, float dx, float dy) {
+	for(int i = 0; i <= cachedSegments; i++) {
+		int first, width;
+		const float* weights = basis.getRow(i, &first, &width);
+		if(point < first || point >= first + width) continue;
+		samples[i].x += weights[point - first] * dx;
+		samples[i].y += weights[point - first] * dy;
+	}
+	deltas++;
+}
+
+/*
+ * Segments a uniform tessellation needs to stay within tolerance of the curve: a chord strays
+ * at most max|C''| / 8 per squared segment count, and |C''| is bounded by n(n - 1) times the
+ * largest second difference of the control points.  Rounded up to a power of two so the basis
+ * table is not rebuilt for every small change while dragging.
+ */
+int BezierCurve::getSegments() {
+	const int count = net.getCount();
+	const float* X = net.getX();
+	const float* Y = net.getY();
+	const int n = count - 1;
+	float largest = 0.0f;
+	for(int i = 0; i + 2 < count; i++) {
+		const float dx = X[i + 2] - 2.0f * X[i + 1] + X[i];
+		const float dy = Y[i + 2] - 2.0f * Y[i + 1] + Y[i];
+		largest = fmaxf(largest, sqrtf(dx * dx + dy * dy));
+	}
+
+	const float needed = sqrtf(n * (n - 1) * largest / (8.0f * tolerance));
+	int segments = 1;
+	while(segments < needed && segments < BC_MAX_SEGMENTS) {
+		segments *= 2;
+	}
+	return segments;
+}
+
+/* de Casteljau in double, for the starting values forward differencing builds on */
+static void evaluate(const float* X, const float* Y, int count, double u, double* x, double* y) {
+	double px[BC_FORWARD_MAX_DEGREE + 1], py[BC_FORWARD_MAX_DEGREE + 1];
+	for(int i = 0; i < count; i++) {
+		px[i] = X[i];
+		py[i] = Y[i];
+	}
+	for(int j = 1; j < count; j++) {
+		for(int i = 0; i < count - j; i++) {
+			px[i] = (1.0 - u) * px[i] + u * px[i + 1];
+			py[i] = (1.0 - u) * py[i] + u * py[i + 1];
+		}
+	}
+	*x = px[0];
+	*y = py[0];
+}
+
+/*
+ * Uniform samples by forward differencing: the n-th differences of a degree n polynomial are
+ * constant, so after n + 1 exact points every further one takes n additions.  Rounding grows
+ * with the degree and the number of steps, hence BC_FORWARD_MAX_DEGREE.
+ */
+void BezierCurve::forwardDifference(int segments) {
+	const int count = net.getCount();
+	const int n = count - 1;
+	double fx[BC_FORWARD_MAX_DEGREE + 1], fy[BC_FORWARD_MAX_DEGREE + 1];
+	for(int i = 0; i <= n; i++) {
+		evaluate(net.getX(), net.getY(), count, (1.0 * i) / segments, &fx[i], &fy[i]);
+	}
+
+	// difference table in place: f[k] becomes the k-th difference at u = 0
+	for(int k = 1; k <= n; k++) {
+		for(int i = n; i >= k; i--) {
+			fx[i] -= fx[i - 1];
+			fy[i] -= fy[i - 1];
+		}
+	}
+
+	for(int s = 0; s <= segments; s++) {
+		point2d_t pt = { (float) fx[0], (float) fy[0] };
+		samples.push_back(pt);
+		params.push_back((1.0f * s) / segments);
+
+		for(int k = 0; k < n; k++) {
+			fx[k] += fx[k + 1];
+			fy[k] += fy[k + 1];
+		}
+	}
+}
+
+/*
+ * Emit the end of the piece of curve P controls, over u0 .. u1, once its control polygon lies
+ * within tolerance of its chord; otherwise halve it with de Casteljau and do the same to each
+ * half.  Flat spans come out as few segments, tight curls as many.
+ */
+void BezierCurve::subdivide(const point2d_t* P, float u0, float u1, int depth) {
+	const int count = net.getCount();
+	if(depth == BC_MAX_DEPTH || isFlat(P)) {
+		samples.push_back(P[count - 1]);
+		params.push_back(u1);
+		return;
+	}
+
+	point2d_t* L = &work[count * (1 + 2 * depth)];
+	point2d_t* R = L + count;
+	for(int i = 0; i < count; i++) {
+		R[i] = P[i];
+	}
+
+	// every level leaves its first point in L and, in place, its last in R
+	L[0] = R[0];
+	for(int j = 1; j < count; j++) {
+		for(int i = 0; i < count - j; i++) {
+			R[i].x = 0.5f * (R[i].x + R[i + 1].x);
+			R[i].y = 0.5f * (R[i].y + R[i + 1].y);
+		}
+		L[j] = R[0];
+	}
+
+	const float um = 0.5f * (u0 + u1);
+	subdivide(L, u0, um, depth + 1);
+	subdivide(R, um, u1, depth + 1);
+}
+
+/* whether every control point lies within tolerance of the segment from the first to the last */
+bool BezierCurve::isFlat(const point2d_t* P) {
+	const int count = net.getCount();
+	const point2d_t& a = P[0];
+	const point2d_t& b = P[count - 1];
+	const float dx = b.x - a.x;
+	const float dy = b.y - a.y;
+	const float length2 = dx * dx + dy * dy;
+
+	for(int i = 1; i < count - 1; i++) {
+		float t = length2 > 0.0f ? ((P[i].x - a.x) * dx + (P[i].y - a.y) * dy) / length2 : 0.0f;
+		t = fminf(fmaxf(t, 0.0f), 1.0f);
+		const float ex = P[i].x - (a.x + t * dx);
+		const float ey = P[i].y - (a.y + t * dy);
+		if(ex * ex + ey * ey > tolerance * tolerance) return false;
+	}
+	return true;
+}
@@ -1,61 +1,64 @@
+#include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
 
 #include <GL/glut.h>
 
+#include "BasisTable.h"
 #include "BezierSurface.h"
 
+/* the net the surface is made with by default, row by row */
+static const point3d_t defaultNet[3][3] = {
+	{ { 160, 360, 200 }, { 320, 360, 50 }, { 480, 360, 200 } },
+	{ { 160, 240, 100 }, { 320, 240, 25 }, { 480, 240, 100 } },
+	{ { 160, 120, -50 }, { 320, 120, 50 }, { 480, 120, -50 } }
+};
+
 BezierSurface::BezierSurface() {
 	countHoriz = countVert = 3;
+	for(int i = 0; i < countHoriz; i++) {
+		for(int j = 0; j < countVert; j++) {
+			const point3d_t& p = defaultNet[i][j];
+			net.append(p.x, p.y, p.z);
+		}
+	}
+	Bn.resize(countHoriz);
+	Bm.resize(countVert);
+	nFirst = nLast = mFirst = mLast = 0;
+}
 
-	X[0][0] = 160;
-	Y[0][0] = 360;
-	Z[0][0] = 200;
-
-	X[0][1] = 320;
-	Y[0][1] = Y[0][0];
-	Z[0][1] = 50;
-
-	X[0][2] = 480;
-	Y[0][2] = Y[0][0];
-	Z[0][2] = 200;
-
-	X[1][0] = X[0][0];
-	Y[1][0] = 240;
-	Z[1][0] = 100;
-
-	X[1][1] = X[0][1];
-	Y[1][1] = Y[1][0];
-	Z[1][1] = 25;
-
-	X[1][2] = X[0][2];
-	Y[1][2] = Y[1][0];
-	Z[1][2] = 100;
-
-	X[2][0] = X[0][0];
-	Y[2][0] = 120;
-	Z[2][0] = -50;
-
-	X[2][1] = X[0][1];
-	Y[2][1] = Y[2][0];
-	Z[2][1] = 50;
-
-	X[2][2] = X[0][2];
-	Y[2][2] = Y[2][0];
-	Z[2][2] = -50;
+/* a countHoriz by countVert net spread over the same area, rippling in z */
+BezierSurface::BezierSurface(int countHoriz, int countVert) {
+	this->countHoriz = countHoriz;
+	this->countVert = countVert;
+	for(int i = 0; i < countHoriz; i++) {
+		for(int j = 0; j < countVert; j++) {
+			const float s = (1.0f * i) / (countHoriz - 1);
+			const float t = (1.0f * j) / (countVert - 1);
+			net.append(160 + 320 * t, 360 - 240 * s,
+				100 * sinf(3.0f * (float) M_PI * s) * cosf(2.0f * (float) M_PI * t));
+		}
+	}
+	Bn.resize(countHoriz);
+	Bm.resize(countVert);
+	nFirst = nLast = mFirst = mLast = 0;
 }
 
 BezierSurface::~BezierSurface() {
 }
 
 void BezierSurface::draw() {
+    const float* X = net.getX();
+    const float* Y = net.getY();
+    const float* Z = net.getZ();
+
     // Draw control points
     glPointSize(10);
     glColor3f(1.0f, 0.0f, 0.0f);
     for(int i = 0; i < countHoriz; i++) {
 	    for(int j = 0; j < countVert; j++) {
 		    glBegin(GL_POINTS);
-		        glVertex3f(X[i][j], Y[i][j], Z[i][j]);
+		        glVertex3f(X[i * countVert + j], Y[i * countVert + j], Z[i * countVert + j]);
 		    glEnd();
 	    }
     }
@@ -66,7 +69,7 @@ void BezierSurface::draw() {
     for(int i = 0; i < countHoriz; i++) {
     	glBegin(GL_LINE_STRIP);
 	    	for(int j = 0; j < countVert; j++) {
-        		glVertex3f(X[i][j], Y[i][j], Z[i][j]);
+        		glVertex3f(X[i * countVert + j], Y[i * countVert + j], Z[i * countVert + j]);
 		    }
 	    glEnd();
 	}
@@ -76,59 +79,47 @@ void BezierSurface::draw() {
         glLineWidth(1);
         glColor3f(1.0f, 1.0f, 0.0f);
 
+		if(grid.empty()) tessellate();
+
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3, GL_FLOAT, sizeof(point3d_t), &grid[0]);
 		for(int i = 0; i < BS_MAX_SEGMENTS; i++) {
-       		glBegin(GL_QUAD_STRIP);
-				float u = (1.0f * i) / BS_MAX_SEGMENTS;
-				float uNext = (1.0f * (i+1)) / BS_MAX_SEGMENTS;
-				for(int j = 0; j < BS_MAX_SEGMENTS; j++) {
-					float v = (1.0f * j) / BS_MAX_SEGMENTS;
-					point3d_t pt = getPoint(u, v);
-					point3d_t ptNext = getPoint(uNext, v);
-	
-					glVertex3f(pt.x, pt.y, pt.z);
-					glVertex3f(ptNext.x, ptNext.y, ptNext.z);
-				}
-       		glEnd();
+			glDrawElements(GL_QUAD_STRIP, 2 * BS_MAX_SEGMENTS, GL_UNSIGNED_INT,
+				&strips[i * 2 * BS_MAX_SEGMENTS]);
 		}
+		glDisableClientState(GL_VERTEX_ARRAY);
     }
 }
 
-/* Compute all n-th degree Bernstein Polynomials */
+/*
+ * Evaluate the surface once at every grid point the quad strips use, and list the points each
+ * strip takes: row i and row i + 1, side by side.  The net does not change, so neither do they.
+ */
+void BezierSurface::tessellate() {
+	grid.resize((BS_MAX_SEGMENTS + 1) * BS_MAX_SEGMENTS);
+	strips.resize(BS_MAX_SEGMENTS * 2 * BS_MAX_SEGMENTS);
+	for(int i = 0; i <= BS_MAX_SEGMENTS; i++) {
+		const float u = (1.0f * i) / BS_MAX_SEGMENTS;
+		for(int j = 0; j < BS_MAX_SEGMENTS; j++) {
+			const float v = (1.0f * j) / BS_MAX_SEGMENTS;
+			grid[i * BS_MAX_SEGMENTS + j] = getPoint(u, v);
+
+			if(i < BS_MAX_SEGMENTS) {
+				strips[(i * BS_MAX_SEGMENTS + j) * 2] = i * BS_MAX_SEGMENTS + j;
+				strips[(i * BS_MAX_SEGMENTS + j) * 2 + 1] = (i + 1) * BS_MAX_SEGMENTS + j;
+			}
+		}
+	}
+}
+
+/* Compute all n-th degree Bernstein Polynomials that matter */
 void BezierSurface::allBernsteinU(float u, int countOffset) {
-    float u1 = 1.0 - u;
-    float saved = 0.0f;
-    float temp = 0.0f;
-    Bn[0] = 1.0;
-
-    for(int i = 1; i < countHoriz + countOffset; i++) {
-        saved = 0.0;
-        for(int k = 0; k < i; k++) {
-            temp = Bn[k];
-            Bn[k] = saved + u1 * temp;
-            saved = u * temp;
-        }
-
-        Bn[i] = saved;
-    }
+    BasisTable::evaluate(countHoriz + countOffset, u, &Bn[0], &nFirst, &nLast);
 }
 
-/* Compute all n-th degree Bernstein Polynomials */
+/* Compute all n-th degree Bernstein Polynomials that matter */
 void BezierSurface::allBernsteinV(float v, int countOffset) {
-    float v1 = 1.0 - v;
-    float saved = 0.0f;
-    float temp = 0.0f;
-    Bm[0] = 1.0;
-
-    for(int i = 1; i < countVert + countOffset; i++) {
-        saved = 0.0;
-        for(int k = 0; k < i; k++) {
-            temp = Bm[k];
-            Bm[k] = saved + v1 * temp;
-            saved = v * temp;
-        }
-
-        Bm[i] = saved;
-    }
+    BasisTable::evaluate(countVert + countOffset, v, &Bm[0], &mFirst, &mLast);
 }
 
 /* Compute point on Bezier surface */
@@ -136,11 +127,12 @@ point3d_t BezierSurface::getPoint(float u, float v) {
     allBernsteinU(u);
     allBernsteinV(v);
     point3d_t c = { 0.0f, 0.0f, 0.0f };
-    for(int i = 0; i < countHoriz; i++) {
-    	for(int j = 0; j < countVert; j++) {
-    		c.x += Bn[i] * Bm[j] * X[i][j];
-    		c.y += Bn[i] * Bm[j] * Y[i][j];
-    		c.z += Bn[i] * Bm[j] * Z[i][j];
+    for(int i = nFirst; i < nLast; i++) {
+    	const int row = i * countVert;
+    	for(int j = mFirst; j < mLast; j++) {
+    		c.x += Bn[i] * Bm[j] * net.getX()[row + j];
+    		c.y += Bn[i] * Bm[j] * net.getY()[row + j];
+    		c.z += Bn[i] * Bm[j] * net.getZ()[row + j];
     	}
     }
     return c;
@@ -0,0 +1,41 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "ControlNet.h"
+
+ControlNet::ControlNet() {
+	count = capacity = 0;
+	x = y = z = NULL;
+}
+
+ControlNet::~ControlNet() {
+	free(x);
+	free(y);
+	free(z);
+}
+
+void ControlNet::append(float x, float y, float z) {
+	if(count == capacity) {
+		grow(capacity == 0 ? CN_INITIAL_CAPACITY : capacity * 2);
+	}
+	this->x[count] = x;
+	this->y[count] = y;
+	this->z[count] = z;
+	count++;
+}
+
+/* an aligned copy of the first count floats of old with room for capacity */
+static float* regrow(float* old, int count, int capacity) {
+	void* fresh = NULL;
+	if(posix_memalign(&fresh, CN_ALIGNMENT, sizeof(float) * capacity) != 0) abort();
+	if(old != NULL) memcpy(fresh, old, sizeof(float) * count);
+	free(old);
+	return (float*) fresh;
+}
+
+void ControlNet::grow(int capacity) {
+	x = regrow(x, count, capacity);
+	y = regrow(y, count, capacity);
+	z = regrow(z, count, capacity);
+	this->capacity = capacity;
+}
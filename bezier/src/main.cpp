@@ -3,6 +3,7 @@
 #include <GL/glut.h>
 #include <glui.h>
 
+#include "BSplineCurve.h"
 #include "BezierCurve.h"
 #include "BezierSurface.h"
 #include "Camera.h"
@@ -10,7 +11,8 @@
 /* available menu selections */
 enum {
 	NEW_CURVE, MODIFY, VIEW, CLEAR, QUIT, U, V,
-	NEW_SURFACE, SURF_OK, SURF_X, SURF_Y, CAMERA
+	NEW_SURFACE, SURF_OK, SURF_X, SURF_Y, CAMERA, EVALUATOR, TOLERANCE,
+	NEW_SPLINE, DEGREE, WEIGHT
 };
 
 Camera camera;
@@ -18,12 +20,21 @@ Camera camera;
 /* current bezier shapes */
 BezierCurve *curve = NULL;
 BezierSurface *surface = NULL;
+BSplineCurve *spline = NULL;
 
 /* u, v parameters for tangets and normals */
 float u, v;
 
+/* how curves are turned into line segments, and how far those may stray */
+int evaluator = BC_TABLE;
+float tolerance = BC_TOLERANCE;
+
+/* degree of new splines, and the weight of their selected point */
+int degree = BSC_DEGREE;
+float weight = 1.0f;
+
 /* x, y parms for x and y points in the surface */
-int surf_x, surf_y;
+int surf_x = 3, surf_y = 3;
 
 /* panel holding surface parameters */
 GLUI_Panel *surfPanel = NULL;
@@ -56,6 +67,7 @@ void display() {
 
     if(curve) curve->draw();
     if(surface) surface->draw();
+    if(spline) spline->draw();
 
 	glutSwapBuffers();
 }
@@ -71,8 +83,12 @@ void mouseButton(GLint button, GLint state, GLint x, GLint y) {
 				break;
 			case NEW_SURFACE:
 				break;
+			case NEW_SPLINE:
+				if(spline) spline->addControlPoint(x, windowHeight-y);
+				break;
 			case MODIFY:
 				if(curve) curve->selectControlPoint(x, windowHeight-y);
+				if(spline) spline->selectControlPoint(x, windowHeight-y);
 				break;
 		}
         glutPostRedisplay();
@@ -85,6 +101,7 @@ void mouseMotion(GLint x, GLint y) {
         glutPostRedisplay();
 	} else if(mode == MODIFY) {
         if(curve) curve->modifySelectedControlPoint(x, windowHeight-y);
+        if(spline) spline->modifySelectedControlPoint(x, windowHeight-y);
         glutPostRedisplay();
     }
 }
@@ -103,6 +120,10 @@ void clear() {
     	delete surface;
  	  	surface = NULL;
     }
+    if(spline) {
+    	delete spline;
+    	spline = NULL;
+    }
 }
 
 void exit0() {
@@ -116,6 +137,14 @@ void gluiHandler(int id) {
             mode = NEW_CURVE;
             clear();
             curve = new BezierCurve();
+            curve->setEvaluator(evaluator);
+            curve->setTolerance(tolerance);
+			break;
+		case NEW_SPLINE:
+            mode = NEW_SPLINE;
+            clear();
+            spline = new BSplineCurve();
+            spline->setDegree(degree);
 			break;
 		case NEW_SURFACE:
             mode = NEW_SURFACE;
@@ -128,7 +157,7 @@ void gluiHandler(int id) {
 		case SURF_OK:
 			surfPanel->disable();
             clear();
-			surface = new BezierSurface();
+			surface = new BezierSurface(surf_y, surf_x);
 			glutPostRedisplay(); /* DELETE */
 			break;
         case MODIFY:
@@ -146,9 +175,26 @@ void gluiHandler(int id) {
 			break;
 		case U:
 			if(curve) curve->setTangentU(u);
+			if(spline) spline->setTangentU(u);
 			break;
 		case V:
 			break;
+		case EVALUATOR:
+			if(curve) curve->setEvaluator(evaluator);
+			glutPostRedisplay();
+			break;
+		case TOLERANCE:
+			if(curve) curve->setTolerance(tolerance);
+			glutPostRedisplay();
+			break;
+		case DEGREE:
+			if(spline) spline->setDegree(degree);
+			glutPostRedisplay();
+			break;
+		case WEIGHT:
+			if(spline) spline->setSelectedWeight(weight);
+			glutPostRedisplay();
+			break;
 		case QUIT:
 			exit0();
 			break;
@@ -160,15 +206,16 @@ void initGLUI(int window) {
 	gluiSide->set_main_gfx_window(window);
 
 	gluiSide->add_button("New Curve",     NEW_CURVE,   gluiHandler);
+	gluiSide->add_button("New Spline",    NEW_SPLINE,  gluiHandler);
 
 	gluiSide->add_button("New Surface",   NEW_SURFACE, gluiHandler);
 	surfPanel = gluiSide->add_panel("Surface Parms", GLUI_PANEL_EMBOSSED);
 	GLUI_Spinner *xS = gluiSide->add_spinner_to_panel(surfPanel, "X Pts.", 
 									GLUI_SPINNER_INT, &surf_x, SURF_X, gluiHandler);
-	xS->set_int_limits(3, 10);
+	xS->set_int_limits(3, 200);
 	GLUI_Spinner *yS = gluiSide->add_spinner_to_panel(surfPanel, "Y Pts.", 
 									GLUI_SPINNER_INT, &surf_y, SURF_Y, gluiHandler);
-	yS->set_int_limits(3, 10);
+	yS->set_int_limits(3, 200);
 	gluiSide->add_button_to_panel(surfPanel, "Ok", SURF_OK, gluiHandler);
 	surfPanel->disable();
 
@@ -187,6 +234,28 @@ void initGLUI(int window) {
 
 	gluiSide->add_separator();
 
+	GLUI_Panel *evalPanel = gluiSide->add_panel("Evaluator", GLUI_PANEL_EMBOSSED);
+	GLUI_RadioGroup *evalGroup = gluiSide->add_radiogroup_to_panel(evalPanel, &evaluator,
+									EVALUATOR, gluiHandler);
+	gluiSide->add_radiobutton_to_group(evalGroup, "Bernstein");
+	gluiSide->add_radiobutton_to_group(evalGroup, "Basis Table");
+	gluiSide->add_radiobutton_to_group(evalGroup, "Forward Diff.");
+	gluiSide->add_radiobutton_to_group(evalGroup, "Subdivision");
+	GLUI_Spinner *tS = gluiSide->add_spinner("Tolerance", GLUI_SPINNER_FLOAT, &tolerance,
+									TOLERANCE, gluiHandler);
+	tS->set_float_limits(0.05f, 10.0f);
+
+	gluiSide->add_separator();
+
+	GLUI_Spinner *dS = gluiSide->add_spinner("Degree", GLUI_SPINNER_INT, &degree, DEGREE,
+									gluiHandler);
+	dS->set_int_limits(1, BSC_MAX_DEGREE);
+	GLUI_Spinner *wS = gluiSide->add_spinner("Weight", GLUI_SPINNER_FLOAT, &weight, WEIGHT,
+									gluiHandler);
+	wS->set_float_limits(0.1f, 10.0f);
+
+	gluiSide->add_separator();
+
 	gluiSide->add_button("Quit", QUIT, gluiHandler);
 }
 
@@ -0,0 +1,253 @@
+/*
+ * paint_damage: drag a new line over a canvas full of committed strokes and report as JSON how
+ * long each redisplay takes when the whole canvas is repainted and when only the damage is, with
+ * committed paintables drawn one by one or from the raster layer, and how many frames draw the
+ * same pixels as repainting everything one by one
+ *
+ * usage: paint_damage [-count n] [-events n] [-seed n] [-length n]
+ *
+ * the strokes are short scribbles of dots, with a line every tenth, scattered over the canvas.
+ * the drag reports one motion event per redisplay, swinging the line's end -length pixels
+ * around its start.  (-frames is taken by the headless glutInit.)
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include <glut.h>
+#include <softgl.h>
+
+#include "Canvas.h"
+#include "Dots.h"
+#include "Line.h"
+#include "LineTool.h"
+#include "Paint.h"
+
+/* benchmark parameters */
+struct options {
+	int count;
+	int events;
+	unsigned int seed;
+	float length;
+} options = { 50000, 60, 1, 150.0f };
+
+/** hands what the tool makes to the canvas as Paint does, repainting all of it if asked */
+class Forward : public ToolListener {
+	public:
+		Forward(Canvas* canvas, bool whole) : active(NULL), canvas(canvas), whole(whole) {}
+
+		void intermediatePaintableCreated(Paintable* p) {
+			canvas->setActivePaintable(p);
+			active = p;
+		}
+
+		void finalPaintableCreated(Paintable* p) {
+			canvas->setActivePaintable(NULL);
+			canvas->addPaintable(p);
+			active = NULL;
+		}
+
+		/** redisplay, returning how long it took */
+		double draw() {
+			if(whole) canvas->invalidate();
+			const double start = now();
+			canvas->drawScene();
+			return now() - start;
+		}
+
+		static double now() {
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			return ts.tv_sec + ts.tv_nsec * 1e-9;
+		}
+
+		/** what the tool is making, NULL once it is done */
+		Paintable* active;
+
+	private:
+		Canvas* canvas;
+		bool whole;
+};
+
+/** per frame times and checksums of one drag */
+struct result {
+	const char* name;
+	bool whole, layer;
+	std::vector< double > seconds;
+	std::vector< uint64_t > checksums;
+};
+
+static void parseArgs(int argc, char** argv) {
+	for(int i = 1; i < argc; i++) {
+		if(i + 1 >= argc) {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		} else if(strcmp(argv[i], "-count") == 0) {
+			options.count = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-events") == 0) {
+			options.events = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-seed") == 0) {
+			options.seed = (unsigned int) strtoul(argv[++i], NULL, 10);
+		} else if(strcmp(argv[i], "-length") == 0) {
+			options.length = (float) atof(argv[++i]);
+		} else {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		}
+	}
+}
+
+static float uniform() {
+	return rand() / (float) RAND_MAX;
+}
+
+/** scatter the committed strokes over the canvas */
+static void populate(Canvas* canvas, int count) {
+	static const GLfloat sizes[] = { 2.0f, 4.0f, 8.0f };
+	srand(options.seed);
+	for(int i = 0; i < count; i++) {
+		struct color4f c = { uniform(), uniform(), uniform(), 1.0f };
+		struct point2f p = { WORLD_X1 * uniform(), WORLD_Y1 * uniform() };
+
+		if(i % 10 == 9) {
+			Line* line = new Line();
+			line->setColor(c);
+			line->setLineWidth(sizes[i % 3]);
+			line->setStart(p);
+			struct point2f end = { p.x + 80.0f * (uniform() - 0.5f), p.y + 80.0f * (uniform() - 0.5f) };
+			line->setEnd(end);
+			canvas->addPaintable(line);
+			continue;
+		}
+
+		Dots* dots = new Dots(canvas->getArena());
+		dots->setColor(c);
+		dots->setPointSize(sizes[i % 3]);
+		float heading = 6.2831853f * uniform();
+		const int n = 8 + rand() % 17;
+		for(int k = 0; k < n; k++) {
+			dots->addPoint(p.x, p.y);
+			heading += 0.6f * (uniform() - 0.5f);
+			p.x += 3.0f * cosf(heading);
+			p.y += 3.0f * sinf(heading);
+		}
+		canvas->addPaintable(dots);
+	}
+}
+
+/** the line's end on the given frame of the drag, in window pixels */
+static struct point2f dragEnd(struct point2f start, int frame) {
+	const float angle = 6.2831853f * frame / options.events;
+	struct point2f p = {
+		start.x + options.length * cosf(angle), start.y + options.length * sinf(angle)
+	};
+	return p;
+}
+
+/** window pixels to world, as Paint does */
+static struct point2f toWorld(struct point2f p) {
+	struct point2f w = {
+		WORLD_X1 * p.x / (float) WINDOW_INIT_WIDTH,
+		WORLD_Y1 * (WINDOW_INIT_HEIGHT - p.y) / (float) WINDOW_INIT_HEIGHT
+	};
+	return w;
+}
+
+/**
+ * drag a line around, redisplaying after every event.  unless the line is kept, the drag is
+ * abandoned at the end so the next one starts from the same canvas
+ */
+static void drag(Canvas* canvas, bool keep, struct result& r) {
+	Forward forward(canvas, r.whole);
+	LineTool tool(canvas->getLinePool());
+	tool.addToolListener(&forward);
+	canvas->enableLayer(r.layer);
+
+	// start from a fully drawn canvas
+	canvas->invalidate();
+	canvas->drawScene();
+
+	const struct point2f start = { WINDOW_INIT_WIDTH / 2.0f, WINDOW_INIT_HEIGHT / 2.0f };
+	tool.mouseDown(toWorld(start));
+	for(int f = 0; f < options.events; f++) {
+		if(f > 0) tool.mouseMove(toWorld(dragEnd(start, f)));
+		r.seconds.push_back(forward.draw());
+		r.checksums.push_back(sglChecksum());
+	}
+
+	if(keep) {
+		tool.mouseUp(toWorld(dragEnd(start, options.events)));
+	} else {
+		canvas->setActivePaintable(NULL);
+		delete forward.active;
+	}
+}
+
+static int compare(const void* a, const void* b) {
+	const double x = *(const double*) a, y = *(const double*) b;
+	return x < y ? -1 : x > y;
+}
+
+static void report(const struct result& r, const struct result& reference, bool last) {
+	int matching = 0;
+	for(size_t f = 0; f < r.checksums.size(); f++) {
+		if(r.checksums[f] == reference.checksums[f]) matching++;
+	}
+
+	std::vector< double > sorted(r.seconds);
+	qsort(&sorted[0], sorted.size(), sizeof(double), compare);
+	double total = 0.0;
+	for(size_t i = 0; i < sorted.size(); i++) {
+		total += sorted[i];
+	}
+
+	printf("    \"%s\": {\n", r.name);
+	printf("      \"ms_per_frame\": %.3f,\n", total * 1e3 / sorted.size());
+	printf("      \"median_ms\": %.3f,\n", sorted[sorted.size() / 2] * 1e3);
+	printf("      \"max_ms\": %.3f,\n", sorted[sorted.size() - 1] * 1e3);
+	printf("      \"frames_matching\": %d\n", matching);
+	printf("    }%s\n", last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+	glutInit(&argc, argv);
+	parseArgs(argc, argv);
+	if(options.events < 1) options.events = 1;
+
+	glutInitWindowSize(WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+	glutCreateWindow(WINDOW_TITLE_BASE);
+	Canvas canvas;
+	glViewport(0, 0, WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+
+	Tool::setLineWidth(4.0f);
+	populate(&canvas, options.count);
+
+	/* the first repaints everything one by one, as paint used to, the last keeps its line */
+	struct result modes[4];
+	modes[0].name = "whole";
+	modes[1].name = "damage";
+	modes[2].name = "layer";
+	modes[3].name = "layer_damage";
+	for(int m = 0; m < 4; m++) {
+		modes[m].whole = (m & 1) == 0;
+		modes[m].layer = (m & 2) != 0;
+		drag(&canvas, m == 3, modes[m]);
+	}
+
+	printf("{\n");
+	printf("  \"paintables\": %d,\n", options.count);
+	printf("  \"events\": %d,\n", options.events);
+	printf("  \"modes\": {\n");
+	for(int m = 0; m < 4; m++) {
+		report(modes[m], modes[0], m == 3);
+	}
+	printf("  }\n");
+	printf("}\n");
+
+	for(int m = 1; m < 4; m++) {
+		if(modes[m].checksums != modes[0].checksums) return 1;
+	}
+	return 0;
+}
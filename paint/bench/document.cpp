@@ -0,0 +1,278 @@
+/*
+ * paint_document: fill a canvas with strokes, lines and rectangles, then save and load it as a
+ * Document and through a naive text serializer, and report as JSON how long each took, how big
+ * the files are and whether both came back the same
+ *
+ * usage: paint_document [-count n] [-points n] [-seed n]
+ *
+ * strokes have 1 to 2 * -points dots.  the files are written to the working directory and
+ * removed afterwards.  the Document is loaded straight after it is saved, from the page cache.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <sys/stat.h>
+
+#include <vector>
+
+#include <glut.h>
+
+#include "Canvas.h"
+#include "Dots.h"
+#include "Line.h"
+#include "Paint.h"
+#include "Rectangle.h"
+
+#define BINARY_PATH "paint_document.pnt"
+#define AGAIN_PATH "paint_document_again.pnt"
+#define TEXT_PATH "paint_document.txt"
+
+/* benchmark parameters */
+struct options {
+	int count;
+	int points;
+	unsigned int seed;
+} options = { 200000, 32, 1 };
+
+/** what saving or loading one way took */
+struct result {
+	const char* name;
+	double save, load;
+	long bytes;
+	bool same;
+};
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void parseArgs(int argc, char** argv) {
+	for(int i = 1; i < argc; i++) {
+		if(i + 1 >= argc) {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		} else if(strcmp(argv[i], "-count") == 0) {
+			options.count = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-points") == 0) {
+			options.points = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-seed") == 0) {
+			options.seed = (unsigned int) strtoul(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		}
+	}
+}
+
+static float randf(float lo, float hi) {
+	return lo + (hi - lo) * rand() / (float) RAND_MAX;
+}
+
+static struct point2f randomPoint() {
+	struct point2f p = { randf(WORLD_X0, WORLD_X1), randf(WORLD_Y0, WORLD_Y1) };
+	return p;
+}
+
+/** mostly strokes, the rest lines and rectangles, in random colors and sizes */
+static void populate(Arena* arena, std::vector< Paintable* >& paintables) {
+	srand(options.seed);
+	for(int i = 0; i < options.count; i++) {
+		Paintable* p;
+		const int kind = rand() % 10;
+		if(kind < 8) {
+			Dots* dots = new Dots(arena);
+			struct point2f at = randomPoint();
+			const int n = 1 + rand() % (2 * options.points);
+			for(int j = 0; j < n; j++) {
+				dots->addPoint(at.x, at.y);
+				at.x += randf(-4.0f, 4.0f);
+				at.y += randf(-4.0f, 4.0f);
+			}
+			p = dots;
+		} else if(kind == 8) {
+			Line* line = new Line();
+			line->setStart(randomPoint());
+			line->setEnd(randomPoint());
+			p = line;
+		} else {
+			Rectangle* rect = new Rectangle(rand() % 2 == 0);
+			rect->setStart(randomPoint());
+			rect->setEnd(randomPoint());
+			p = rect;
+		}
+
+		struct color4f c = { randf(0.0f, 1.0f), randf(0.0f, 1.0f), randf(0.0f, 1.0f), 1.0f };
+		p->setColor(c);
+		p->setPointSize((GLfloat) (1 << (rand() % 4 + 1)));
+		p->setLineWidth((GLfloat) (1 << (rand() % 4 + 1)));
+		paintables.push_back(p);
+	}
+}
+
+static void writeStyle(FILE* fp, const char* kind, Paintable* p) {
+	const struct color4f c = p->getColor();
+	fprintf(fp, "%s %.9g %.9g %.9g %.9g %.9g %.9g", kind, c.r, c.g, c.b, c.a, p->getPointSize(),
+		p->getLineWidth());
+}
+
+/** write paintables as text, a line each */
+static bool saveText(const std::vector< Paintable* >& paintables, const char* path) {
+	FILE* fp = fopen(path, "w");
+	if(fp == NULL) return false;
+
+	for(size_t i = 0; i < paintables.size(); i++) {
+		Paintable* p = paintables[i];
+		if(Dots* dots = dynamic_cast< Dots* >(p)) {
+			writeStyle(fp, "dots", p);
+			fprintf(fp, " %d", dots->getCount());
+			for(int j = 0; j < dots->getCount(); j++) {
+				fprintf(fp, " %.9g %.9g", dots->getPoints()[j].x, dots->getPoints()[j].y);
+			}
+		} else if(Line* line = dynamic_cast< Line* >(p)) {
+			writeStyle(fp, "line", p);
+			fprintf(fp, " %.9g %.9g %.9g %.9g", line->getStart().x, line->getStart().y,
+				line->getEnd().x, line->getEnd().y);
+		} else if(Rectangle* rect = dynamic_cast< Rectangle* >(p)) {
+			writeStyle(fp, rect->isFilled() ? "fill" : "rect", p);
+			fprintf(fp, " %.9g %.9g %.9g %.9g", rect->getStart().x, rect->getStart().y,
+				rect->getEnd().x, rect->getEnd().y);
+		}
+		fprintf(fp, "\n");
+	}
+	return fclose(fp) == 0;
+}
+
+/** read paintables written by saveText onto the canvas */
+static bool loadText(Canvas* canvas, const char* path) {
+	FILE* fp = fopen(path, "r");
+	if(fp == NULL) return false;
+
+	canvas->clear();
+	char kind[8];
+	struct color4f c;
+	GLfloat size, width;
+	while(fscanf(fp, "%7s %f %f %f %f %f %f", kind, &c.r, &c.g, &c.b, &c.a, &size, &width) == 7) {
+		Paintable* p = NULL;
+		if(strcmp(kind, "dots") == 0) {
+			Dots* dots = new Dots(canvas->getArena());
+			int n = 0;
+			if(fscanf(fp, "%d", &n) != 1) n = 0;
+			for(int j = 0; j < n; j++) {
+				struct point2f at;
+				if(fscanf(fp, "%f %f", &at.x, &at.y) == 2) {
+					dots->addPoint(at.x, at.y);
+				}
+			}
+			p = dots;
+		} else {
+			struct point2f start, end;
+			if(fscanf(fp, "%f %f %f %f", &start.x, &start.y, &end.x, &end.y) != 4) break;
+			if(strcmp(kind, "line") == 0) {
+				Line* line = new Line();
+				line->setStart(start);
+				line->setEnd(end);
+				p = line;
+			} else {
+				Rectangle* rect = new Rectangle(strcmp(kind, "fill") == 0);
+				rect->setStart(start);
+				rect->setEnd(end);
+				p = rect;
+			}
+		}
+		p->setColor(c);
+		p->setPointSize(size);
+		p->setLineWidth(width);
+		canvas->addPaintable(p);
+	}
+	fclose(fp);
+	return true;
+}
+
+static long fileSize(const char* path) {
+	struct stat st;
+	return stat(path, &st) == 0 ? (long) st.st_size : -1;
+}
+
+/** if two files hold the same bytes */
+static bool sameFiles(const char* a, const char* b) {
+	FILE* fa = fopen(a, "rb");
+	FILE* fb = fopen(b, "rb");
+	bool same = fa != NULL && fb != NULL;
+
+	static char ba[1 << 16], bb[1 << 16];
+	while(same) {
+		const size_t na = fread(ba, 1, sizeof(ba), fa);
+		const size_t nb = fread(bb, 1, sizeof(bb), fb);
+		same = na == nb && memcmp(ba, bb, na) == 0;
+		if(na == 0) break;
+	}
+	if(fa != NULL) fclose(fa);
+	if(fb != NULL) fclose(fb);
+	return same;
+}
+
+static void report(const struct result& r, bool last) {
+	printf("    \"%s\": {\n", r.name);
+	printf("      \"bytes\": %ld,\n", r.bytes);
+	printf("      \"save_ms\": %.2f,\n", r.save * 1e3);
+	printf("      \"load_ms\": %.2f,\n", r.load * 1e3);
+	printf("      \"same\": %s\n", r.same ? "true" : "false");
+	printf("    }%s\n", last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+	glutInit(&argc, argv);
+	parseArgs(argc, argv);
+
+	glutInitWindowSize(WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+	glutCreateWindow(WINDOW_TITLE_BASE);
+	Canvas canvas;
+	glViewport(0, 0, WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+
+	std::vector< Paintable* > paintables;
+	populate(canvas.getArena(), paintables);
+	for(size_t i = 0; i < paintables.size(); i++) {
+		canvas.addPaintable(paintables[i]);
+	}
+
+	struct result binary = { "document", 0.0, 0.0, 0, false };
+	struct result text = { "text", 0.0, 0.0, 0, false };
+
+	double start = now();
+	bool ok = canvas.save(BINARY_PATH);
+	binary.save = now() - start;
+	binary.bytes = fileSize(BINARY_PATH);
+
+	start = now();
+	ok = saveText(paintables, TEXT_PATH) && ok;
+	text.save = now() - start;
+	text.bytes = fileSize(TEXT_PATH);
+
+	// each way loaded, the canvas has to save just as it did to begin with
+	start = now();
+	ok = canvas.load(BINARY_PATH) && ok;
+	binary.load = now() - start;
+	binary.same = canvas.save(AGAIN_PATH) && sameFiles(BINARY_PATH, AGAIN_PATH);
+
+	start = now();
+	ok = loadText(&canvas, TEXT_PATH) && ok;
+	text.load = now() - start;
+	text.same = canvas.save(AGAIN_PATH) && sameFiles(BINARY_PATH, AGAIN_PATH);
+
+	remove(BINARY_PATH);
+	remove(AGAIN_PATH);
+	remove(TEXT_PATH);
+
+	printf("{\n");
+	printf("  \"paintables\": %d,\n", options.count);
+	printf("  \"written\": %s,\n", ok ? "true" : "false");
+	printf("  \"formats\": {\n");
+	report(binary, false);
+	report(text, true);
+	printf("  }\n");
+	printf("}\n");
+
+	return ok && binary.same && text.same ? 0 : 1;
+}
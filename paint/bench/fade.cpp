@@ -0,0 +1,184 @@
+/*
+ * paint_fade: fade a canvas full of paintables until they are all gone and report as JSON what
+ * a tick and the pruning after it cost, as the canvas does it and as it used to: one walk
+ * through every paintable per tick and one erase per dead paintable
+ *
+ * usage: paint_fade [-count n] [-levels n] [-seed n]
+ *
+ * the paintables start at -levels different alphas, so that whole batches fade away together,
+ * or at random alphas if 0.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include <glut.h>
+
+#include "Canvas.h"
+#include "Dots.h"
+#include "Paint.h"
+
+/* benchmark parameters */
+struct options {
+	int count;
+	int levels;
+	unsigned int seed;
+} options = { 100000, 4, 1 };
+
+/** what fading all the paintables away took */
+struct result {
+	const char* name;
+	int ticks;
+	double tick, prune, worstTick, worstPrune;
+	std::vector< int > left;
+};
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void parseArgs(int argc, char** argv) {
+	for(int i = 1; i < argc; i++) {
+		if(i + 1 >= argc) {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		} else if(strcmp(argv[i], "-count") == 0) {
+			options.count = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-levels") == 0) {
+			options.levels = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-seed") == 0) {
+			options.seed = (unsigned int) strtoul(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		}
+	}
+}
+
+/** the same paintables every time, a dot each */
+static void populate(Arena* arena, std::vector< Paintable* >& paintables) {
+	srand(options.seed);
+	for(int i = 0; i < options.count; i++) {
+		float alpha = (rand() + 1.0f) / (RAND_MAX + 1.0f);
+		if(options.levels > 0) {
+			alpha = (1 + rand() % options.levels) / (float) options.levels;
+		}
+		struct color4f c = { 1.0f, 1.0f, 1.0f, alpha };
+
+		Dots* dots = new Dots(arena);
+		dots->setColor(c);
+		dots->setPointSize(2.0f);
+		dots->addPoint(WORLD_X1 * rand() / (float) RAND_MAX, WORLD_Y1 * rand() / (float) RAND_MAX);
+		paintables.push_back(dots);
+	}
+}
+
+static void account(struct result& r, double tick, double prune, int left) {
+	r.ticks++;
+	r.tick += tick;
+	r.prune += prune;
+	r.worstTick = tick > r.worstTick ? tick : r.worstTick;
+	r.worstPrune = prune > r.worstPrune ? prune : r.worstPrune;
+	r.left.push_back(left);
+}
+
+/** fade as Canvas::tick and drawScene used to, through every paintable */
+static void fadeBefore(struct result& r) {
+	Arena arena;
+	std::vector< Paintable* > paintables;
+	populate(&arena, paintables);
+
+	while(!paintables.empty()) {
+		double start = now();
+		std::vector< Paintable* >::const_iterator c = paintables.begin();
+		while(c != paintables.end()) {
+			struct color4f color = (*c)->getColor();
+			if(color.a <= 0.0f) {
+				(*c)->kill();
+			} else {
+				color.a -= 0.005f;
+				(*c)->setColor(color);
+			}
+			c++;
+		}
+		const double tick = now() - start;
+
+		start = now();
+		std::vector< Paintable* >::iterator itr = paintables.begin();
+		while(itr != paintables.end()) {
+			Paintable* p = *itr;
+			if(p->isDead()) {
+				itr = paintables.erase(itr);
+				delete p;
+			} else {
+				itr++;
+			}
+		}
+		account(r, tick, now() - start, (int) paintables.size());
+	}
+}
+
+/** fade as the canvas does */
+static void fadeCanvas(Canvas* canvas, struct result& r) {
+	std::vector< Paintable* > paintables;
+	populate(canvas->getArena(), paintables);
+	for(size_t i = 0; i < paintables.size(); i++) {
+		canvas->addPaintable(paintables[i]);
+	}
+	canvas->enableFade(true);
+
+	int left = options.count;
+	while(left > 0) {
+		double start = now();
+		canvas->tick();
+		const double tick = now() - start;
+
+		start = now();
+		canvas->prune();
+		const double prune = now() - start;
+
+		left = canvas->getPaintableCount();
+		account(r, tick, prune, left);
+	}
+}
+
+static void report(const struct result& r, bool last) {
+	printf("    \"%s\": {\n", r.name);
+	printf("      \"ticks\": %d,\n", r.ticks);
+	printf("      \"tick_us\": %.2f,\n", r.ticks ? r.tick * 1e6 / r.ticks : 0.0);
+	printf("      \"prune_us\": %.2f,\n", r.ticks ? r.prune * 1e6 / r.ticks : 0.0);
+	printf("      \"worst_tick_us\": %.2f,\n", r.worstTick * 1e6);
+	printf("      \"worst_prune_us\": %.2f\n", r.worstPrune * 1e6);
+	printf("    }%s\n", last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+	glutInit(&argc, argv);
+	parseArgs(argc, argv);
+
+	glutInitWindowSize(WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+	glutCreateWindow(WINDOW_TITLE_BASE);
+	Canvas canvas;
+	glViewport(0, 0, WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+
+	struct result before = { "before", 0, 0.0, 0.0, 0.0, 0.0, std::vector< int >() };
+	struct result after = { "canvas", 0, 0.0, 0.0, 0.0, 0.0, std::vector< int >() };
+	fadeBefore(before);
+	fadeCanvas(&canvas, after);
+
+	printf("{\n");
+	printf("  \"paintables\": %d,\n", options.count);
+	printf("  \"levels\": %d,\n", options.levels);
+	printf("  \"kernel\": \"%s\",\n", canvas.getFadeKernelName());
+	printf("  \"same_survivors\": %s,\n", before.left == after.left ? "true" : "false");
+	printf("  \"modes\": {\n");
+	report(before, false);
+	report(after, true);
+	printf("  }\n");
+	printf("}\n");
+
+	return before.left == after.left ? 0 : 1;
+}
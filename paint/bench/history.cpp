@@ -0,0 +1,154 @@
+/*
+ * paint_history: commit paintables to a canvas with a clear now and then, then undo all of it,
+ * redo all of it and wander back and forth at random, and report as JSON what a step cost and
+ * whether the canvas ended up showing what it should
+ *
+ * usage: paint_history [-count n] [-clears n] [-walk n] [-seed n]
+ *
+ * a clear comes after every -clears paintables, never if 0.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include <glut.h>
+
+#include "Canvas.h"
+#include "Dots.h"
+#include "Paint.h"
+
+/* benchmark parameters */
+struct options {
+	int count;
+	int clears;
+	int walk;
+	unsigned int seed;
+} options = { 300000, 10000, 100000, 1 };
+
+/** what a run of steps took */
+struct result {
+	const char* name;
+	int steps;
+	double time, worst;
+};
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void parseArgs(int argc, char** argv) {
+	for(int i = 1; i < argc; i++) {
+		if(i + 1 >= argc) {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		} else if(strcmp(argv[i], "-count") == 0) {
+			options.count = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-clears") == 0) {
+			options.clears = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-walk") == 0) {
+			options.walk = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-seed") == 0) {
+			options.seed = (unsigned int) strtoul(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		}
+	}
+}
+
+static void account(struct result& r, double time) {
+	r.steps++;
+	r.time += time;
+	r.worst = time > r.worst ? time : r.worst;
+}
+
+/** one undo or redo, timed */
+static bool step(Canvas* canvas, bool back, struct result& r) {
+	const double start = now();
+	const bool done = back ? canvas->undo() : canvas->redo();
+	account(r, now() - start);
+	return done;
+}
+
+static void report(const struct result& r, bool last) {
+	printf("    \"%s\": {\n", r.name);
+	printf("      \"steps\": %d,\n", r.steps);
+	printf("      \"step_ns\": %.1f,\n", r.steps ? r.time * 1e9 / r.steps : 0.0);
+	printf("      \"worst_step_us\": %.2f\n", r.worst * 1e6);
+	printf("    }%s\n", last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+	glutInit(&argc, argv);
+	parseArgs(argc, argv);
+
+	glutInitWindowSize(WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+	glutCreateWindow(WINDOW_TITLE_BASE);
+	Canvas canvas;
+	glViewport(0, 0, WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+
+	/*
+	 * commit as finalPaintableCreated does, remembering how many paintables the canvas should
+	 * show after every command
+	 */
+	srand(options.seed);
+	std::vector< int > shown(1, 0);
+	struct result commit = { "commit", 0, 0.0, 0.0 };
+	for(int i = 0; i < options.count; i++) {
+		struct color4f c = { 1.0f, 1.0f, 1.0f, 1.0f };
+		Dots* dots = new Dots(canvas.getArena());
+		dots->setColor(c);
+		dots->setPointSize(2.0f);
+		dots->addPoint(WORLD_X1 * rand() / (float) RAND_MAX, WORLD_Y1 * rand() / (float) RAND_MAX);
+
+		const double start = now();
+		canvas.addPaintable(dots);
+		account(commit, now() - start);
+		shown.push_back(shown.back() + 1);
+
+		if(options.clears > 0 && (i + 1) % options.clears == 0 && i + 1 < options.count) {
+			canvas.clear();
+			shown.push_back(0);
+		}
+	}
+	const int commands = (int) shown.size() - 1;
+
+	bool right = canvas.getPaintableCount() == shown.back();
+
+	// all the way back and all the way forward again
+	struct result undo = { "undo_all", 0, 0.0, 0.0 };
+	while(step(&canvas, true, undo));
+	right = right && undo.steps == commands + 1 && canvas.getPaintableCount() == 0;
+
+	struct result redo = { "redo_all", 0, 0.0, 0.0 };
+	while(step(&canvas, false, redo));
+	right = right && redo.steps == commands + 1 && canvas.getPaintableCount() == shown.back();
+
+	// a random walk, checking the canvas against where the walk is
+	struct result walk = { "walk", 0, 0.0, 0.0 };
+	int at = commands;
+	for(int i = 0; i < options.walk; i++) {
+		const bool back = rand() % 2 == 0;
+		if(step(&canvas, back, walk)) {
+			at += back ? -1 : 1;
+		}
+		right = right && canvas.getPaintableCount() == shown[at];
+	}
+
+	printf("{\n");
+	printf("  \"paintables\": %d,\n", options.count);
+	printf("  \"commands\": %d,\n", commands);
+	printf("  \"canvas_right\": %s,\n", right ? "true" : "false");
+	printf("  \"modes\": {\n");
+	report(commit, false);
+	report(undo, false);
+	report(redo, false);
+	report(walk, true);
+	printf("  }\n");
+	printf("}\n");
+
+	return right ? 0 : 1;
+}
@@ -0,0 +1,264 @@
+/*
+ * paint_input: drag a tool across a crowded canvas with a fast mouse, handing every event to the
+ * tool as it arrives and redrawing whenever the last frame is done, as the input callbacks used
+ * to, or queueing events and dispatching them once a frame at the display rate, and report as
+ * JSON how many tool updates and redraws that took and how long events waited to be drawn
+ *
+ * usage: paint_input [-count n] [-events n] [-rate hz] [-display hz] [-tool scribble|line]
+ *                    [-seed n]
+ *
+ * time is simulated: events arrive -rate times a second, and every dispatch and redraw moves
+ * the clock on by what it really took.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <vector>
+
+#include <glut.h>
+
+#include "Canvas.h"
+#include "Dots.h"
+#include "DotTool.h"
+#include "InputQueue.h"
+#include "LineTool.h"
+#include "Paint.h"
+
+/* benchmark parameters */
+struct options {
+	int count;
+	int events;
+	double rate;
+	double display;
+	const char* tool;
+	unsigned int seed;
+} options = { 20000, 2000, 1000.0, 60.0, "scribble", 1 };
+
+/** an event as the input callbacks would see it */
+struct event {
+	enum InputQueue::kind kind;
+	struct point2f p;
+	double time;
+};
+
+/** what dragging the tool took one way */
+struct result {
+	const char* name;
+	int updates, frames;
+	double busy, latency, worst, span;
+	int paintables;
+};
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void parseArgs(int argc, char** argv) {
+	for(int i = 1; i < argc; i++) {
+		if(i + 1 >= argc) {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		} else if(strcmp(argv[i], "-count") == 0) {
+			options.count = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-events") == 0) {
+			options.events = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-rate") == 0) {
+			options.rate = atof(argv[++i]);
+		} else if(strcmp(argv[i], "-display") == 0) {
+			options.display = atof(argv[++i]);
+		} else if(strcmp(argv[i], "-tool") == 0) {
+			options.tool = argv[++i];
+		} else if(strcmp(argv[i], "-seed") == 0) {
+			options.seed = (unsigned int) strtoul(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		}
+	}
+}
+
+/** stands in for Paint, counting what the tool tells it */
+class Listener : public ToolListener {
+	public:
+		Listener(Canvas* canvas) : canvas(canvas), updates(0) { }
+
+		void intermediatePaintableCreated(Paintable* p) {
+			canvas->setActivePaintable(p);
+			updates++;
+		}
+
+		void finalPaintableCreated(Paintable* p) {
+			canvas->setActivePaintable(NULL);
+			canvas->addPaintable(p);
+			updates++;
+		}
+
+		Canvas* canvas;
+		int updates;
+};
+
+/** a crowd of dots to redraw, the same every time */
+static void populate(Canvas* canvas) {
+	srand(options.seed);
+	for(int i = 0; i < options.count; i++) {
+		struct color4f c = { 1.0f, 1.0f, 1.0f, 0.5f };
+		Dots* dots = new Dots(canvas->getArena());
+		dots->setColor(c);
+		dots->setPointSize(4.0f);
+		dots->addPoint(WORLD_X1 * rand() / (float) RAND_MAX, WORLD_Y1 * rand() / (float) RAND_MAX);
+		canvas->addPaintable(dots);
+	}
+}
+
+/** one drag, a press and then a spiral of moves to the release */
+static void makeEvents(std::vector< struct event >& events) {
+	for(int i = 0; i < options.events; i++) {
+		const float t = i / (float) options.events;
+		struct event e;
+		e.kind = i == 0 ? InputQueue::DOWN : i + 1 == options.events ? InputQueue::UP :
+			InputQueue::MOVE;
+		e.p.x = WORLD_X1 / 2 + cosf(t * 40.0f) * t * WORLD_Y1 / 2;
+		e.p.y = WORLD_Y1 / 2 + sinf(t * 40.0f) * t * WORLD_Y1 / 2;
+		e.time = i / options.rate;
+		events.push_back(e);
+	}
+}
+
+static Tool* makeTool(Canvas* canvas) {
+	if(strcmp(options.tool, "line") == 0) return new LineTool(canvas->getLinePool());
+	return new DotTool(false, canvas->getArena(), canvas->getDotsPool());
+}
+
+/** every event in [first, last) was shown by a frame done at clock */
+static void shown(struct result& r, const std::vector< struct event >& events, size_t first,
+		size_t last, double clock) {
+	for(size_t i = first; i < last; i++) {
+		const double waited = clock - events[i].time;
+		r.latency += waited;
+		r.worst = waited > r.worst ? waited : r.worst;
+	}
+	r.frames++;
+	r.span = clock;
+}
+
+/** each event goes to the tool as it arrives, and a redraw follows as soon as one can */
+static void dragImmediate(const std::vector< struct event >& events, struct result& r) {
+	Canvas canvas;
+	populate(&canvas);
+	canvas.drawScene();
+	Listener listener(&canvas);
+	Tool* tool = makeTool(&canvas);
+	tool->addToolListener(&listener);
+
+	double clock = 0.0;
+	size_t next = 0;
+	while(next < events.size()) {
+		clock = MAX(clock, events[next].time);
+
+		const double start = now();
+		size_t last = next;
+		for(; last < events.size() && events[last].time <= clock; last++) {
+			const struct event& e = events[last];
+			switch(e.kind) {
+				case InputQueue::DOWN: tool->mouseDown(e.p); break;
+				case InputQueue::MOVE: tool->mouseMove(e.p); break;
+				case InputQueue::UP:   tool->mouseUp(e.p);   break;
+			}
+		}
+		canvas.drawScene();
+		const double cost = now() - start;
+
+		r.busy += cost;
+		clock += cost;
+		shown(r, events, next, last, clock);
+		next = last;
+	}
+
+	r.updates = listener.updates;
+	r.paintables = canvas.getPaintableCount();
+	delete tool;
+}
+
+/** events queue up, and once a frame the tool gets them all and the canvas is redrawn */
+static void dragQueued(const std::vector< struct event >& events, struct result& r) {
+	Canvas canvas;
+	populate(&canvas);
+	canvas.drawScene();
+	Listener listener(&canvas);
+	Tool* tool = makeTool(&canvas);
+	tool->addToolListener(&listener);
+	InputQueue input;
+
+	const double frame = 1.0 / options.display;
+	double clock = 0.0;
+	size_t next = 0;
+	while(next < events.size()) {
+		// the next refresh, once the last frame is done and something has arrived
+		clock = ceil(MAX(clock, events[next].time) / frame) * frame;
+
+		size_t last = next;
+		for(; last < events.size() && events[last].time <= clock; last++) {
+			input.push(events[last].kind, events[last].p, events[last].time);
+		}
+
+		const double start = now();
+		input.dispatch(tool);
+		canvas.drawScene();
+		const double cost = now() - start;
+
+		r.busy += cost;
+		clock += cost;
+		shown(r, events, next, last, clock);
+		next = last;
+	}
+
+	r.updates = listener.updates;
+	r.paintables = canvas.getPaintableCount();
+	delete tool;
+}
+
+static void report(const struct result& r, int events, bool last) {
+	printf("    \"%s\": {\n", r.name);
+	printf("      \"tool_updates\": %d,\n", r.updates);
+	printf("      \"redraws\": %d,\n", r.frames);
+	printf("      \"redraws_per_s\": %.1f,\n", r.span > 0.0 ? r.frames / r.span : 0.0);
+	printf("      \"busy_ms\": %.2f,\n", r.busy * 1e3);
+	printf("      \"latency_ms\": %.2f,\n", events ? r.latency * 1e3 / events : 0.0);
+	printf("      \"worst_latency_ms\": %.2f\n", r.worst * 1e3);
+	printf("    }%s\n", last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+	glutInit(&argc, argv);
+	parseArgs(argc, argv);
+
+	glutInitWindowSize(WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+	glutCreateWindow(WINDOW_TITLE_BASE);
+	glViewport(0, 0, WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+	Tool::setPixelSize(MAX(WORLD_X1 / WINDOW_INIT_WIDTH, WORLD_Y1 / WINDOW_INIT_HEIGHT));
+
+	std::vector< struct event > events;
+	makeEvents(events);
+
+	struct result immediate = { "immediate", 0, 0, 0.0, 0.0, 0.0, 0.0, 0 };
+	struct result queued = { "queued", 0, 0, 0.0, 0.0, 0.0, 0.0, 0 };
+	dragImmediate(events, immediate);
+	dragQueued(events, queued);
+
+	printf("{\n");
+	printf("  \"paintables\": %d,\n", options.count);
+	printf("  \"events\": %d,\n", (int) events.size());
+	printf("  \"rate_hz\": %.0f,\n", options.rate);
+	printf("  \"display_hz\": %.0f,\n", options.display);
+	printf("  \"tool\": \"%s\",\n", options.tool);
+	printf("  \"modes\": {\n");
+	report(immediate, (int) events.size(), false);
+	report(queued, (int) events.size(), true);
+	printf("  }\n");
+	printf("}\n");
+
+	return immediate.paintables == queued.paintables ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/*
+ * paint_pool: fill a canvas with dots, lines and rectangles allocated one by one from the heap,
+ * as tools used to, or from the canvas' pools, then drop them all for good, and report as JSON
+ * how many allocations that took and how long filling and dropping took
+ *
+ * usage: paint_pool [-count n] [-seed n]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <glut.h>
+
+#include "Canvas.h"
+#include "Dots.h"
+#include "Line.h"
+#include "Paint.h"
+#include "Rectangle.h"
+
+/* benchmark parameters */
+struct options {
+	int count;
+	unsigned int seed;
+} options = { 1000000, 1 };
+
+/** what filling and dropping a canvas took one way */
+struct result {
+	const char* name;
+	int allocations;
+	double fill, drop;
+	bool empty;
+};
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void parseArgs(int argc, char** argv) {
+	for(int i = 1; i < argc; i++) {
+		if(i + 1 >= argc) {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		} else if(strcmp(argv[i], "-count") == 0) {
+			options.count = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-seed") == 0) {
+			options.seed = (unsigned int) strtoul(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		}
+	}
+}
+
+static struct point2f randomPoint() {
+	struct point2f p = {
+		WORLD_X1 * rand() / (float) RAND_MAX, WORLD_Y1 * rand() / (float) RAND_MAX
+	};
+	return p;
+}
+
+/**
+ * the same paintables every time, from the canvas' pools if pooled, else from the heap
+ *
+ * @return the allocations the paintables took
+ */
+static int fill(Canvas* canvas, bool pooled) {
+	Pool* dotsPool = pooled ? canvas->getDotsPool() : NULL;
+	Pool* linePool = pooled ? canvas->getLinePool() : NULL;
+	Pool* rectanglePool = pooled ? canvas->getRectanglePool() : NULL;
+
+	srand(options.seed);
+	for(int i = 0; i < options.count; i++) {
+		Paintable* p;
+		switch(rand() % 3) {
+			case 0: {
+				Dots* dots = new (dotsPool) Dots(canvas->getArena());
+				const struct point2f at = randomPoint();
+				dots->addPoint(at.x, at.y);
+				p = dots;
+				break;
+			}
+			case 1: {
+				Line* line = new (linePool) Line();
+				line->setStart(randomPoint());
+				line->setEnd(randomPoint());
+				p = line;
+				break;
+			}
+			default: {
+				Rectangle* rect = new (rectanglePool) Rectangle(rand() % 2 == 0);
+				rect->setStart(randomPoint());
+				rect->setEnd(randomPoint());
+				p = rect;
+				break;
+			}
+		}
+		struct color4f c = { 1.0f, 1.0f, 1.0f, 1.0f };
+		p->setColor(c);
+		canvas->addPaintable(p);
+	}
+
+	if(!pooled) return options.count;
+	return dotsPool->getSlabs() + linePool->getSlabs() + rectanglePool->getSlabs();
+}
+
+static void run(bool pooled, struct result& r) {
+	Canvas canvas;
+
+	double start = now();
+	r.allocations = fill(&canvas, pooled);
+	r.fill = now() - start;
+
+	start = now();
+	canvas.reset();
+	r.drop = now() - start;
+
+	r.empty = canvas.getPaintableCount() == 0 && canvas.getDotsPool()->getLive() == 0 &&
+		canvas.getLinePool()->getLive() == 0 && canvas.getRectanglePool()->getLive() == 0;
+}
+
+static void report(const struct result& r, bool last) {
+	printf("    \"%s\": {\n", r.name);
+	printf("      \"allocations\": %d,\n", r.allocations);
+	printf("      \"fill_ms\": %.2f,\n", r.fill * 1e3);
+	printf("      \"drop_ms\": %.2f,\n", r.drop * 1e3);
+	printf("      \"empty\": %s\n", r.empty ? "true" : "false");
+	printf("    }%s\n", last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+	glutInit(&argc, argv);
+	parseArgs(argc, argv);
+
+	glutInitWindowSize(WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+	glutCreateWindow(WINDOW_TITLE_BASE);
+	glViewport(0, 0, WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+
+	struct result heap = { "heap", 0, 0.0, 0.0, false };
+	struct result pool = { "pool", 0, 0.0, 0.0, false };
+	run(false, heap);
+	run(true, pool);
+
+	printf("{\n");
+	printf("  \"paintables\": %d,\n", options.count);
+	printf("  \"modes\": {\n");
+	report(heap, false);
+	report(pool, true);
+	printf("  }\n");
+	printf("}\n");
+
+	return heap.empty && pool.empty ? 0 : 1;
+}
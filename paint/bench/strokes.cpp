@@ -0,0 +1,290 @@
+/*
+ * paint_strokes: replay scribbled strokes through DotTool and report as JSON how many dots and
+ * redisplays each way of keeping them costs, and how many pixels come out different from
+ * keeping every motion event as paint used to
+ *
+ * usage: paint_strokes [-strokes file] [-count n] [-seed n] [-size n] [-out prefix]
+ *
+ * a strokes file holds one motion event per line, "x y" in window pixels, with a blank line
+ * between strokes.  without one, strokes are synthesized: wandering curves traced at speeds
+ * from slow to flicked and reported at 1000 Hz, in whole pixels, as a mouse reports them.
+ * -out writes what each way draws to <prefix><way>.ppm.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include <glut.h>
+
+#include "Canvas.h"
+#include "Compositor.h"
+#include "DotTool.h"
+#include "Paint.h"
+
+/* mouse reports per second */
+#define POLL_RATE 1000
+
+/* benchmark parameters */
+struct options {
+	const char* strokes;
+	int count;
+	unsigned int seed;
+	float size;
+	const char* out;
+} options = { NULL, 200, 1, 4.0f, NULL };
+
+typedef std::vector< struct point2f > stroke_t;
+
+/** counts redisplays and collects the finished paintables */
+class Collector : public ToolListener {
+	public:
+		Collector() : redisplays(0) {}
+		void intermediatePaintableCreated(Paintable* p) { redisplays++; }
+		void finalPaintableCreated(Paintable* p) { redisplays++; paintables.push_back(p); }
+
+		long redisplays;
+		std::vector< Paintable* > paintables;
+};
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void parseArgs(int argc, char** argv) {
+	for(int i = 1; i < argc; i++) {
+		if(i + 1 >= argc) {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		} else if(strcmp(argv[i], "-strokes") == 0) {
+			options.strokes = argv[++i];
+		} else if(strcmp(argv[i], "-count") == 0) {
+			options.count = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-seed") == 0) {
+			options.seed = (unsigned int) strtoul(argv[++i], NULL, 10);
+		} else if(strcmp(argv[i], "-size") == 0) {
+			options.size = (float) atof(argv[++i]);
+		} else if(strcmp(argv[i], "-out") == 0) {
+			options.out = argv[++i];
+		} else {
+			fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+		}
+	}
+}
+
+static bool loadStrokes(const char* path, std::vector< stroke_t >& strokes) {
+	FILE* fp = fopen(path, "r");
+	if(fp == NULL) return false;
+
+	char line[128];
+	stroke_t stroke;
+	while(fgets(line, sizeof(line), fp)) {
+		struct point2f p;
+		if(sscanf(line, "%f %f", &p.x, &p.y) == 2) {
+			stroke.push_back(p);
+		} else if(!stroke.empty()) {
+			strokes.push_back(stroke);
+			stroke.clear();
+		}
+	}
+	if(!stroke.empty()) strokes.push_back(stroke);
+	fclose(fp);
+	return true;
+}
+
+static float uniform() {
+	return rand() / (float) RAND_MAX;
+}
+
+/**
+ * a curve wandering at one speed, polled at POLL_RATE.  like a real mouse, only polls that
+ * land on a new pixel report anything
+ */
+static void synthesize(int count, std::vector< stroke_t >& strokes) {
+	static const float speeds[] = { 60.0f, 250.0f, 1000.0f, 3000.0f };
+	srand(options.seed);
+	for(int i = 0; i < count; i++) {
+		const float speed = speeds[i % 4] * (0.75f + 0.5f * uniform()) / POLL_RATE;
+		const int polls = (int) (POLL_RATE * (0.5f + 1.5f * uniform()));
+		float x = WINDOW_INIT_WIDTH * (0.2f + 0.6f * uniform());
+		float y = WINDOW_INIT_HEIGHT * (0.2f + 0.6f * uniform());
+		float heading = 6.2831853f * uniform(), turn = 0.0f;
+
+		stroke_t stroke;
+		struct point2f last = { floorf(x), floorf(y) };
+		stroke.push_back(last);
+		for(int k = 0; k < polls; k++) {
+			turn = 0.98f * turn + 0.004f * (uniform() - 0.5f);
+			heading += turn;
+			x += speed * cosf(heading);
+			y += speed * sinf(heading);
+			x = x < 0.0f ? 0.0f : x >= WINDOW_INIT_WIDTH ? WINDOW_INIT_WIDTH - 1.0f : x;
+			y = y < 0.0f ? 0.0f : y >= WINDOW_INIT_HEIGHT ? WINDOW_INIT_HEIGHT - 1.0f : y;
+
+			struct point2f p = { floorf(x), floorf(y) };
+			if(p.x != last.x || p.y != last.y) {
+				stroke.push_back(p);
+				last = p;
+			}
+		}
+		strokes.push_back(stroke);
+	}
+}
+
+/** window pixels to world, as Paint does */
+static struct point2f toWorld(struct point2f p) {
+	struct point2f w = {
+		WORLD_X1 * p.x / (float) WINDOW_INIT_WIDTH,
+		WORLD_Y1 * (WINDOW_INIT_HEIGHT - p.y) / (float) WINDOW_INIT_HEIGHT
+	};
+	return w;
+}
+
+/** the dots, redisplays and cost of one way of keeping the strokes */
+struct result {
+	const char* name;
+	long dots, redisplays, blended;
+	double seconds;
+	int changed;
+};
+
+static void report(const struct result& r, long events, bool last) {
+	printf("    \"%s\": {\n", r.name);
+	printf("      \"dots\": %ld,\n", r.dots);
+	printf("      \"dots_per_event\": %.4f,\n", events ? r.dots / (double) events : 0.0);
+	printf("      \"redisplays\": %ld,\n", r.redisplays);
+	printf("      \"pixels_blended\": %ld,\n", r.blended);
+	printf("      \"ns_per_event\": %.1f,\n", events ? r.seconds * 1e9 / events : 0.0);
+	printf("      \"pixels_changed\": %d\n", r.changed);
+	printf("    }%s\n", last ? "" : ",");
+}
+
+/**
+ * replay the strokes, through DotTool unless raw, compose what was kept and compare it with
+ * the reference image, if there is one yet
+ */
+static struct result replay(const char* name, const std::vector< stroke_t >& strokes, bool raw,
+		Compositor* compositor, std::vector< unsigned char >& reference) {
+	Arena arena;
+	Pool pool(sizeof(Dots) + PAINTABLE_HEADER);
+	Collector collector;
+	DotTool tool(false, &arena, &pool);
+	tool.addToolListener(&collector);
+
+	struct result r = { name, 0, 0, 0, 0.0, 0 };
+	const double start = now();
+	for(size_t i = 0; i < strokes.size(); i++) {
+		const stroke_t& s = strokes[i];
+		if(raw) {
+			/* every event becomes a dot and a redisplay */
+			Dots* dots = new Dots(&arena);
+			dots->setColor(Tool::getColor());
+			dots->setPointSize(Tool::getPointSize());
+			for(size_t k = 0; k < s.size(); k++) {
+				struct point2f p = toWorld(s[k]);
+				dots->addPoint(p.x, p.y);
+				collector.intermediatePaintableCreated(dots);
+			}
+			collector.finalPaintableCreated(dots);
+		} else {
+			tool.mouseDown(toWorld(s[0]));
+			for(size_t k = 1; k < s.size(); k++) {
+				tool.mouseMove(toWorld(s[k]));
+			}
+			tool.mouseUp(toWorld(s[s.size() - 1]));
+		}
+	}
+	r.seconds = now() - start;
+	r.redisplays = collector.redisplays;
+
+	for(size_t i = 0; i < collector.paintables.size(); i++) {
+		r.dots += ((Dots*) collector.paintables[i])->getCount();
+	}
+
+	struct color4f background = { 0.0f, 0.0f, 0.0f, 0.0f };
+	compositor->compose(collector.paintables, NULL, background);
+	if(options.out != NULL) {
+		char path[1024];
+		snprintf(path, sizeof(path), "%s%s.ppm", options.out, name);
+		if(!compositor->writePPM(path)) fprintf(stderr, "Unable to write %s\n", path);
+	}
+
+	Raster raster;
+	raster.reset();
+	for(size_t i = 0; i < collector.paintables.size(); i++) {
+		collector.paintables[i]->rasterize(&raster);
+	}
+	const std::vector< struct fill >& fills = raster.getFills();
+	for(size_t i = 0; i < fills.size(); i++) {
+		r.blended += (long) (fills[i].x1 - fills[i].x0) * (fills[i].y1 - fills[i].y0);
+	}
+
+	const unsigned char* pixels = compositor->getPixels();
+	const int n = compositor->getWidth() * compositor->getHeight();
+	if(reference.empty()) {
+		reference.assign(pixels, pixels + n * 4);
+	}
+	for(int i = 0; i < n; i++) {
+		if(memcmp(&pixels[i * 4], &reference[i * 4], 4) != 0) r.changed++;
+	}
+
+	for(size_t i = 0; i < collector.paintables.size(); i++) {
+		delete collector.paintables[i];
+	}
+	return r;
+}
+
+int main(int argc, char** argv) {
+	glutInit(&argc, argv);
+	parseArgs(argc, argv);
+
+	std::vector< stroke_t > strokes;
+	if(options.strokes != NULL) {
+		if(!loadStrokes(options.strokes, strokes)) {
+			fprintf(stderr, "Unable to read %s\n", options.strokes);
+			return 1;
+		}
+	} else {
+		synthesize(options.count, strokes);
+	}
+
+	long events = 0;
+	for(size_t i = 0; i < strokes.size(); i++) {
+		events += strokes[i].size();
+	}
+
+	/* the canvas sets up the world the paintables are drawn in */
+	glutInitWindowSize(WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+	glutCreateWindow(WINDOW_TITLE_BASE);
+	Canvas canvas;
+	glViewport(0, 0, WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+
+	Tool::setPointSize(options.size);
+	Tool::setPixelSize(MAX(WORLD_X1 / WINDOW_INIT_WIDTH, WORLD_Y1 / WINDOW_INIT_HEIGHT));
+
+	Compositor compositor(1);
+	std::vector< unsigned char > reference;
+	const struct result raw = replay("every_event", strokes, true, &compositor, reference);
+	Tool::setSmoothing(false);
+	const struct result filtered = replay("filtered", strokes, false, &compositor, reference);
+	Tool::setSmoothing(true);
+	const struct result smoothed = replay("smoothed", strokes, false, &compositor, reference);
+
+	printf("{\n");
+	printf("  \"strokes\": %d,\n", (int) strokes.size());
+	printf("  \"events\": %ld,\n", events);
+	printf("  \"point_size\": %.1f,\n", options.size);
+	printf("  \"pixels\": %d,\n", compositor.getWidth() * compositor.getHeight());
+	printf("  \"modes\": {\n");
+	report(raw, events, false);
+	report(filtered, events, false);
+	report(smoothed, events, true);
+	printf("  }\n");
+	printf("}\n");
+
+	return 0;
+}
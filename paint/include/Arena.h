@@ -0,0 +1,42 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+
+/* smallest block the arena asks the heap for */
+#define ARENA_BLOCK_SIZE (256 * 1024)
+
+/**
+ * A bump allocator carving memory out of large blocks.  Nothing is freed on its own, instead
+ * reset() drops everything allocated so far at once.
+ */
+class Arena {
+	public:
+		Arena();
+		~Arena();
+
+		/**
+		 * Allocate memory aligned for any type, valid until the next reset.
+		 *
+		 * @return the memory, or NULL if the heap is exhausted
+		 */
+		void* allocate(size_t size);
+
+		/** release everything allocated, keeping one block around for reuse */
+		void reset();
+
+		/** bytes handed out since the last reset */
+		size_t getUsed() { return used; }
+
+	private:
+		struct block {
+			struct block* next;
+			size_t size, top;
+		};
+
+		/** the block being carved, which links to the earlier ones */
+		struct block* current;
+		size_t used;
+};
+
+#endif /*ARENA_H_*/
@@ -3,7 +3,13 @@
 
 #include <vector>
 
+#include "Arena.h"
+#include "Compositor.h"
+#include "Document.h"
+#include "Grid.h"
+#include "History.h"
 #include "Paintable.h"
+#include "Pool.h"
 
 #define WORLD_X0 0.0f
 #define WORLD_X1 1280.0f
@@ -19,7 +25,8 @@ class Canvas {
 		~Canvas();
 
 		/**
-		 * Add a paintable object to the canvas.
+		 * Add a paintable object to the canvas, which owns it from then on.  This is the one
+		 * way paintables are committed, and can be undone.
 		 */
 		void addPaintable(Paintable* p);
 
@@ -30,10 +37,43 @@ class Canvas {
 		void setActivePaintable(Paintable* p);
 
 		/**
-		 * Remove all paintables from the canvas.
+		 * Remove all paintables from the canvas.  This can be undone.
 		 */
 		void clear();
 
+		/**
+		 * Remove all paintables from the canvas for good, and forget what can be undone.
+		 */
+		void reset();
+
+		/**
+		 * Take back the last paintable added or clear, or do again the last one taken back.
+		 * Paintables that have faded away stay away.
+		 *
+		 * @return true if there was something to undo or redo, false otherwise
+		 */
+		bool undo();
+		bool redo();
+
+		/** number of paintables on the canvas, besides the active one */
+		int getPaintableCount() { return (int) paintables.size(); }
+
+		/**
+		 * Get the arena paintables on this canvas keep their geometry in.  It is reset, and
+		 * documents loaded are unmapped, whenever neither the canvas nor its history holds a
+		 * paintable.
+		 */
+		Arena* getArena() { return &arena; }
+
+		/**
+		 * Get the pools paintables for this canvas are taken from, one per type, as in
+		 * new (canvas->getDotsPool()) Dots(canvas->getArena()).  They are reset along with the
+		 * arena, dropping every paintable at once.
+		 */
+		Pool* getDotsPool() { return &dotsPool; }
+		Pool* getLinePool() { return &linePool; }
+		Pool* getRectanglePool() { return &rectanglePool; }
+
 		/**
 		 * Control fade-out of paintables.  All paintables will have their alpha channel
 		 * dropped from 1.0 to 0.0, at which time they will be removed from the canvas.
@@ -49,11 +89,81 @@ class Canvas {
 		 */
 		bool isFading() { return this->fading; }
 
+		/**
+		 * Control composition on the CPU.  When on, the scene is blended offscreen by a
+		 * Compositor and drawn as one image, which looks exactly as drawing it with GL does.
+		 *
+		 * @param on if true, compose on the CPU, otherwise draw with GL
+		 */
+		void enableComposition(bool on) { this->composing = on; whole = true; }
+
+		/**
+		 * Determine if the canvas is composing on the CPU currently.
+		 *
+		 * @return true if composing, false otherwise
+		 */
+		bool isComposing() { return this->composing; }
+
+		/**
+		 * Control the raster layer.  When on, committed paintables are flattened into an image
+		 * as they are added, and every draw is that image plus the active paintable.  The
+		 * layer is not used while fading, when committed paintables change on every tick.
+		 *
+		 * @param on if true, draw committed paintables from the layer, otherwise one by one
+		 */
+		void enableLayer(bool on) { this->layering = on; }
+
+		/**
+		 * Determine if the canvas draws committed paintables from the raster layer.
+		 *
+		 * @return true if layering, false otherwise
+		 */
+		bool isLayering() { return this->layering; }
+
+		/**
+		 * Compose the canvas offscreen at the size of the viewport and write it out.
+		 *
+		 * @param path where to write a binary PPM
+		 * @return true if the file was written, false otherwise
+		 */
+		bool exportPPM(const char* path);
+
+		/**
+		 * Save the paintables on the canvas as a Document.
+		 *
+		 * @return true if the file was written, false otherwise
+		 */
+		bool save(const char* path);
+
+		/**
+		 * Replace the paintables on the canvas with those of a Document, which is mapped
+		 * rather than read.  Undoing it takes back one paintable at a time, then the clear.
+		 *
+		 * @return true if the document was opened, false otherwise
+		 */
+		bool load(const char* path);
+
 		/**
 		 * Advance animations one tick.
 		 */
 		void tick();
 
+		/**
+		 * Remove the paintables that have faded away, and give the rest their faded alpha.
+		 * drawScene does this itself.
+		 */
+		void prune();
+
+		/** name of the fade kernel in use, "avx2" or "scalar" */
+		const char* getFadeKernelName();
+
+		/**
+		 * Repaint the whole canvas on the next draw.  Otherwise, while only the active paintable
+		 * changes or paintables are added, just the part of the canvas they cover is repainted.
+		 * Needed whenever something besides the canvas spoils the picture, as a resize does.
+		 */
+		void invalidate() { whole = true; }
+
 		/**
 		 * Draw the canvas with its paintables.
 		 */
@@ -62,13 +172,98 @@ class Canvas {
 	private:
 
 		/**
-		 * Remove all paintables from the canvas.
+		 * World units a pixel of the viewport spans, the larger of across and up.
+		 */
+		GLfloat getPixelSize();
+
+		/**
+		 * Limit drawing to the pixels of the viewport box covers.
+		 */
+		void scissorTo(struct rect2f box);
+
+		/**
+		 * Index every paintable by its bounds when a pixel spans pixelSize world units.
+		 */
+		void reindex(GLfloat pixelSize);
+
+		/**
+		 * Bring the raster layer up to date with the paintables, adding those committed since
+		 * the last update or starting over if it was dropped.
+		 */
+		void updateLayer();
+
+		/**
+		 * Put a paintable from the history on the canvas, in front of the others.
+		 */
+		void show(Paintable* p, int id);
+
+		/**
+		 * Take every paintable off the canvas, leaving them to the history.
+		 */
+		void hideAll();
+
+		/**
+		 * Unmap every document loaded, once no paintable uses them.
 		 */
-		void clearPaintables();
+		void closeDocuments();
+
+		/**
+		 * Free every paintable the history holds.  When they are all there is in the pools,
+		 * the pools, the arena and the documents are dropped whole instead of one by one.
+		 */
+		void release();
+
+		/** everything committed, including what is shown */
+		History history;
 
 		std::vector< Paintable* > paintables;
 		Paintable* activePaintable;
 		bool fading;
+
+		/**
+		 * per paintable, its alpha while fading, kept side by side to fade them all in one
+		 * sweep.  paintables see it when pruned, which is due if faded
+		 */
+		std::vector< GLfloat > alphas;
+
+		/** per paintable, its id in the history */
+		std::vector< int > ids;
+		bool faded;
+		int fadeKernel;
+
+		Arena arena;
+
+		/** documents paintables were loaded from, which hold their geometry */
+		std::vector< Document* > documents;
+
+		Pool dotsPool, linePool, rectanglePool;
+
+		struct color4f background;
+		Compositor* compositor;
+		bool composing;
+
+		/** the compositor's image holds paintables [0, layered), if layered >= 0 */
+		bool layering;
+		int layered;
+
+		/** the paintables by their bounds, when indexed, as they were at indexSize */
+		Grid grid;
+		bool indexed;
+		GLfloat indexSize;
+
+		/** if the next draw repaints everything, else what changed besides the active paintable */
+		bool whole;
+		struct rect2f dirty;
+
+		/** the active paintable's bounds as last drawn */
+		struct rect2f activeBounds;
+
+		/** if the last draw knew what changed, and what that was, which the next buffer lacks */
+		bool lastKnown;
+		struct rect2f lastDamage;
+
+		/** scratch for the paintables in the damage */
+		std::vector< Paintable* > damaged;
 };
 
 #endif /*CANVAS_H_*/
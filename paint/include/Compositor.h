@@ -0,0 +1,117 @@
+#ifndef COMPOSITOR_H_
+#define COMPOSITOR_H_
+
+#include <vector>
+
+#include <pthread.h>
+
+#include <glut.h>
+
+#include "structs.h"
+
+#include "Paintable.h"
+#include "Raster.h"
+
+/* side of the square tiles the viewport is split into, in pixels */
+#define TILE_SIZE 64
+
+/**
+ * Draws paintables on the CPU.  Every paintable is rasterized into fills, the fills are binned
+ * into screen tiles, and worker threads blend whole tiles at a time with
+ * GL_SRC_ALPHA/GL_ONE_MINUS_SRC_ALPHA.  The result matches GL's pixel for pixel, so it serves
+ * as a reference for the GL path, an offscreen exporter, and a faster path for deep stacks of
+ * large blended rectangles.
+ */
+class Compositor {
+	public:
+		/** @param threads workers blending tiles, 0 for one per processor */
+		Compositor(int threads);
+		~Compositor();
+
+		/**
+		 * Compose paintables, in order, over a background into the pixels of the current
+		 * viewport, taking the transform from the current GL state.
+		 */
+		void compose(const std::vector< Paintable* >& paintables, Paintable* active,
+			struct color4f background);
+
+		/**
+		 * Blend paintables[first] onwards, in order, over the last composition.  Fails if the
+		 * viewport has changed size since, in which case the composition has to start over.
+		 *
+		 * @return true if the paintables were added, false otherwise
+		 */
+		bool add(const std::vector< Paintable* >& paintables, size_t first);
+
+		/** the last composition, RGBA bytes, bottom row first like glReadPixels */
+		const unsigned char* getPixels() { return pixels; }
+		int getWidth() { return width; }
+		int getHeight() { return height; }
+
+		/**
+		 * Draw the last composition, replacing what is there, over the world rectangle
+		 * (x0, y0)-(x1, y1), which should be the one the viewport shows.  Only the rows
+		 * changed since the last blit are uploaded again.
+		 */
+		void blit(GLfloat x0, GLfloat y0, GLfloat x1, GLfloat y1);
+
+		/** write the last composition as a binary PPM.  returns false on failure */
+		bool writePPM(const char* path);
+
+		int getThreads() { return numThreads; }
+
+		/** name of the blend kernel in use, "avx2" or "scalar" */
+		const char* getKernelName();
+
+	private:
+
+		/** blend what has been rasterized, over the background if clearing */
+		void blendFills(bool clearing);
+
+		/** run the workers over every tile and wait for them */
+		void run();
+
+		/** take tiles until there are none left */
+		void work();
+
+		void composeTile(int tile);
+
+		static void* workerThread(void* arg);
+
+		Raster raster;
+
+		unsigned char* pixels;
+		int width, height;
+		unsigned char background[4];
+
+		/** if tiles start from the background, or from what they hold */
+		bool clearing;
+
+		/** per tile, the fills touching it in drawing order */
+		int tilesX, tilesY;
+		std::vector< std::vector< int > > bins;
+
+		/** index of the blend kernel */
+		int kernel;
+
+		/** per raster color, the source term and 1 - alpha of the blend */
+		std::vector< struct color4f > sources;
+		std::vector< GLfloat > oneMinusAlphas;
+
+		/* worker threads, the caller being worker 0 */
+		int numThreads;
+		std::vector< pthread_t > threads;
+		pthread_mutex_t lock;
+		pthread_cond_t start, done;
+		int generation, busy;
+		bool quit;
+		volatile int nextTile;
+
+		GLuint texture;
+		int textureWidth, textureHeight;
+
+		/** rows [staleY0, staleY1) of the texture are behind the pixels */
+		int staleY0, staleY1;
+};
+
+#endif /*COMPOSITOR_H_*/
@@ -0,0 +1,113 @@
+#ifndef DOCUMENT_H_
+#define DOCUMENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "structs.h"
+
+#include "Arena.h"
+#include "Paintable.h"
+
+/* first bytes of every document, and the layout it was written with */
+#define DOCUMENT_MAGIC "PNTD"
+#define DOCUMENT_VERSION 1
+
+/**
+ * A saved canvas, laid out to be mapped into memory and used in place: a header, a table with a
+ * fixed size record per paintable, then the points of every Dots one after the other.  Numbers
+ * are in the byte order of the machine that wrote them.
+ *
+ * Opening a document reads nothing but the header and the table.  Dots decoded from it keep
+ * pointing into the mapping, so their points are only read from disk once they are drawn, and
+ * the bounds the canvas indexes them by come from the table.  The mapping is copy on write, a
+ * decoded paintable can be changed without changing the file.
+ */
+class Document {
+	public:
+		/** kinds of paintable a record holds */
+		enum kind { DOTS, LINE, RECTANGLE, RECTANGLE_FILLED };
+
+		struct header {
+			char magic[4];
+			uint32_t version;
+			uint32_t count;
+			uint32_t reserved;
+
+			/** where the table and the points start, in bytes, and how many points there are */
+			uint64_t table, points, pointCount;
+		};
+
+		struct record {
+			uint32_t kind;
+
+			/** for Dots, its points: pointCount of them from the point at index first */
+			uint32_t pointCount;
+			uint64_t first;
+
+			struct color4f color;
+			GLfloat size, width;
+
+			/** for the other kinds, the corners or ends */
+			struct point2f start, end;
+
+			/** box around the geometry, before any point size or line width */
+			struct rect2f box;
+		};
+
+		/**
+		 * Map a document into memory.
+		 *
+		 * @return the document, or NULL if it could not be read or is not a document this
+		 *         version understands
+		 */
+		static Document* open(const char* path);
+
+		/** unmaps the document, which no paintable decoded from it may outlive */
+		~Document();
+
+		/** number of paintables in the document */
+		int getCount() { return (int) header->count; }
+
+		/**
+		 * Make the paintable at index i, from the pool for its type.  Dots view their points
+		 * in place, and take memory from arena only if they grow.
+		 */
+		Paintable* decode(int i, Arena* arena, Pool* dotsPool, Pool* linePool,
+			Pool* rectanglePool);
+
+	private:
+		Document(void* base, size_t size);
+
+		void* base;
+		size_t size;
+
+		const struct header* header;
+		const struct record* table;
+		struct point2f* points;
+};
+
+/**
+ * Lays paintables out as a Document and writes it.  Paintables add themselves through
+ * Paintable::write.
+ */
+class DocumentWriter {
+	public:
+		void addDots(Paintable* p, const struct point2f* points, int count, struct rect2f box);
+		void addShape(Paintable* p, enum Document::kind kind, struct point2f start,
+			struct point2f end);
+
+		/** @return true if the whole document was written, false otherwise */
+		bool write(const char* path);
+
+	private:
+		/** a record with the paintable's color, size and width filled in */
+		struct Document::record describe(Paintable* p, enum Document::kind kind);
+
+		std::vector< struct Document::record > table;
+		std::vector< struct point2f > points;
+};
+
+#endif /*DOCUMENT_H_*/
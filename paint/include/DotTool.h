@@ -3,24 +3,40 @@
 
 #include "structs.h"
 
+#include "Arena.h"
 #include "Dots.h"
+#include "Stroke.h"
 #include "Tool.h"
 
+/* scribble samples closer than this fraction of the point size to the last one are dropped */
+#define SCRIBBLE_SPACING 0.5f
+
+/* how far, in pixels, simplifying may move a smoothed scribble */
+#define SCRIBBLE_TOLERANCE 0.5f
+
+/* longest stretch, in dot spacings, a smoothed scribble's spline goes without a sample */
+#define SCRIBBLE_SEGMENT 4.0f
+
 /**
- * A tool to create one or many dots in a single paintable.
+ * A tool to create one or many dots in a single paintable, taken from a pool and keeping its
+ * dots in an arena.
  */
 class DotTool : public Tool {
 	public:
-		DotTool(bool single);
+		DotTool(bool single, Arena* arena, Pool* pool);
 		virtual ~DotTool() {}
 
 		void mouseDown(struct point2f p);
 		void mouseMove(struct point2f p);
+		void mouseDrag(const struct point2f* points, int n);
 		void mouseUp(struct point2f p);
 
 	private:
 		Dots* dots;
 		bool single;
+		Arena* arena;
+		Pool* pool;
+		Stroke stroke;
 };
 
 #endif /*DOTTOOL_H_*/
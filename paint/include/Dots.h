@@ -7,23 +7,54 @@
 
 #include "structs.h"
 
+#include "Arena.h"
 #include "Paintable.h"
 
+/* points a Dots makes room for on its first addPoint */
+#define DOTS_INITIAL 16
+
 /**
- * A collection of dots to be painted.  Can be used for one or many dots together.
+ * A collection of dots to be painted.  Can be used for one or many dots together.  The dots are
+ * kept side by side in memory taken from an arena, which owns it: destroying a Dots frees
+ * nothing, the arena is reset once every Dots using it is gone.
  */
 class Dots : public Paintable {
 	public:
-		Dots() : Paintable() {}
-		~Dots();
+		Dots(Arena* arena);
+
+		/**
+		 * Dots viewing count points it does not own, within box, as a loaded Document
+		 * holds them.  Points added later move them all to the arena.
+		 */
+		Dots(Arena* arena, struct point2f* points, int count, struct rect2f box);
+		~Dots() {}
 
-		/** add a point to the vector of dots */
+		/** add a point to the dots */
 		void addPoint(GLfloat x, GLfloat y);
 
+		/**
+		 * Treat the dots as a stroke: simplify it so it moves by no more than tolerance, keeping
+		 * a point at least every maxLength, then lay the dots out again every spacing along a
+		 * spline through what is left.
+		 */
+		void smooth(GLfloat tolerance, GLfloat maxLength, GLfloat spacing);
+
+		/** the dots, contiguous */
+		const struct point2f* getPoints() { return points; }
+		int getCount() { return count; }
+
 		void paint();
+		void rasterize(Raster* raster);
+		struct rect2f getBounds(GLfloat pixelSize);
+		void write(DocumentWriter* writer);
 
 	private:
-		std::vector< struct point2f* > dots;
+		Arena* arena;
+		struct point2f* points;
+		int count, capacity;
+
+		/** box around the points, grown as they are added */
+		struct rect2f box;
 };
 
 #endif /*DOTS_H_*/
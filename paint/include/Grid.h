@@ -0,0 +1,61 @@
+#ifndef GRID_H_
+#define GRID_H_
+
+#include <vector>
+
+#include "structs.h"
+
+#include "Paintable.h"
+
+/* cells across and up the world a Grid splits it into */
+#define GRID_COLUMNS 32
+#define GRID_ROWS 32
+
+/**
+ * A uniform grid over the world indexing paintables by their bounds, to find the few that can
+ * touch a small part of the canvas without looking at all of them.  Paintables are given back in
+ * the order they were inserted, which is the order they have to be drawn in.
+ */
+class Grid {
+	public:
+		/**
+		 * @param world the box split into cells, bounds reaching past it land in the edge cells
+		 */
+		Grid(struct rect2f world);
+
+		/** add a paintable, in front of every one added before */
+		void insert(Paintable* p, struct rect2f bounds);
+
+		/** forget every paintable */
+		void clear();
+
+		/** number of paintables indexed */
+		int getCount() { return (int) entries.size(); }
+
+		/**
+		 * Find the paintables whose bounds overlap box.
+		 *
+		 * @param out receives them, back to front
+		 */
+		void query(struct rect2f box, std::vector< Paintable* >& out);
+
+	private:
+		struct entry {
+			Paintable* paintable;
+			struct rect2f bounds;
+		};
+
+		/** the range of cells box covers, clamped to the grid */
+		void cellRange(struct rect2f box, int* c0, int* r0, int* c1, int* r1);
+
+		struct rect2f world;
+		std::vector< struct entry > entries;
+
+		/** per cell, the entries overlapping it by insertion order */
+		std::vector< int > cells[GRID_COLUMNS * GRID_ROWS];
+
+		/** scratch for query, kept to save reallocating */
+		std::vector< int > found;
+};
+
+#endif /*GRID_H_*/
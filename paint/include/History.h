@@ -0,0 +1,79 @@
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+#include <vector>
+
+#include "Paintable.h"
+
+/**
+ * What has been done to a canvas, as an append-only log of commands with a cursor that undo and
+ * redo move; everything before the cursor has happened.  A command either creates a paintable or
+ * clears the canvas, so what the canvas shows is always the creations between the last clear and
+ * the cursor.  That makes a clear's snapshot of the canvas just where that run starts: no step
+ * copies the canvas, undoing or redoing a creation is O(1) and undoing a clear puts back its run.
+ *
+ * The history owns the paintables in it.
+ */
+class History {
+	public:
+		struct command {
+			/** true for a clear, false for a creation */
+			bool clear;
+
+			/** the paintable created, NULL once it has faded away */
+			Paintable* paintable;
+
+			/** for a clear, where the run of creations it cleared starts */
+			int first;
+		};
+
+		History();
+		~History();
+
+		/**
+		 * Record the creation of a paintable, discarding whatever had been undone.
+		 *
+		 * @return the paintable's id, which stays the same until the history is reset
+		 */
+		int create(Paintable* p);
+
+		/** record clearing the canvas */
+		void clear();
+
+		/**
+		 * Step back over the last command done, or forward over the next one undone.
+		 *
+		 * @return the command, NULL if there is none
+		 */
+		const struct command* undo();
+		const struct command* redo();
+
+		/** the canvas shows the creations in [getFirst(), getCursor()) */
+		int getFirst() { return first; }
+		int getCursor() { return cursor; }
+		const struct command& get(int id) { return log[id]; }
+
+		/** a paintable has faded away for good: delete it, undo and redo pass it over */
+		void forget(int id);
+
+		/** number of paintables held, shown or not */
+		int getLive() { return live; }
+
+		/** delete every paintable and forget every command */
+		void reset();
+
+		/**
+		 * Forget every command without deleting the paintables, for when whatever they were
+		 * allocated from frees them all at once.
+		 */
+		void drop();
+
+	private:
+		/** delete what was undone, once something new is done it can not be redone */
+		void fork();
+
+		std::vector< struct command > log;
+		int cursor, first, live;
+};
+
+#endif /*HISTORY_H_*/
@@ -0,0 +1,67 @@
+#ifndef INPUTQUEUE_H_
+#define INPUTQUEUE_H_
+
+#include <vector>
+
+#include "structs.h"
+
+#include "Tool.h"
+
+/* events the queue holds before it is full, a power of two */
+#define INPUT_QUEUE_SIZE 4096
+
+/** what one dispatch handed over */
+struct inputBatch {
+	/** events, and calls into the tool they took */
+	int events, updates;
+
+	/** when the first event arrived, and the sum of when all of them did */
+	double first, arrivals;
+};
+
+/**
+ * Mouse input waiting for the next tick, in a ring one producer pushes onto and one consumer
+ * drains without locking.  The input callbacks push, and the tick hands everything queued to
+ * the tool at once, every run of moves as a single drag, so a tool updates its paintable once
+ * per tick however fast the mouse reports.
+ */
+class InputQueue {
+	public:
+		enum kind { DOWN, MOVE, UP };
+
+		InputQueue();
+
+		/**
+		 * Queue an event, from the producer.
+		 *
+		 * @param time when the event arrived, in seconds
+		 * @return true if it was queued, false if the queue is full
+		 */
+		bool push(enum kind kind, struct point2f p, double time);
+
+		/**
+		 * Hand every event queued to a tool, from the consumer.  Ups are dropped unless the
+		 * tool has the mouse down, as clicking the menus sends them.
+		 */
+		struct inputBatch dispatch(Tool* tool);
+
+	private:
+		struct event {
+			enum kind kind;
+			struct point2f p;
+			double time;
+		};
+
+		/** give the tool the moves gathered so far as one drag */
+		void drag(Tool* tool, struct inputBatch& batch);
+
+		struct event events[INPUT_QUEUE_SIZE];
+
+		/** next slot the producer fills, and next the consumer reads; only ever increase */
+		unsigned int head, tail;
+
+		/** scratch for a run of moves */
+		std::vector< struct point2f > moves;
+};
+
+#endif /*INPUTQUEUE_H_*/
@@ -16,8 +16,13 @@ class Line : public Paintable {
 		/** control start/end points */
 		void setStart(struct point2f start) { this->start = start; }
 		void setEnd(struct point2f end) { this->end = end; }
+		struct point2f getStart() { return start; }
+		struct point2f getEnd() { return end; }
 
 		void paint();
+		void rasterize(Raster* raster);
+		struct rect2f getBounds(GLfloat pixelSize);
+		void write(DocumentWriter* writer);
 
 	private:
 		struct point2f start, end;
@@ -7,11 +7,11 @@
 #include "Tool.h"
 
 /**
- * A tool to create a line paintable.
+ * A tool to create a line paintable, taken from a pool.
  */
 class LineTool : public Tool {
 	public:
-		LineTool();
+		LineTool(Pool* pool);
 		virtual ~LineTool() {}
 
 		void mouseDown(struct point2f p);
@@ -20,6 +20,7 @@ class LineTool : public Tool {
 
 	private:
 		Line* line;
+		Pool* pool;
 };
 
 #endif /*LINETOOL_H_*/
@@ -2,11 +2,14 @@
 #define PAINT_H_
 
 #include "Canvas.h"
+#include "InputQueue.h"
 #include "Tool.h"
 
 #define WINDOW_INIT_WIDTH 800
 #define WINDOW_INIT_HEIGHT 600
 #define WINDOW_TITLE_BASE "SuperPaint!"
+#define EXPORT_PATH "paint.ppm"
+#define DOCUMENT_PATH "paint.pnt"
 
 /* Menu Choices */
 enum choice {
@@ -23,7 +26,18 @@ enum choice {
 	TWO_W, FOUR_W, EIGHT_W, SIXTEEN_W,
 
 	/* commands */
-	FADE, CLEAR, QUIT
+	FADE, SMOOTH, COMPOSE, LAYER, EXPORT, SAVE, OPEN, UNDO, REDO, CLEAR, NEW, QUIT
+};
+
+/** input and redraw figures since they were last reported */
+struct inputStats {
+	/** when counting started, in seconds */
+	double since;
+
+	int frames, events, updates;
+
+	/** from an event arriving to the frame showing it, summed over events and at worst */
+	double latency, worst;
 };
 
 /**
@@ -61,8 +75,27 @@ class Paint : public ToolListener {
 		/** get a 2d point from a x, y pair in view coordinates */
 		struct point2f pointFromViewXY(int x, int y);
 
+		/** queue a mouse event for the next tick */
+		void queueInput(enum InputQueue::kind kind, int x, int y);
+
+		/** hand the queued mouse events to the current tool, as every tick does */
+		void dispatchInput();
+
+		/** print the input and redraw figures, and start counting again */
+		void reportInput();
+
 		Canvas* canvas;
 		Tool* currentTool;
+
+		/**
+		 * mouse events since the last tick, those dispatched but not yet drawn, and whether
+		 * the tool changed its paintable during the last dispatch
+		 */
+		InputQueue input;
+		struct inputBatch undrawn;
+		bool changed;
+
+		struct inputStats stats;
 };
 
 #endif /*PAINT_H_*/
@@ -1,10 +1,22 @@
 #ifndef PAINTABLE_H_
 #define PAINTABLE_H_
 
+#include <stdlib.h>
+
+#include <new>
+
 #include <glut.h>
 
 #include "structs.h"
 
+#include "Pool.h"
+#include "Raster.h"
+
+class DocumentWriter;
+
+/* room kept in front of every paintable for the pool it came from, keeping it aligned */
+#define PAINTABLE_HEADER 16
+
 /**
  * A paintable describes something that can be displayed on the screen.  Paintables maintain 
  * their color, size and geometry.
@@ -15,10 +27,46 @@ class Paintable {
 
 		virtual ~Paintable() {}
 
+		/**
+		 * Paintables come from a pool, as new (pool) Dots(arena) does, or from the heap when
+		 * the pool is NULL or too small for them.  A pool holds PAINTABLE_HEADER bytes more
+		 * than the paintables it is for.  Deleting a paintable gives it back to where it came
+		 * from.
+		 */
+		static void* operator new(size_t size, Pool* pool) {
+			void* p = NULL;
+			if(pool != NULL && size + PAINTABLE_HEADER <= pool->getSize()) {
+				p = pool->allocate();
+			}
+			if(p == NULL) {
+				pool = NULL;
+				p = malloc(size + PAINTABLE_HEADER);
+				if(p == NULL) throw std::bad_alloc();
+			}
+			*(Pool**) p = pool;
+			return (char*) p + PAINTABLE_HEADER;
+		}
+
+		static void* operator new(size_t size) { return operator new(size, (Pool*) NULL); }
+
+		static void operator delete(void* p) {
+			if(p == NULL) return;
+			void* block = (char*) p - PAINTABLE_HEADER;
+			Pool* pool = *(Pool**) block;
+			if(pool != NULL) {
+				pool->release(block);
+			} else {
+				free(block);
+			}
+		}
+
+		static void operator delete(void* p, Pool* pool) { operator delete(p); }
+
 		/** set/get current paint color */
 		inline struct color4f getColor() { return color; }
 		inline void setColor(GLfloat r, GLfloat g, GLfloat b) { color.r = r; color.g = g; color.b = b; }
 		inline void setColor(struct color4f color) { this->color = color; }
+		inline void setAlpha(GLfloat alpha) { color.a = alpha; }
 
 		/** set/get current point size */
 		inline GLfloat getPointSize() { return size; }
@@ -35,6 +83,18 @@ class Paintable {
 		/** implemented by paintables to draw themselves */
 		virtual void paint() = 0;
 
+		/** implemented by paintables to draw themselves into a raster, as paint() does with GL */
+		virtual void rasterize(Raster* raster) = 0;
+
+		/**
+		 * implemented by paintables to give a box, in world coordinates, around every pixel
+		 * paint() touches when a pixel is pixelSize world units across
+		 */
+		virtual struct rect2f getBounds(GLfloat pixelSize) = 0;
+
+		/** implemented by paintables to add themselves to a document being saved */
+		virtual void write(DocumentWriter* writer) = 0;
+
 	private:
 		struct color4f color;
 		GLfloat size;
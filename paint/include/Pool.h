@@ -0,0 +1,55 @@
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <stddef.h>
+
+/* objects a pool carves out of each slab it asks the heap for */
+#define POOL_SLAB_OBJECTS 4096
+
+/**
+ * Hands out objects of one size, carved out of slabs of many.  Objects released are kept on a
+ * free list for the next allocation, and reset() drops every slab at once, objects and all.
+ */
+class Pool {
+	public:
+		/** @param size bytes every object takes */
+		Pool(size_t size);
+		~Pool();
+
+		/**
+		 * Allocate an object's worth of memory, aligned for any type, valid until released
+		 * or until the next reset.
+		 *
+		 * @return the memory, or NULL if the heap is exhausted
+		 */
+		void* allocate();
+
+		/** give back an object allocated from this pool */
+		void release(void* p);
+
+		/** drop every object, keeping one slab around for reuse */
+		void reset();
+
+		size_t getSize() { return size; }
+
+		/** objects allocated and not yet released, and slabs taken from the heap ever */
+		int getLive() { return live; }
+		int getSlabs() { return slabs; }
+
+	private:
+		struct slab {
+			struct slab* next;
+			size_t top;
+		};
+
+		/** the slab being carved, which links to the earlier ones */
+		struct slab* current;
+
+		/** objects released, each linking to the next */
+		void* freed;
+
+		size_t size;
+		int live, slabs;
+};
+
+#endif /*POOL_H_*/
@@ -0,0 +1,73 @@
+#ifndef RASTER_H_
+#define RASTER_H_
+
+#include <vector>
+
+#include <glut.h>
+
+#include "structs.h"
+
+/**
+ * A box of pixels [x0, x1) x [y0, y1), relative to the viewport's lower left corner, to be
+ * blended with one of the raster's colors.
+ */
+struct fill {
+	int x0, y0, x1, y1;
+	int color;
+};
+
+/**
+ * Turns paintable geometry into fills by GL's rasterization rules: vertices snap to 1/256 of
+ * a pixel, polygons cover the pixel centers inside them with ties going to top and left
+ * edges, wide lines are columns of pixels along their major axis and points are squares.
+ * Blending the fills in order draws what GL draws.
+ *
+ * The viewport is assumed to cover the window, as it does in paint.
+ */
+class Raster {
+	public:
+		Raster();
+
+		/** take the transform and viewport from the current GL state and drop all fills */
+		void reset();
+
+		int getWidth() { return viewport[2]; }
+		int getHeight() { return viewport[3]; }
+
+		/** color of the primitives that follow, as glColor4f */
+		void setColor(struct color4f color);
+
+		/** primitives in world coordinates, as GL_POINTS, GL_LINES and GL_POLYGON draw them */
+		void point(struct point2f p, GLfloat size);
+		void line(struct point2f a, struct point2f b, GLfloat width);
+		void polygon(const struct point2f* p, int n);
+
+		/** everything rasterized since reset, in drawing order */
+		const std::vector< struct fill >& getFills() { return fills; }
+		const std::vector< struct color4f >& getColors() { return colors; }
+
+	private:
+
+		/** a vertex in clip coordinates */
+		struct vertex {
+			GLfloat x, y, z, w;
+		};
+
+		struct vertex transform(struct point2f p);
+
+		/** snapped window coordinates of a vertex */
+		void project(const struct vertex& v, GLfloat* x, GLfloat* y);
+
+		void triangle(const GLfloat* x, const GLfloat* y);
+
+		/** clip a box to the viewport and add it */
+		void emit(int x0, int y0, int x1, int y1);
+
+		GLfloat mvp[16];
+		GLint viewport[4];
+
+		std::vector< struct fill > fills;
+		std::vector< struct color4f > colors;
+};
+
+#endif /*RASTER_H_*/
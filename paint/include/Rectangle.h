@@ -17,8 +17,16 @@ class Rectangle : public Paintable {
 		/** control start/end points */
 		void setStart(struct point2f start) { this->start = start; }
 		void setEnd(struct point2f end) { this->end = end; }
+		struct point2f getStart() { return start; }
+		struct point2f getEnd() { return end; }
+
+		/** if the rectangle is filled, rather than just its border */
+		bool isFilled() { return filled; }
 
 		void paint();
+		void rasterize(Raster* raster);
+		struct rect2f getBounds(GLfloat pixelSize);
+		void write(DocumentWriter* writer);
 
 	private:
 		struct point2f start, end;
@@ -7,11 +7,11 @@
 #include "Tool.h"
 
 /**
- * A tool used to create a filled or non-filled rectangle paintable 
+ * A tool used to create a filled or non-filled rectangle paintable, taken from a pool
  */
 class RectangleTool : public Tool {
 	public:
-		RectangleTool(bool filled);
+		RectangleTool(bool filled, Pool* pool);
 		virtual ~RectangleTool() {}
 
 		void mouseDown(struct point2f p);
@@ -21,6 +21,7 @@ class RectangleTool : public Tool {
 	private:
 		Rectangle* rect;
 		bool filled;
+		Pool* pool;
 };
 
 #endif /*RECTANGLETOOL_H_*/
@@ -0,0 +1,56 @@
+#ifndef STROKE_H_
+#define STROKE_H_
+
+#include <utility>
+#include <vector>
+
+#include <glut.h>
+
+#include "structs.h"
+
+/**
+ * Filters for scribbled strokes.  A fast mouse reports far more motion events than a stroke of
+ * dots needs: an online filter drops samples too close to the last one kept, and once the stroke
+ * is done it can be simplified and resampled at an even spacing.
+ */
+class Stroke {
+	public:
+		/**
+		 * @param spacing samples closer than this to the last accepted one are dropped
+		 */
+		Stroke(GLfloat spacing);
+
+		/**
+		 * Offer the next sample of the stroke.  The first sample is always accepted.
+		 *
+		 * @return true if the sample should be kept, false if it adds nothing
+		 */
+		bool accept(struct point2f p);
+
+		/** start a new stroke */
+		void reset() { started = false; }
+
+		/**
+		 * Ramer-Douglas-Peucker: drop every point whose removal moves the polyline by no more
+		 * than tolerance.  Segments are also split until no longer than maxLength, so that a
+		 * spline through what is left stays close to the original.  Works in place, the first
+		 * and last points always stay.
+		 *
+		 * @return the number of points left
+		 */
+		static int simplify(struct point2f* points, int n, GLfloat tolerance, GLfloat maxLength);
+
+		/**
+		 * Sample the centripetal Catmull-Rom spline through the points every spacing along its length,
+		 * starting at the first point and ending at the last.
+		 */
+		static void resample(const struct point2f* points, int n, GLfloat spacing,
+			std::vector< struct point2f >& out);
+
+	private:
+		GLfloat spacing;
+		struct point2f last;
+		bool started;
+};
+
+#endif /*STROKE_H_*/
@@ -28,6 +28,12 @@ class Tool {
 		virtual void mouseMove(struct point2f p);
 		virtual void mouseUp(struct point2f p);
 
+		/**
+		 * The mouse moved through n points since the tool last heard of it.  Tools only
+		 * following the mouse need the last one, which is what this does unless overridden.
+		 */
+		virtual void mouseDrag(const struct point2f* points, int n);
+
 		bool isMouseCurrentlyDown() { return mouseCurrentlyDown; }
 
 		/** Add a listener to this tool */
@@ -50,6 +56,14 @@ class Tool {
 		static bool isFill() { return fill; }
 		static void setFill(bool fill) { Tool::fill = fill; }
 
+		/** get/set smoothing of scribbles once they are done */
+		static bool isSmoothing() { return smoothing; }
+		static void setSmoothing(bool smoothing) { Tool::smoothing = smoothing; }
+
+		/** get/set how much of the world one window pixel covers, the larger of x and y */
+		static GLfloat getPixelSize() { return pixelSize; }
+		static void setPixelSize(GLfloat pixelSize) { Tool::pixelSize = pixelSize; }
+
 	protected:
 	
 		/** Publish ToolListener events */
@@ -65,6 +79,8 @@ class Tool {
 		static GLfloat size;
 		static GLfloat width;
 		static bool fill;
+		static bool smoothing;
+		static GLfloat pixelSize;
 };
 
 #endif /*TOOL_H_*/
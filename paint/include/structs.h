@@ -7,8 +7,8 @@
  * Some commonly used defines and structs
  */
 
-#define min(x, y) x < y ? x : y
-#define max(x, y) x > y ? x : y
+#define MIN(x, y) ((x) < (y) ? (x) : (y))
+#define MAX(x, y) ((x) > (y) ? (x) : (y))
 
 struct point2f {
 	GLfloat x, y;
@@ -18,4 +18,37 @@ struct color4f {
 	GLfloat r, g, b, a;
 };
 
+/* an axis aligned box, empty when x0 > x1 */
+struct rect2f {
+	GLfloat x0, y0, x1, y1;
+};
+
+inline struct rect2f emptyRect() {
+	struct rect2f r = { 1.0f, 1.0f, 0.0f, 0.0f };
+	return r;
+}
+
+inline bool isEmpty(struct rect2f r) {
+	return r.x0 > r.x1 || r.y0 > r.y1;
+}
+
+/** the smallest box holding both */
+inline struct rect2f unite(struct rect2f a, struct rect2f b) {
+	if(isEmpty(a)) return b;
+	if(isEmpty(b)) return a;
+	struct rect2f r = { MIN(a.x0, b.x0), MIN(a.y0, b.y0), MAX(a.x1, b.x1), MAX(a.y1, b.y1) };
+	return r;
+}
+
+/** r grown by d on every side */
+inline struct rect2f grow(struct rect2f r, GLfloat d) {
+	if(isEmpty(r)) return r;
+	struct rect2f g = { r.x0 - d, r.y0 - d, r.x1 + d, r.y1 + d };
+	return g;
+}
+
+inline bool overlaps(struct rect2f a, struct rect2f b) {
+	return !isEmpty(a) && !isEmpty(b) && a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+}
+
 #endif /*STRUCTS_H_*/
@@ -0,0 +1,58 @@
+#include <stdlib.h>
+
+#include "Arena.h"
+
+/* alignment of every allocation */
+#define ARENA_ALIGN 16
+
+/* where a block's memory starts, past its header */
+#define BLOCK_HEADER ((sizeof(struct block) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))
+
+Arena::Arena() {
+	current = NULL;
+	used = 0;
+}
+
+Arena::~Arena() {
+	while(current != NULL) {
+		struct block* b = current;
+		current = b->next;
+		free(b);
+	}
+}
+
+void* Arena::allocate(size_t size) {
+	size = (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+
+	if(current == NULL || current->top + size > current->size) {
+		size_t blockSize = ARENA_BLOCK_SIZE;
+		while(blockSize - BLOCK_HEADER < size) {
+			blockSize *= 2;
+		}
+
+		struct block* b = (struct block*) malloc(blockSize);
+		if(b == NULL) return NULL;
+		b->next = current;
+		b->size = blockSize;
+		b->top = BLOCK_HEADER;
+		current = b;
+	}
+
+	void* p = (char*) current + current->top;
+	current->top += size;
+	used += size;
+	return p;
+}
+
+void Arena::reset() {
+	if(current == NULL) return;
+
+	/* keep the newest block for what comes next */
+	while(current->next != NULL) {
+		struct block* b = current->next;
+		current->next = b->next;
+		free(b);
+	}
+	current->top = BLOCK_HEADER;
+	used = 0;
+}
@@ -1,10 +1,86 @@
+#include <math.h>
+
 #include <glut.h>
 
 #include "Canvas.h"
+#include "Dots.h"
+#include "Line.h"
+#include "Rectangle.h"
 #include <Paintable.h>
 
-Canvas::Canvas() {
-    glClearColor(0.0, 0.0, 0.0, 0.0);
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+/* alpha a fading paintable loses every tick */
+#define FADE_STEP 0.005f
+
+/* alpha of a paintable that has faded away, to be pruned */
+#define FADE_DEAD -1.0f
+
+/** fade n alphas by step, those already at or below zero die */
+typedef void (*fader_t)(GLfloat* alphas, int n, GLfloat step);
+
+static void fadeScalar(GLfloat* alphas, int n, GLfloat step) {
+	for(int i = 0; i < n; i++) {
+		alphas[i] = alphas[i] > 0.0f ? alphas[i] - step : FADE_DEAD;
+	}
+}
+
+#ifdef HAVE_X86
+
+__attribute__((target("avx2")))
+static void fadeAVX2(GLfloat* alphas, int n, GLfloat step) {
+	const __m256 s = _mm256_set1_ps(step);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 dead = _mm256_set1_ps(FADE_DEAD);
+
+	int i = 0;
+	for(; i + 8 <= n; i += 8) {
+		const __m256 a = _mm256_loadu_ps(alphas + i);
+		const __m256 live = _mm256_cmp_ps(a, zero, _CMP_GT_OQ);
+		_mm256_storeu_ps(alphas + i, _mm256_blendv_ps(dead, _mm256_sub_ps(a, s), live));
+	}
+
+	fadeScalar(alphas + i, n - i, step);
+}
+
+#endif /* HAVE_X86 */
+
+/* known kernels, fastest first */
+static const struct {
+	const char* name;
+	fader_t kernel;
+} faders[] = {
+#ifdef HAVE_X86
+	{ "avx2", fadeAVX2 },
+#endif
+	{ "scalar", fadeScalar }
+};
+
+#define NUM_FADERS ((int) (sizeof(faders) / sizeof(faders[0])))
+
+static bool faderSupported(fader_t kernel) {
+#ifdef HAVE_X86
+	__builtin_cpu_init();
+	if(kernel == fadeAVX2) return __builtin_cpu_supports("avx2");
+#endif
+	return true;
+}
+
+/** the whole world, as the grid covers it */
+static struct rect2f worldBounds() {
+	struct rect2f r = { WORLD_X0, WORLD_Y0, WORLD_X1, WORLD_Y1 };
+	return r;
+}
+
+Canvas::Canvas() : dotsPool(sizeof(Dots) + PAINTABLE_HEADER),
+		linePool(sizeof(Line) + PAINTABLE_HEADER),
+		rectanglePool(sizeof(Rectangle) + PAINTABLE_HEADER),
+		grid(worldBounds()) {
+	background.r = background.g = background.b = background.a = 0.0f;
+    glClearColor(background.r, background.g, background.b, background.a);
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
 
@@ -17,71 +93,339 @@ Canvas::Canvas() {
 	// default no paintable and no fading
 	activePaintable = NULL;
 	fading = false;
+	faded = false;
+
+	fadeKernel = NUM_FADERS - 1;
+	for(int i = 0; i < NUM_FADERS; i++) {
+		if(faderSupported(faders[i].kernel)) {
+			fadeKernel = i;
+			break;
+		}
+	}
+
+	// draw with GL unless asked otherwise
+	compositor = new Compositor(0);
+	composing = false;
+
+	// keep committed paintables in a layer, built on the first draw
+	layering = true;
+	layered = -1;
+
+	// nothing indexed and nothing drawn yet
+	indexed = false;
+	indexSize = 0.0f;
+	whole = true;
+	lastKnown = false;
+	dirty = activeBounds = lastDamage = emptyRect();
 }
 
 Canvas::~Canvas() {
-	clearPaintables();
+	release();
+	closeDocuments();
+	delete compositor;
 }
 
 void Canvas::clear() {
-	clearPaintables();
+	history.clear();
+	hideAll();
+	activePaintable = NULL;
 	glutPostRedisplay();
 }
 
-void Canvas::clearPaintables() {
-	std::vector< Paintable* >::iterator itr = paintables.begin();
-	while(itr != paintables.end()) {
-		Paintable* p = *itr;
-		itr = paintables.erase(itr);
-		delete p;
-	}
+void Canvas::reset() {
+	hideAll();
 	activePaintable = NULL;
+	release();
+	glutPostRedisplay();
+}
+
+void Canvas::release() {
+	/*
+	 * paintables have nothing to do when destroyed, so those from the pools go with their slabs.
+	 * anything else in the pools, like a paintable still being made, keeps them around
+	 */
+	const int pooled = dotsPool.getLive() + linePool.getLive() + rectanglePool.getLive();
+	if(pooled != history.getLive()) {
+		history.reset();
+		return;
+	}
+	history.drop();
+	dotsPool.reset();
+	linePool.reset();
+	rectanglePool.reset();
+	arena.reset();
+	closeDocuments();
+}
+
+void Canvas::hideAll() {
+	paintables.clear();
+	alphas.clear();
+	ids.clear();
+	grid.clear();
+	indexed = false;
+	layered = -1;
+	whole = true;
+}
+
+void Canvas::show(Paintable* p, int id) {
+	paintables.push_back(p);
+	alphas.push_back(p->getColor().a);
+	ids.push_back(id);
+
+	dirty = unite(dirty, p->getBounds(getPixelSize()));
+	if(indexed) {
+		grid.insert(p, p->getBounds(indexSize));
+	}
 }
 
 void Canvas::addPaintable(Paintable* p) {
 	if(p != NULL) {
-		paintables.push_back(p);
+		show(p, history.create(p));
+	}
+}
+
+bool Canvas::undo() {
+	const struct History::command* c = history.undo();
+	if(c == NULL) return false;
+
+	if(c->clear) {
+		// nothing was added since the clear, put back what it cleared
+		for(int id = history.getFirst(); id < history.getCursor(); id++) {
+			Paintable* p = history.get(id).paintable;
+			if(p != NULL) show(p, id);
+		}
+	} else if(!paintables.empty() && paintables.back() == c->paintable) {
+		// the last creation shown, unless it faded away
+		paintables.pop_back();
+		alphas.pop_back();
+		ids.pop_back();
+
+		// neither the index nor the layer can take a paintable out
+		indexed = false;
+		layered = -1;
+		whole = true;
+	}
+	return true;
+}
+
+bool Canvas::redo() {
+	const struct History::command* c = history.redo();
+	if(c == NULL) return false;
+
+	if(c->clear) {
+		hideAll();
+	} else if(c->paintable != NULL) {
+		show(c->paintable, history.getCursor() - 1);
 	}
+	return true;
 }
 
 void Canvas::setActivePaintable(Paintable* p) {
 	activePaintable = p;
 }
 
-void Canvas::drawScene() {
-	std::vector< Paintable* >::iterator itr = paintables.begin();
+GLfloat Canvas::getPixelSize() {
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	if(viewport[2] <= 0 || viewport[3] <= 0) return 1.0f;
+	return MAX((WORLD_X1 - WORLD_X0) / viewport[2], (WORLD_Y1 - WORLD_Y0) / viewport[3]);
+}
+
+void Canvas::scissorTo(struct rect2f box) {
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	const GLfloat sx = viewport[2] / (WORLD_X1 - WORLD_X0), sy = viewport[3] / (WORLD_Y1 - WORLD_Y0);
+
+	int x0 = (int) floorf((box.x0 - WORLD_X0) * sx), y0 = (int) floorf((box.y0 - WORLD_Y0) * sy);
+	int x1 = (int) ceilf((box.x1 - WORLD_X0) * sx), y1 = (int) ceilf((box.y1 - WORLD_Y0) * sy);
+	x0 = MAX(x0, 0);
+	y0 = MAX(y0, 0);
+	x1 = MIN(x1, viewport[2]);
+	y1 = MIN(y1, viewport[3]);
+	glScissor(viewport[0] + x0, viewport[1] + y0, MAX(x1 - x0, 0), MAX(y1 - y0, 0));
+}
+
+void Canvas::reindex(GLfloat pixelSize) {
+	grid.clear();
+	std::vector< Paintable* >::const_iterator itr = paintables.begin();
 	while(itr != paintables.end()) {
-		Paintable* p = *itr;
-		if(p->isDead()) {
-			itr = paintables.erase(itr);
-			delete p;
+		grid.insert(*itr, (*itr)->getBounds(pixelSize));
+		itr++;
+	}
+	indexed = true;
+	indexSize = pixelSize;
+}
+
+void Canvas::updateLayer() {
+	if(layered == (int) paintables.size()) return;
+
+	if(layered < 0 || !compositor->add(paintables, layered)) {
+		compositor->compose(paintables, NULL, background);
+	}
+	layered = (int) paintables.size();
+}
+
+const char* Canvas::getFadeKernelName() {
+	return faders[fadeKernel].name;
+}
+
+void Canvas::prune() {
+	if(!faded) return;
+
+	// one stable pass, the survivors keep their order
+	size_t kept = 0;
+	for(size_t i = 0; i < paintables.size(); i++) {
+		Paintable* p = paintables[i];
+		if(alphas[i] <= FADE_DEAD || p->isDead()) {
+			history.forget(ids[i]);
+			continue;
+		}
+		p->setAlpha(alphas[i]);
+		paintables[kept] = p;
+		alphas[kept] = alphas[i];
+		ids[kept] = ids[i];
+		kept++;
+	}
+
+	// removing paintables leaves the index and the picture behind
+	if(kept < paintables.size()) {
+		paintables.resize(kept);
+		alphas.resize(kept);
+		ids.resize(kept);
+		indexed = false;
+		layered = -1;
+		whole = true;
+	}
+	faded = false;
+}
+
+void Canvas::drawScene() {
+	prune();
+
+	// once everything has faded away, nothing needs the history, the pools or the arena
+	if(history.getLive() == 0 && activePaintable == NULL) {
+		release();
+	}
+
+	const GLfloat pixelSize = getPixelSize();
+	const struct rect2f active = activePaintable != NULL ?
+		activePaintable->getBounds(pixelSize) : emptyRect();
+
+	/*
+	 * repaint only what changed when we know what that is: where the active paintable was and
+	 * is, and what was added.  a draw with nothing changed is the window asking for the whole
+	 * picture.  the buffer drawn into may hold the frame before last, as it does when swapping
+	 * flips buffers, so what changed for the last draw is repainted again
+	 */
+	const struct rect2f damage = unite(dirty, unite(activeBounds, active));
+	const bool known = !whole && !isEmpty(damage);
+	const bool partial = known && lastKnown && !composing;
+
+	// the layer stands in for the committed paintables, unless they are all changing
+	const bool layer = layering && !fading && !composing;
+	if(layer) {
+		updateLayer();
+	}
+
+	if(partial) {
+		const struct rect2f region = unite(damage, lastDamage);
+		glEnable(GL_SCISSOR_TEST);
+		scissorTo(region);
+
+		if(layer) {
+			compositor->blit(WORLD_X0, WORLD_Y0, WORLD_X1, WORLD_Y1);
 		} else {
-			p->paint();
-			itr++;
+			if(!indexed || indexSize != pixelSize) {
+				reindex(pixelSize);
+			}
+			glClear(GL_COLOR_BUFFER_BIT);
+			grid.query(region, damaged);
+			for(size_t i = 0; i < damaged.size(); i++) {
+				damaged[i]->paint();
+			}
+		}
+		if(activePaintable != NULL) {
+			activePaintable->paint();
+		}
+		glDisable(GL_SCISSOR_TEST);
+	} else if(layer) {
+		compositor->blit(WORLD_X0, WORLD_Y0, WORLD_X1, WORLD_Y1);
+		if(activePaintable != NULL) {
+			activePaintable->paint();
+		}
+	} else {
+		glClear(GL_COLOR_BUFFER_BIT);
+		if(composing) {
+			// the compositor's image no longer holds the layer
+			compositor->compose(paintables, activePaintable, background);
+			compositor->blit(WORLD_X0, WORLD_Y0, WORLD_X1, WORLD_Y1);
+			layered = -1;
+		} else {
+			std::vector< Paintable* >::const_iterator itr;
+			for(itr = paintables.begin(); itr != paintables.end(); itr++) {
+				(*itr)->paint();
+			}
+			if(activePaintable != NULL) {
+				activePaintable->paint();
+			}
 		}
 	}
 
-	if(activePaintable != NULL) {
-		activePaintable->paint();
+	lastKnown = known;
+	lastDamage = damage;
+	whole = false;
+	dirty = emptyRect();
+	activeBounds = active;
+}
+
+bool Canvas::exportPPM(const char* path) {
+	compositor->compose(paintables, activePaintable, background);
+	layered = -1;
+	return compositor->writePPM(path);
+}
+
+bool Canvas::save(const char* path) {
+	prune();
+
+	DocumentWriter writer;
+	std::vector< Paintable* >::const_iterator itr;
+	for(itr = paintables.begin(); itr != paintables.end(); itr++) {
+		(*itr)->write(&writer);
+	}
+	return writer.write(path);
+}
+
+bool Canvas::load(const char* path) {
+	Document* document = Document::open(path);
+	if(document == NULL) return false;
+	documents.push_back(document);
+
+	clear();
+	for(int i = 0; i < document->getCount(); i++) {
+		addPaintable(document->decode(i, &arena, &dotsPool, &linePool, &rectanglePool));
+	}
+	return true;
+}
+
+void Canvas::closeDocuments() {
+	for(size_t i = 0; i < documents.size(); i++) {
+		delete documents[i];
 	}
+	documents.clear();
 }
 
 void Canvas::tick() {
 	if(fading) {
 		/*
-		 * if we're fading, drop every alpha by a small amount, and if they're 0, kill them off
+		 * if we're fading, drop every alpha by a small amount, and if they're 0, mark them to be
+		 * pruned before the next draw
 		 */
-		std::vector< Paintable* >::const_iterator itr = paintables.begin();
-		while(itr != paintables.end()) {
-			struct color4f c = (*itr)->getColor();
-			if(c.a <= 0.0f) {
-				(*itr)->kill();
-			} else {
-				c.a -= 0.005f;
-				(*itr)->setColor(c);
-			}
-			itr++;
+		if(!alphas.empty()) {
+			faders[fadeKernel].kernel(&alphas[0], (int) alphas.size(), FADE_STEP);
 		}
+		faded = true;
+		whole = true;
+		layered = -1;
 		glutPostRedisplay();
 	}
 }
@@ -0,0 +1,373 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Compositor.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+/** blend n RGBA pixels with a color as GL_SRC_ALPHA/GL_ONE_MINUS_SRC_ALPHA does */
+typedef void (*blender_t)(unsigned char* p, int n, const GLfloat* source, GLfloat oneMinusAlpha);
+
+static inline unsigned char toByte(GLfloat c) {
+	if(c <= 0.0f) return 0;
+	if(c >= 1.0f) return 255;
+	return (unsigned char) (c * 255.0f + 0.5f);
+}
+
+static inline GLfloat clamp(GLfloat c) {
+	return c < 0.0f ? 0.0f : c > 1.0f ? 1.0f : c;
+}
+
+/*
+ * GL computes every channel as c * a + (p / 255) * (1 - a) and rounds it to the nearest byte.
+ * the vector kernel evaluates the same float operations in the same order, with no fused
+ * multiply-add, so all kernels produce GL's bytes exactly.
+ */
+static void blendScalar(unsigned char* p, int n, const GLfloat* source, GLfloat oneMinusAlpha) {
+	for(int i = 0; i < n * 4; i++) {
+		p[i] = toByte(source[i & 3] + p[i] / 255.0f * oneMinusAlpha);
+	}
+}
+
+#ifdef HAVE_X86
+
+__attribute__((target("avx2")))
+static void blendAVX2(unsigned char* p, int n, const GLfloat* source, GLfloat oneMinusAlpha) {
+	const __m256 src = _mm256_setr_ps(source[0], source[1], source[2], source[3],
+		source[0], source[1], source[2], source[3]);
+	const __m256 oma = _mm256_set1_ps(oneMinusAlpha);
+	const __m256 scale = _mm256_set1_ps(255.0f);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	/* four pixels, two per register */
+	int i = 0;
+	for(; i + 4 <= n; i += 4) {
+		const __m128i bytes = _mm_loadu_si128((const __m128i*) (p + i * 4));
+		__m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+		__m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+
+		lo = _mm256_add_ps(src, _mm256_mul_ps(_mm256_div_ps(lo, scale), oma));
+		hi = _mm256_add_ps(src, _mm256_mul_ps(_mm256_div_ps(hi, scale), oma));
+		lo = _mm256_min_ps(_mm256_max_ps(lo, zero), one);
+		hi = _mm256_min_ps(_mm256_max_ps(hi, zero), one);
+		const __m256i loBytes = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(lo, scale), half));
+		const __m256i hiBytes = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(hi, scale), half));
+
+		/* the packs work within 128 bit lanes, put the pixels back in order */
+		const __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(loBytes, hiBytes), 0xD8);
+		_mm_storeu_si128((__m128i*) (p + i * 4), _mm_packus_epi16(_mm256_castsi256_si128(words),
+			_mm256_extracti128_si256(words, 1)));
+	}
+
+	blendScalar(p + i * 4, n - i, source, oneMinusAlpha);
+}
+
+#endif /* HAVE_X86 */
+
+/* known kernels, fastest first */
+static const struct {
+	const char* name;
+	blender_t kernel;
+} kernels[] = {
+#ifdef HAVE_X86
+	{ "avx2", blendAVX2 },
+#endif
+	{ "scalar", blendScalar }
+};
+
+#define NUM_KERNELS ((int) (sizeof(kernels) / sizeof(kernels[0])))
+
+static bool kernelSupported(blender_t kernel) {
+#ifdef HAVE_X86
+	__builtin_cpu_init();
+	if(kernel == blendAVX2) return __builtin_cpu_supports("avx2");
+#endif
+	return true;
+}
+
+Compositor::Compositor(int threads) {
+	if(threads < 1) {
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = n > 0 ? (int) n : 1;
+	}
+
+	pixels = NULL;
+	width = height = 0;
+	tilesX = tilesY = 0;
+	clearing = true;
+	texture = 0;
+	textureWidth = textureHeight = 0;
+	staleY0 = staleY1 = 0;
+
+	kernel = NUM_KERNELS - 1;
+	for(int i = 0; i < NUM_KERNELS; i++) {
+		if(kernelSupported(kernels[i].kernel)) {
+			kernel = i;
+			break;
+		}
+	}
+
+	generation = busy = 0;
+	quit = false;
+	nextTile = 0;
+	pthread_mutex_init(&lock, NULL);
+	pthread_cond_init(&start, NULL);
+	pthread_cond_init(&done, NULL);
+
+	/* worker 0 is whoever calls compose */
+	numThreads = 1;
+	for(int i = 1; i < threads; i++) {
+		pthread_t thread;
+		if(pthread_create(&thread, NULL, workerThread, this) != 0) break;
+		this->threads.push_back(thread);
+		numThreads++;
+	}
+}
+
+Compositor::~Compositor() {
+	pthread_mutex_lock(&lock);
+	quit = true;
+	pthread_cond_broadcast(&start);
+	pthread_mutex_unlock(&lock);
+
+	std::vector< pthread_t >::iterator itr = threads.begin();
+	while(itr != threads.end()) {
+		pthread_join(*itr, NULL);
+		itr++;
+	}
+
+	pthread_cond_destroy(&done);
+	pthread_cond_destroy(&start);
+	pthread_mutex_destroy(&lock);
+	free(pixels);
+}
+
+const char* Compositor::getKernelName() {
+	return kernels[kernel].name;
+}
+
+void Compositor::compose(const std::vector< Paintable* >& paintables, Paintable* active,
+		struct color4f background) {
+	raster.reset();
+	std::vector< Paintable* >::const_iterator itr = paintables.begin();
+	while(itr != paintables.end()) {
+		(*itr)->rasterize(&raster);
+		itr++;
+	}
+	if(active != NULL) {
+		active->rasterize(&raster);
+	}
+
+	if(raster.getWidth() != width || raster.getHeight() != height) {
+		free(pixels);
+		width = MAX(raster.getWidth(), 0);
+		height = MAX(raster.getHeight(), 0);
+		pixels = (unsigned char*) malloc((size_t) width * height * 4);
+		if(pixels == NULL) {
+			width = height = 0;
+		}
+		tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+		tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+		bins.resize(tilesX * tilesY);
+	}
+
+	this->background[0] = toByte(background.r);
+	this->background[1] = toByte(background.g);
+	this->background[2] = toByte(background.b);
+	this->background[3] = toByte(background.a);
+
+	staleY0 = 0;
+	staleY1 = height;
+	blendFills(true);
+}
+
+bool Compositor::add(const std::vector< Paintable* >& paintables, size_t first) {
+	raster.reset();
+	if(pixels == NULL || raster.getWidth() != width || raster.getHeight() != height) return false;
+
+	for(size_t i = first; i < paintables.size(); i++) {
+		paintables[i]->rasterize(&raster);
+	}
+
+	const std::vector< struct fill >& fills = raster.getFills();
+	for(size_t i = 0; i < fills.size(); i++) {
+		staleY0 = staleY0 < staleY1 ? MIN(staleY0, fills[i].y0) : fills[i].y0;
+		staleY1 = MAX(staleY1, fills[i].y1);
+	}
+	blendFills(false);
+	return true;
+}
+
+void Compositor::blendFills(bool clearing) {
+	this->clearing = clearing;
+
+	/* GL clamps colors before blending */
+	const std::vector< struct color4f >& colors = raster.getColors();
+	sources.resize(colors.size());
+	oneMinusAlphas.resize(colors.size());
+	for(size_t i = 0; i < colors.size(); i++) {
+		const GLfloat a = clamp(colors[i].a);
+		sources[i].r = clamp(colors[i].r) * a;
+		sources[i].g = clamp(colors[i].g) * a;
+		sources[i].b = clamp(colors[i].b) * a;
+		sources[i].a = a * a;
+		oneMinusAlphas[i] = 1.0f - a;
+	}
+
+	/* bin the fills, each tile's list stays in drawing order */
+	for(size_t i = 0; i < bins.size(); i++) {
+		bins[i].clear();
+	}
+	const std::vector< struct fill >& fills = raster.getFills();
+	for(size_t i = 0; i < fills.size(); i++) {
+		const struct fill& f = fills[i];
+		for(int ty = f.y0 / TILE_SIZE; ty <= (f.y1 - 1) / TILE_SIZE; ty++) {
+			for(int tx = f.x0 / TILE_SIZE; tx <= (f.x1 - 1) / TILE_SIZE; tx++) {
+				bins[ty * tilesX + tx].push_back((int) i);
+			}
+		}
+	}
+
+	run();
+}
+
+void Compositor::run() {
+	nextTile = 0;
+
+	pthread_mutex_lock(&lock);
+	generation++;
+	busy = numThreads - 1;
+	pthread_cond_broadcast(&start);
+	pthread_mutex_unlock(&lock);
+
+	work();
+
+	pthread_mutex_lock(&lock);
+	while(busy > 0) {
+		pthread_cond_wait(&done, &lock);
+	}
+	pthread_mutex_unlock(&lock);
+}
+
+void* Compositor::workerThread(void* arg) {
+	Compositor* c = (Compositor*) arg;
+	int seen = 0;
+
+	pthread_mutex_lock(&c->lock);
+	for(;;) {
+		while(c->generation == seen && !c->quit) {
+			pthread_cond_wait(&c->start, &c->lock);
+		}
+		if(c->quit) break;
+		seen = c->generation;
+		pthread_mutex_unlock(&c->lock);
+
+		c->work();
+
+		pthread_mutex_lock(&c->lock);
+		if(--c->busy == 0) pthread_cond_signal(&c->done);
+	}
+	pthread_mutex_unlock(&c->lock);
+
+	return NULL;
+}
+
+void Compositor::work() {
+	const int numTiles = tilesX * tilesY;
+	int tile;
+	while((tile = __sync_fetch_and_add(&nextTile, 1)) < numTiles) {
+		composeTile(tile);
+	}
+}
+
+void Compositor::composeTile(int tile) {
+	const blender_t blend = kernels[kernel].kernel;
+	const int x0 = (tile % tilesX) * TILE_SIZE, y0 = (tile / tilesX) * TILE_SIZE;
+	const int x1 = MIN(x0 + TILE_SIZE, width), y1 = MIN(y0 + TILE_SIZE, height);
+
+	for(int y = y0; clearing && y < y1; y++) {
+		unsigned char* row = pixels + ((size_t) y * width + x0) * 4;
+		for(int x = x0; x < x1; x++, row += 4) {
+			memcpy(row, background, 4);
+		}
+	}
+
+	const std::vector< struct fill >& fills = raster.getFills();
+	const std::vector< int >& bin = bins[tile];
+	for(size_t i = 0; i < bin.size(); i++) {
+		const struct fill& f = fills[bin[i]];
+		const int fx0 = MAX(f.x0, x0), fx1 = MIN(f.x1, x1);
+		const int fy0 = MAX(f.y0, y0), fy1 = MIN(f.y1, y1);
+		const GLfloat* source = &sources[f.color].r;
+		for(int y = fy0; y < fy1; y++) {
+			blend(pixels + ((size_t) y * width + fx0) * 4, fx1 - fx0, source, oneMinusAlphas[f.color]);
+		}
+	}
+}
+
+/** the smallest power of two at least n */
+static int powerOfTwo(int n) {
+	int p = 1;
+	while(p < n) p <<= 1;
+	return p;
+}
+
+void Compositor::blit(GLfloat x0, GLfloat y0, GLfloat x1, GLfloat y1) {
+	if(pixels == NULL) return;
+
+	/* GL 1.x only promises power of two textures, the composition takes their corner */
+	const int potWidth = powerOfTwo(width), potHeight = powerOfTwo(height);
+
+	if(texture == 0) {
+		glGenTextures(1, &texture);
+	}
+	glBindTexture(GL_TEXTURE_2D, texture);
+	if(textureWidth != width || textureHeight != height) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, potWidth, potHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		textureWidth = width;
+		textureHeight = height;
+		staleY0 = 0;
+		staleY1 = height;
+	}
+	if(staleY0 < staleY1) {
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, staleY0, width, staleY1 - staleY0, GL_RGBA,
+			GL_UNSIGNED_BYTE, pixels + (size_t) staleY0 * width * 4);
+	}
+	staleY0 = staleY1 = 0;
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+	const GLfloat s1 = (GLfloat) width / potWidth, t1 = (GLfloat) height / potHeight;
+	glDisable(GL_BLEND);
+	glEnable(GL_TEXTURE_2D);
+	glBegin(GL_QUADS);
+		glTexCoord2f(0.0f, 0.0f); glVertex2f(x0, y0);
+		glTexCoord2f(s1, 0.0f); glVertex2f(x1, y0);
+		glTexCoord2f(s1, t1); glVertex2f(x1, y1);
+		glTexCoord2f(0.0f, t1); glVertex2f(x0, y1);
+	glEnd();
+	glDisable(GL_TEXTURE_2D);
+	glEnable(GL_BLEND);
+}
+
+bool Compositor::writePPM(const char* path) {
+	FILE* fp = fopen(path, "wb");
+	if(fp == NULL) return false;
+
+	fprintf(fp, "P6\n%d %d\n255\n", width, height);
+	for(int y = height - 1; y >= 0; y--) {
+		const unsigned char* p = pixels + (size_t) y * width * 4;
+		for(int x = 0; x < width; x++, p += 4) {
+			fwrite(p, 1, 3, fp);
+		}
+	}
+	return fclose(fp) == 0;
+}
@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Document.h"
+#include "Dots.h"
+#include "Line.h"
+#include "Rectangle.h"
+
+Document::Document(void* base, size_t size) {
+	this->base = base;
+	this->size = size;
+
+	header = (const struct header*) base;
+	table = (const struct record*) ((char*) base + header->table);
+	points = (struct point2f*) ((char*) base + header->points);
+}
+
+Document::~Document() {
+	munmap(base, size);
+}
+
+Document* Document::open(const char* path) {
+	int fd = ::open(path, O_RDONLY);
+	if(fd < 0) return NULL;
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(struct header)) {
+		close(fd);
+		return NULL;
+	}
+	const size_t size = (size_t) st.st_size;
+
+	// private and writable: decoded paintables may change, the file does not
+	void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(base == MAP_FAILED) return NULL;
+
+	// everything the header points to has to lie within the file
+	const struct header* h = (const struct header*) base;
+	const bool valid = memcmp(h->magic, DOCUMENT_MAGIC, 4) == 0 &&
+		h->version == DOCUMENT_VERSION &&
+		h->table % 8 == 0 && h->table <= size &&
+		h->count <= (size - h->table) / sizeof(struct record) &&
+		h->points % 8 == 0 && h->points <= size &&
+		h->pointCount <= (size - h->points) / sizeof(struct point2f);
+	if(!valid) {
+		munmap(base, size);
+		return NULL;
+	}
+	return new Document(base, size);
+}
+
+Paintable* Document::decode(int i, Arena* arena, Pool* dotsPool, Pool* linePool,
+		Pool* rectanglePool) {
+	const struct record& r = table[i];
+
+	Paintable* p = NULL;
+	switch(r.kind) {
+		case DOTS:
+			if(r.first > header->pointCount || r.pointCount > header->pointCount - r.first) {
+				return NULL;
+			}
+			p = new (dotsPool) Dots(arena, points + r.first, (int) r.pointCount, r.box);
+			break;
+
+		case LINE: {
+			Line* line = new (linePool) Line();
+			line->setStart(r.start);
+			line->setEnd(r.end);
+			p = line;
+			break;
+		}
+
+		case RECTANGLE:
+		case RECTANGLE_FILLED: {
+			Rectangle* rect = new (rectanglePool) Rectangle(r.kind == RECTANGLE_FILLED);
+			rect->setStart(r.start);
+			rect->setEnd(r.end);
+			p = rect;
+			break;
+		}
+
+		default:
+			return NULL;
+	}
+
+	p->setColor(r.color);
+	p->setPointSize(r.size);
+	p->setLineWidth(r.width);
+	return p;
+}
+
+struct Document::record DocumentWriter::describe(Paintable* p, enum Document::kind kind) {
+	struct Document::record r;
+	memset(&r, 0, sizeof(r));
+	r.kind = kind;
+	r.color = p->getColor();
+	r.size = p->getPointSize();
+	r.width = p->getLineWidth();
+	return r;
+}
+
+void DocumentWriter::addDots(Paintable* p, const struct point2f* points, int count,
+		struct rect2f box) {
+	struct Document::record r = describe(p, Document::DOTS);
+	r.first = this->points.size();
+	r.pointCount = count;
+	r.box = box;
+	table.push_back(r);
+
+	this->points.insert(this->points.end(), points, points + count);
+}
+
+void DocumentWriter::addShape(Paintable* p, enum Document::kind kind, struct point2f start,
+		struct point2f end) {
+	struct Document::record r = describe(p, kind);
+	r.start = start;
+	r.end = end;
+	struct rect2f box = {
+		MIN(start.x, end.x), MIN(start.y, end.y), MAX(start.x, end.x), MAX(start.y, end.y)
+	};
+	r.box = box;
+	table.push_back(r);
+}
+
+bool DocumentWriter::write(const char* path) {
+	struct Document::header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, DOCUMENT_MAGIC, 4);
+	h.version = DOCUMENT_VERSION;
+	h.count = (uint32_t) table.size();
+	h.table = sizeof(h);
+	h.points = h.table + table.size() * sizeof(struct Document::record);
+	h.pointCount = points.size();
+
+	FILE* fp = fopen(path, "wb");
+	if(fp == NULL) return false;
+
+	bool written = fwrite(&h, sizeof(h), 1, fp) == 1;
+	if(written && !table.empty()) {
+		written = fwrite(&table[0], sizeof(table[0]), table.size(), fp) == table.size();
+	}
+	if(written && !points.empty()) {
+		written = fwrite(&points[0], sizeof(points[0]), points.size(), fp) == points.size();
+	}
+	return fclose(fp) == 0 && written;
+}
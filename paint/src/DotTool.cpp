@@ -2,31 +2,58 @@
 
 #include "DotTool.h"
 
-DotTool::DotTool(bool single) : Tool() {
+DotTool::DotTool(bool single, Arena* arena, Pool* pool) : Tool(), stroke(0.0f) {
 	dots = NULL;
 	this->single = single;
+	this->arena = arena;
+	this->pool = pool;
 }
 
 void DotTool::mouseDown(struct point2f p) {
 	Tool::mouseDown(p);
-	dots = new Dots();
+	dots = new (pool) Dots(arena);
 	dots->setColor(getColor());
 	dots->setPointSize(getPointSize());
 	dots->addPoint(p.x, p.y);
+
+	// dots overlapping their predecessor by more than half add little to the scribble
+	stroke = Stroke(MAX(getPointSize() * SCRIBBLE_SPACING, 1.0f) * getPixelSize());
+	stroke.accept(p);
+
 	notifyIntermediatePaintableCreated(dots);
 }
 
 void DotTool::mouseMove(struct point2f p) {
-	if(isMouseCurrentlyDown() && !single) {
+	if(isMouseCurrentlyDown() && !single && stroke.accept(p)) {
 		dots->addPoint(p.x, p.y);
 		notifyIntermediatePaintableCreated(dots);
 	}
 }
 
+void DotTool::mouseDrag(const struct point2f* points, int n) {
+	if(!isMouseCurrentlyDown() || single) return;
+
+	// a scribble needs every point, but the listeners only need to hear once
+	bool added = false;
+	for(int i = 0; i < n; i++) {
+		if(stroke.accept(points[i])) {
+			dots->addPoint(points[i].x, points[i].y);
+			added = true;
+		}
+	}
+	if(added) {
+		notifyIntermediatePaintableCreated(dots);
+	}
+}
+
 void DotTool::mouseUp(struct point2f p) {
 	Tool::mouseUp(p);
 	if(!single) {
 		dots->addPoint(p.x, p.y);
+		if(isSmoothing()) {
+			const GLfloat spacing = MAX(getPointSize() * SCRIBBLE_SPACING, 1.0f) * getPixelSize();
+			dots->smooth(SCRIBBLE_TOLERANCE * getPixelSize(), SCRIBBLE_SEGMENT * spacing, spacing);
+		}
 	}
 	notifyFinalPaintableCreated(dots);
 	dots = NULL;
@@ -1,35 +1,82 @@
 #include <stdio.h>
-#include <stdlib.h>
+#include <string.h>
 
 #include <glut.h>
 
+#include "Document.h"
 #include "Dots.h"
+#include "Stroke.h"
 
-Dots::~Dots() {
-	std::vector< struct point2f* >::iterator itr = dots.begin();
-	while(itr != dots.end()) {
-		struct point2f* p = *itr;
-		itr = dots.erase(itr);
-		free(p);
-	}
+Dots::Dots(Arena* arena) : Paintable() {
+	this->arena = arena;
+	points = NULL;
+	count = capacity = 0;
+	box = emptyRect();
+}
+
+Dots::Dots(Arena* arena, struct point2f* points, int count, struct rect2f box) : Paintable() {
+	this->arena = arena;
+	this->points = points;
+	this->count = capacity = count;
+	this->box = box;
 }
 
 void Dots::addPoint(GLfloat x, GLfloat y) {
-	struct point2f* p = (struct point2f*) malloc(sizeof(struct point2f));
-	p->x = x; 
-	p->y = y;
-	dots.push_back(p);
+	/* outgrown buffers are left to the arena */
+	if(count == capacity) {
+		int grown = capacity ? 2 * capacity : DOTS_INITIAL;
+		struct point2f* p = (struct point2f*) arena->allocate(grown * sizeof(struct point2f));
+		if(p == NULL) return;
+		if(count > 0) {
+			memcpy(p, points, count * sizeof(struct point2f));
+		}
+		points = p;
+		capacity = grown;
+	}
+
+	points[count].x = x;
+	points[count].y = y;
+	count++;
+
+	struct rect2f r = { x, y, x, y };
+	box = unite(box, r);
+}
+
+void Dots::smooth(GLfloat tolerance, GLfloat maxLength, GLfloat spacing) {
+	count = Stroke::simplify(points, count, tolerance, maxLength);
+
+	std::vector< struct point2f > resampled;
+	Stroke::resample(points, count, spacing, resampled);
+	count = 0;
+	box = emptyRect();
+	for(size_t i = 0; i < resampled.size(); i++) {
+		addPoint(resampled[i].x, resampled[i].y);
+	}
 }
 
 void Dots::paint() {
 	glColor4f(getColor().r, getColor().g, getColor().b, getColor().a);
 	glPointSize(getPointSize());
 
-	std::vector< struct point2f* >::const_iterator itr = dots.begin();
-	glBegin(GL_POINTS);
-		while(itr != dots.end()) {
-			glVertex2f((*itr)->x, (*itr)->y);
-			itr++;
-		}
-	glEnd();
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, points);
+	glDrawArrays(GL_POINTS, 0, count);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+struct rect2f Dots::getBounds(GLfloat pixelSize) {
+	// half a point to either side, and a pixel for rounding
+	return grow(box, (getPointSize() / 2.0f + 1.0f) * pixelSize);
+}
+
+void Dots::rasterize(Raster* raster) {
+	raster->setColor(getColor());
+
+	for(int i = 0; i < count; i++) {
+		raster->point(points[i], getPointSize());
+	}
+}
+
+void Dots::write(DocumentWriter* writer) {
+	writer->addDots(this, points, count, box);
 }
@@ -0,0 +1,69 @@
+#include <math.h>
+
+#include <algorithm>
+
+#include "Grid.h"
+
+Grid::Grid(struct rect2f world) {
+	this->world = world;
+}
+
+void Grid::cellRange(struct rect2f box, int* c0, int* r0, int* c1, int* r1) {
+	const GLfloat cw = (world.x1 - world.x0) / GRID_COLUMNS, ch = (world.y1 - world.y0) / GRID_ROWS;
+	*c0 = (int) floorf((box.x0 - world.x0) / cw);
+	*r0 = (int) floorf((box.y0 - world.y0) / ch);
+	*c1 = (int) floorf((box.x1 - world.x0) / cw);
+	*r1 = (int) floorf((box.y1 - world.y0) / ch);
+
+	*c0 = MIN(MAX(*c0, 0), GRID_COLUMNS - 1);
+	*r0 = MIN(MAX(*r0, 0), GRID_ROWS - 1);
+	*c1 = MIN(MAX(*c1, 0), GRID_COLUMNS - 1);
+	*r1 = MIN(MAX(*r1, 0), GRID_ROWS - 1);
+}
+
+void Grid::insert(Paintable* p, struct rect2f bounds) {
+	if(isEmpty(bounds)) return;
+
+	struct entry e = { p, bounds };
+	const int index = (int) entries.size();
+	entries.push_back(e);
+
+	int c0, r0, c1, r1;
+	cellRange(bounds, &c0, &r0, &c1, &r1);
+	for(int r = r0; r <= r1; r++) {
+		for(int c = c0; c <= c1; c++) {
+			cells[r * GRID_COLUMNS + c].push_back(index);
+		}
+	}
+}
+
+void Grid::clear() {
+	entries.clear();
+	for(int i = 0; i < GRID_COLUMNS * GRID_ROWS; i++) {
+		cells[i].clear();
+	}
+}
+
+void Grid::query(struct rect2f box, std::vector< Paintable* >& out) {
+	out.clear();
+	if(isEmpty(box)) return;
+
+	found.clear();
+	int c0, r0, c1, r1;
+	cellRange(box, &c0, &r0, &c1, &r1);
+	for(int r = r0; r <= r1; r++) {
+		for(int c = c0; c <= c1; c++) {
+			const std::vector< int >& cell = cells[r * GRID_COLUMNS + c];
+			for(size_t i = 0; i < cell.size(); i++) {
+				if(overlaps(entries[cell[i]].bounds, box)) found.push_back(cell[i]);
+			}
+		}
+	}
+
+	// entries spanning several cells were found once per cell
+	std::sort(found.begin(), found.end());
+	found.erase(std::unique(found.begin(), found.end()), found.end());
+	for(size_t i = 0; i < found.size(); i++) {
+		out.push_back(entries[found[i]].paintable);
+	}
+}
@@ -0,0 +1,81 @@
+#include <stdlib.h>
+
+#include "History.h"
+
+History::History() {
+	cursor = first = live = 0;
+}
+
+History::~History() {
+	reset();
+}
+
+void History::fork() {
+	for(size_t i = cursor; i < log.size(); i++) {
+		if(log[i].paintable != NULL) {
+			delete log[i].paintable;
+			live--;
+		}
+	}
+	log.resize(cursor);
+}
+
+int History::create(Paintable* p) {
+	fork();
+
+	struct command c = { false, p, 0 };
+	log.push_back(c);
+	live++;
+	return cursor++;
+}
+
+void History::clear() {
+	fork();
+
+	struct command c = { true, NULL, first };
+	log.push_back(c);
+	first = ++cursor;
+}
+
+const struct History::command* History::undo() {
+	if(cursor == 0) return NULL;
+
+	const struct command* c = &log[--cursor];
+	if(c->clear) {
+		first = c->first;
+	}
+	return c;
+}
+
+const struct History::command* History::redo() {
+	if(cursor == (int) log.size()) return NULL;
+
+	const struct command* c = &log[cursor++];
+	if(c->clear) {
+		first = cursor;
+	}
+	return c;
+}
+
+void History::forget(int id) {
+	if(log[id].paintable != NULL) {
+		delete log[id].paintable;
+		log[id].paintable = NULL;
+		live--;
+	}
+}
+
+void History::drop() {
+	log.clear();
+	cursor = first = live = 0;
+}
+
+void History::reset() {
+	for(size_t i = 0; i < log.size(); i++) {
+		if(log[i].paintable != NULL) {
+			delete log[i].paintable;
+		}
+	}
+	log.clear();
+	cursor = first = live = 0;
+}
@@ -0,0 +1,59 @@
+#include "InputQueue.h"
+
+InputQueue::InputQueue() {
+	head = tail = 0;
+}
+
+bool InputQueue::push(enum kind kind, struct point2f p, double time) {
+	// the consumer frees slots by advancing tail after reading them
+	const unsigned int t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+	if(head - t == INPUT_QUEUE_SIZE) return false;
+
+	struct event& e = events[head & (INPUT_QUEUE_SIZE - 1)];
+	e.kind = kind;
+	e.p = p;
+	e.time = time;
+
+	// publish the event only once it is written
+	__atomic_store_n(&head, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+void InputQueue::drag(Tool* tool, struct inputBatch& batch) {
+	if(moves.empty()) return;
+
+	tool->mouseDrag(&moves[0], (int) moves.size());
+	batch.updates++;
+	moves.clear();
+}
+
+struct inputBatch InputQueue::dispatch(Tool* tool) {
+	struct inputBatch batch = { 0, 0, 0.0, 0.0 };
+
+	const unsigned int h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+	for(; tail != h; __atomic_store_n(&tail, tail + 1, __ATOMIC_RELEASE)) {
+		const struct event e = events[tail & (INPUT_QUEUE_SIZE - 1)];
+		if(batch.events++ == 0) {
+			batch.first = e.time;
+		}
+		batch.arrivals += e.time;
+
+		if(e.kind == MOVE) {
+			moves.push_back(e.p);
+			continue;
+		}
+
+		// a click ends the moves before it
+		drag(tool, batch);
+		if(e.kind == DOWN) {
+			tool->mouseDown(e.p);
+			batch.updates++;
+		} else if(tool->isMouseCurrentlyDown()) {
+			tool->mouseUp(e.p);
+			batch.updates++;
+		}
+	}
+	drag(tool, batch);
+
+	return batch;
+}
@@ -1,5 +1,6 @@
 #include <stdio.h>
 
+#include "Document.h"
 #include "Line.h"
 
 Line::Line() : Paintable() {
@@ -15,3 +16,20 @@ void Line::paint() {
 		glVertex2f(end.x, end.y);
 	glEnd();
 }
+
+struct rect2f Line::getBounds(GLfloat pixelSize) {
+	struct rect2f r = {
+		MIN(start.x, end.x), MIN(start.y, end.y), MAX(start.x, end.x), MAX(start.y, end.y)
+	};
+	// half the width to either side, and a pixel for rounding
+	return grow(r, (getLineWidth() / 2.0f + 1.0f) * pixelSize);
+}
+
+void Line::rasterize(Raster* raster) {
+	raster->setColor(getColor());
+	raster->line(start, end, getLineWidth());
+}
+
+void Line::write(DocumentWriter* writer) {
+	writer->addShape(this, Document::LINE, start, end);
+}
@@ -1,12 +1,13 @@
 #include "LineTool.h"
 
-LineTool::LineTool() {
+LineTool::LineTool(Pool* pool) {
 	line = NULL;
+	this->pool = pool;
 }
 
 void LineTool::mouseDown(struct point2f p) {
 	Tool::mouseDown(p);
-	line = new Line();
+	line = new (pool) Line();
 	line->setColor(getColor());
 	line->setLineWidth(getLineWidth());
 	line->setStart(p);
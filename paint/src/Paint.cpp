@@ -1,6 +1,7 @@
 #include <iostream>
 
 #include <stdio.h>
+#include <time.h>
 
 #include <glut.h>
 
@@ -10,6 +11,12 @@
 #include "RectangleTool.h"
 #include "Paint.h"
 
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
 Paint::Paint() {
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_ALPHA);
     glutInitWindowSize(WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
@@ -17,10 +24,17 @@ Paint::Paint() {
     glutCreateWindow(WINDOW_TITLE_BASE);
 
 	canvas = new Canvas();
-	currentTool = new DotTool(true);
+	currentTool = new DotTool(true, canvas->getArena(), canvas->getDotsPool());
 	currentTool->addToolListener(this);
 
     glViewport(0, 0, WINDOW_INIT_WIDTH, WINDOW_INIT_HEIGHT);
+	Tool::setPixelSize(MAX(WORLD_X1 / WINDOW_INIT_WIDTH, WORLD_Y1 / WINDOW_INIT_HEIGHT));
+
+	struct inputBatch none = { 0, 0, 0.0, 0.0 };
+	undrawn = none;
+	changed = false;
+	struct inputStats zero = { now(), 0, 0, 0, 0.0, 0.0 };
+	stats = zero;
 }
 
 Paint::~Paint() {
@@ -28,26 +42,89 @@ Paint::~Paint() {
 }
 
 void Paint::drawScene() {
-	glClear(GL_COLOR_BUFFER_BIT);
     canvas->drawScene();
 	glutSwapBuffers();
+
+	const double drawn = now();
+	stats.frames++;
+	stats.events += undrawn.events;
+	stats.updates += undrawn.updates;
+	if(undrawn.events > 0) {
+		stats.latency += undrawn.events * drawn - undrawn.arrivals;
+		stats.worst = MAX(stats.worst, drawn - undrawn.first);
+	}
+	undrawn.events = undrawn.updates = 0;
+	undrawn.arrivals = 0.0;
+}
+
+void Paint::queueInput(enum InputQueue::kind kind, int x, int y) {
+	const struct point2f p = pointFromViewXY(x, y);
+	if(!input.push(kind, p, now())) {
+		// too much for one tick, let the tool have it now
+		dispatchInput();
+		input.push(kind, p, now());
+	}
+}
+
+void Paint::dispatchInput() {
+	if(currentTool == NULL) return;
+
+	changed = false;
+	const struct inputBatch batch = input.dispatch(currentTool);
+
+	// events the tool made nothing of wait for no frame
+	if(changed) {
+		if(undrawn.events == 0) {
+			undrawn.first = batch.first;
+		}
+		undrawn.events += batch.events;
+		undrawn.updates += batch.updates;
+		undrawn.arrivals += batch.arrivals;
+	}
+}
+
+void Paint::reportInput() {
+	const double elapsed = now() - stats.since;
+	printf("[paint] %.1f frames/s, %d mouse events in %d tool updates, latency %.2f ms average, "
+		"%.2f ms worst\n", elapsed > 0.0 ? stats.frames / elapsed : 0.0, stats.events,
+		stats.updates, stats.events ? stats.latency * 1e3 / stats.events : 0.0, stats.worst * 1e3);
+
+	struct inputStats zero = { now(), 0, 0, 0, 0.0, 0.0 };
+	stats = zero;
 }
 
 void Paint::handleKeypress(unsigned char key, int x, int y) {
 	switch(key) {
 		case 0x1B: exit(0);
+		case 'c': handleMenu(COMPOSE); break;
+		case 's': handleMenu(SMOOTH); break;
+		case 'l': handleMenu(LAYER); break;
+		case 'e': handleMenu(EXPORT); break;
+		case 'w': handleMenu(SAVE); break;
+		case 'i': reportInput(); break;
+		case 'n': handleMenu(NEW); break;
+		case 'o': handleMenu(OPEN); break;
+		case 'u': case 0x1A: handleMenu(UNDO); break;
+		case 'r': case 0x19: handleMenu(REDO); break;
 		default:
 			printf("[paint] Unknown keypress 0x%X '%c' @ (%d, %d)\n", key, key, x, y);
 	}
 }
 
 void Paint::handleMenu(int choice) {
+	// what the mouse did before the choice goes to the tool it was done with
+	dispatchInput();
+
 	switch(choice) {
-		case POINT:       switchTool(new DotTool(true));        break;
-		case SCRIBBLE:    switchTool(new DotTool(false));       break;
-		case LINE:        switchTool(new LineTool());           break;
-		case RECT_FILL:   switchTool(new RectangleTool(true));  break;
-		case RECT_NOFILL: switchTool(new RectangleTool(false)); break;
+		case POINT:
+			switchTool(new DotTool(true, canvas->getArena(), canvas->getDotsPool()));
+			break;
+		case SCRIBBLE:
+			switchTool(new DotTool(false, canvas->getArena(), canvas->getDotsPool()));
+			break;
+		case LINE:        switchTool(new LineTool(canvas->getLinePool()));             break;
+		case RECT_FILL:   switchTool(new RectangleTool(true, canvas->getRectanglePool()));  break;
+		case RECT_NOFILL: switchTool(new RectangleTool(false, canvas->getRectanglePool())); break;
 
 		case WHITE:  Tool::setColor(           1.0f,            1.0f,            1.0f); break;
 		case BLACK:  Tool::setColor(           0.0f,            0.0f,            0.0f); break;
@@ -71,8 +148,67 @@ void Paint::handleMenu(int choice) {
 
 		case FADE: canvas->enableFade(!canvas->isFading()); break;
 
+		case SMOOTH:
+			Tool::setSmoothing(!Tool::isSmoothing());
+			printf("[paint] Scribble smoothing %s\n", Tool::isSmoothing() ? "on" : "off");
+			break;
+
+		case COMPOSE:
+			canvas->enableComposition(!canvas->isComposing());
+			printf("[paint] Drawing with %s\n", canvas->isComposing() ? "the CPU compositor" : "GL");
+			glutPostRedisplay();
+			break;
+
+		case LAYER:
+			canvas->enableLayer(!canvas->isLayering());
+			printf("[paint] Raster layer %s\n", canvas->isLayering() ? "on" : "off");
+			break;
+
+		case EXPORT:
+			if(canvas->exportPPM(EXPORT_PATH)) {
+				printf("[paint] Exported the canvas to %s\n", EXPORT_PATH);
+			} else {
+				printf("[paint] {{WARN}} Unable to export the canvas to %s\n", EXPORT_PATH);
+			}
+			break;
+
+		case SAVE:
+			if(canvas->save(DOCUMENT_PATH)) {
+				printf("[paint] Saved the canvas to %s\n", DOCUMENT_PATH);
+			} else {
+				printf("[paint] {{WARN}} Unable to save the canvas to %s\n", DOCUMENT_PATH);
+			}
+			break;
+
+		case OPEN:
+			if(canvas->load(DOCUMENT_PATH)) {
+				printf("[paint] Opened %s\n", DOCUMENT_PATH);
+			} else {
+				printf("[paint] {{WARN}} Unable to open %s\n", DOCUMENT_PATH);
+			}
+			break;
+
+		case UNDO:
+			if(!canvas->undo()) {
+				printf("[paint] Nothing to undo\n");
+			}
+			glutPostRedisplay();
+			break;
+
+		case REDO:
+			if(!canvas->redo()) {
+				printf("[paint] Nothing to redo\n");
+			}
+			glutPostRedisplay();
+			break;
+
 		case CLEAR: canvas->clear(); break;
 
+		case NEW:
+			canvas->reset();
+			printf("[paint] Started a new canvas, which can not be undone\n");
+			break;
+
 		case QUIT: exit(0);
 
 		default:
@@ -92,32 +228,28 @@ void Paint::handleMouseClick(int buttonNum, int state, int x, int y) {
 	// we only care about the first button
 	if(buttonNum != 0) return;
 
-	// pass on the click to the current tool
+	// pass on the click to the current tool, on the next frame
 	switch(state) {
-		case GLUT_DOWN:
-			if(currentTool != NULL) {
-				currentTool->mouseDown(pointFromViewXY(x, y));
-			}
-			break;
-		case GLUT_UP:
-			if(currentTool != NULL && currentTool->isMouseCurrentlyDown()) {
-				currentTool->mouseUp(pointFromViewXY(x, y));
-			}
-			break;
+		case GLUT_DOWN: queueInput(InputQueue::DOWN, x, y); break;
+		case GLUT_UP:   queueInput(InputQueue::UP, x, y);   break;
 	}
 }
 
 void Paint::handleMouseMotion(int x, int y) {
-	if(currentTool != NULL) {
-		currentTool->mouseMove(pointFromViewXY(x, y));
-	}
+	queueInput(InputQueue::MOVE, x, y);
 }
 
 void Paint::handleResize(int w, int h) {
     glViewport(0, 0, w, h);
+	if(w > 0 && h > 0) {
+		Tool::setPixelSize(MAX(WORLD_X1 / w, WORLD_Y1 / h));
+	}
+	canvas->invalidate();
 }
 
 void Paint::handleTimer(int val) {
+	// the tool catches up with the mouse once a tick, however often it moved
+	dispatchInput();
 	canvas->tick();
 }
 
@@ -137,11 +269,13 @@ void Paint::loop() {
 
 void Paint::intermediatePaintableCreated(Paintable* p) {
 	canvas->setActivePaintable(p);
+	changed = true;
 	glutPostRedisplay();
 }
 
 void Paint::finalPaintableCreated(Paintable* p) {
 	canvas->setActivePaintable(NULL);
 	canvas->addPaintable(p);
+	changed = true;
 	glutPostRedisplay();
 }
@@ -0,0 +1,67 @@
+#include <stdlib.h>
+
+#include "Pool.h"
+
+/* alignment of every object */
+#define POOL_ALIGN 16
+
+/* where a slab's objects start, past its header */
+#define SLAB_HEADER ((sizeof(struct slab) + POOL_ALIGN - 1) & ~(size_t) (POOL_ALIGN - 1))
+
+Pool::Pool(size_t size) {
+	// every object has to be able to hold the free list's link
+	if(size < sizeof(void*)) size = sizeof(void*);
+	this->size = (size + POOL_ALIGN - 1) & ~(size_t) (POOL_ALIGN - 1);
+
+	current = NULL;
+	freed = NULL;
+	live = slabs = 0;
+}
+
+Pool::~Pool() {
+	while(current != NULL) {
+		struct slab* s = current;
+		current = s->next;
+		free(s);
+	}
+}
+
+void* Pool::allocate() {
+	void* p = freed;
+	if(p != NULL) {
+		freed = *(void**) p;
+	} else {
+		if(current == NULL || current->top == SLAB_HEADER + POOL_SLAB_OBJECTS * size) {
+			struct slab* s = (struct slab*) malloc(SLAB_HEADER + POOL_SLAB_OBJECTS * size);
+			if(s == NULL) return NULL;
+			s->next = current;
+			s->top = SLAB_HEADER;
+			current = s;
+			slabs++;
+		}
+		p = (char*) current + current->top;
+		current->top += size;
+	}
+	live++;
+	return p;
+}
+
+void Pool::release(void* p) {
+	*(void**) p = freed;
+	freed = p;
+	live--;
+}
+
+void Pool::reset() {
+	freed = NULL;
+	live = 0;
+	if(current == NULL) return;
+
+	/* keep the newest slab for what comes next */
+	while(current->next != NULL) {
+		struct slab* s = current->next;
+		current->next = s->next;
+		free(s);
+	}
+	current->top = SLAB_HEADER;
+}
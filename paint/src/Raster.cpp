@@ -0,0 +1,312 @@
+#include <math.h>
+#include <stdint.h>
+
+#include "Raster.h"
+
+/* window coordinates snap to this many steps per pixel */
+#define SUBPIXEL 256
+
+/* most vertices a triangle can have after clipping against six planes */
+#define CLIP_MAX 9
+
+/*
+ * everything below repeats GL's arithmetic operation for operation, in the same order, so
+ * that ties at pixel centers are broken the same way
+ */
+
+static int64_t floorDiv(int64_t a, int64_t b) {
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+static GLfloat snap(GLfloat v) {
+	return floorf(v * SUBPIXEL + 0.5f) / SUBPIXEL;
+}
+
+/** signed distance of v to clip plane p, inside when >= 0 */
+static GLfloat planeDistance(const GLfloat* v, int p) {
+	switch(p) {
+		case 0: return v[3] + v[0];
+		case 1: return v[3] - v[0];
+		case 2: return v[3] + v[1];
+		case 3: return v[3] - v[1];
+		case 4: return v[3] + v[2];
+		default: return v[3] - v[2];
+	}
+}
+
+static void lerp(GLfloat* r, const GLfloat* a, const GLfloat* b, GLfloat t) {
+	for(int k = 0; k < 4; k++) {
+		r[k] = a[k] + (b[k] - a[k]) * t;
+	}
+}
+
+static bool inside(const GLfloat* v) {
+	return v[0] >= -v[3] && v[0] <= v[3] && v[1] >= -v[3] && v[1] <= v[3] &&
+		v[2] >= -v[3] && v[2] <= v[3];
+}
+
+Raster::Raster() {
+	for(int i = 0; i < 16; i++) mvp[i] = i % 5 == 0 ? 1.0f : 0.0f;
+	viewport[0] = viewport[1] = viewport[2] = viewport[3] = 0;
+}
+
+void Raster::reset() {
+	GLfloat projection[16], modelview[16];
+	glGetFloatv(GL_PROJECTION_MATRIX, projection);
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	for(int c = 0; c < 4; c++) {
+		for(int row = 0; row < 4; row++) {
+			mvp[c * 4 + row] = projection[row] * modelview[c * 4] + projection[4 + row] * modelview[c * 4 + 1] +
+				projection[8 + row] * modelview[c * 4 + 2] + projection[12 + row] * modelview[c * 4 + 3];
+		}
+	}
+
+	fills.clear();
+	colors.clear();
+}
+
+void Raster::setColor(struct color4f color) {
+	colors.push_back(color);
+}
+
+struct Raster::vertex Raster::transform(struct point2f p) {
+	const GLfloat* m = mvp;
+	struct vertex v;
+	v.x = m[0] * p.x + m[4] * p.y + m[8] * 0.0f + m[12] * 1.0f;
+	v.y = m[1] * p.x + m[5] * p.y + m[9] * 0.0f + m[13] * 1.0f;
+	v.z = m[2] * p.x + m[6] * p.y + m[10] * 0.0f + m[14] * 1.0f;
+	v.w = m[3] * p.x + m[7] * p.y + m[11] * 0.0f + m[15] * 1.0f;
+	return v;
+}
+
+void Raster::project(const struct vertex& v, GLfloat* x, GLfloat* y) {
+	const GLfloat q = 1.0f / v.w;
+	*x = snap(viewport[0] + (v.x * q + 1.0f) * 0.5f * viewport[2]);
+	*y = snap(viewport[1] + (v.y * q + 1.0f) * 0.5f * viewport[3]);
+}
+
+void Raster::emit(int x0, int y0, int x1, int y1) {
+	x0 = MAX(x0, viewport[0]) - viewport[0];
+	y0 = MAX(y0, viewport[1]) - viewport[1];
+	x1 = MIN(x1, viewport[0] + viewport[2]) - viewport[0];
+	y1 = MIN(y1, viewport[1] + viewport[3]) - viewport[1];
+	if(x0 >= x1 || y0 >= y1 || colors.empty()) return;
+
+	struct fill f = { x0, y0, x1, y1, (int) colors.size() - 1 };
+	fills.push_back(f);
+}
+
+void Raster::point(struct point2f p, GLfloat size) {
+	struct vertex v = transform(p);
+	if(!inside(&v.x)) return;
+
+	GLfloat x, y;
+	project(v, &x, &y);
+
+	int s = (int) (size + 0.5f);
+	if(s < 1) s = 1;
+
+	int x0, y0;
+	if(s & 1) {
+		x0 = (int) floorf(x) - (s - 1) / 2;
+		y0 = (int) floorf(y) - (s - 1) / 2;
+	} else {
+		x0 = (int) floorf(x + 0.5f) - s / 2;
+		y0 = (int) floorf(y + 0.5f) - s / 2;
+	}
+	emit(x0, y0, x0 + s, y0 + s);
+}
+
+void Raster::line(struct point2f pa, struct point2f pb, GLfloat width) {
+	struct vertex a = transform(pa), b = transform(pb);
+
+	/* Liang-Barsky against the six clip planes */
+	GLfloat t0 = 0.0f, t1 = 1.0f;
+	for(int p = 0; p < 6; p++) {
+		const GLfloat da = planeDistance(&a.x, p), db = planeDistance(&b.x, p);
+		if(da < 0.0f && db < 0.0f) return;
+		if(da < 0.0f) {
+			const GLfloat t = da / (da - db);
+			if(t > t0) t0 = t;
+		} else if(db < 0.0f) {
+			const GLfloat t = da / (da - db);
+			if(t < t1) t1 = t;
+		}
+	}
+	if(t0 > t1) return;
+
+	struct vertex ca, cb;
+	lerp(&ca.x, &a.x, &b.x, t0);
+	lerp(&cb.x, &a.x, &b.x, t1);
+	GLfloat x0, y0, x1, y1;
+	project(ca, &x0, &y0);
+	project(cb, &x1, &y1);
+
+	int w = (int) (width + 0.5f);
+	if(w < 1) w = 1;
+
+	/* step along the major axis, one pixel per column (or row) */
+	const GLfloat dx = x1 - x0, dy = y1 - y0;
+	const bool xMajor = fabsf(dx) >= fabsf(dy);
+	const GLfloat major0 = xMajor ? x0 : y0, major1 = xMajor ? x1 : y1;
+	const GLfloat minor0 = xMajor ? y0 : x0, minor1 = xMajor ? y1 : x1;
+	const int step = major1 >= major0 ? 1 : -1;
+
+	/* the pixels whose centers lie in [major0, major1) */
+	const int first = step > 0 ? (int) ceilf(major0 - 0.5f) : (int) floorf(major0 - 0.5f);
+	const int last = step > 0 ? (int) ceilf(major1 - 0.5f) : (int) floorf(major1 - 0.5f);
+
+	/* neighbouring columns at the same offset merge into one fill */
+	int runStart = first, runEnd = first, runMinor = 0;
+	for(int m = first; m != last; m += step) {
+		GLfloat t = (m + 0.5f - major0) / (major1 - major0);
+		if(t < 0.0f) t = 0.0f;
+		if(t > 1.0f) t = 1.0f;
+		const GLfloat minor = minor0 + (minor1 - minor0) * t;
+		const int n0 = (int) floorf(minor - (w - 1) / 2.0f);
+
+		if(m != first && n0 != runMinor) {
+			const int lo = MIN(runStart, runEnd), hi = MAX(runStart, runEnd) + 1;
+			if(xMajor) emit(lo, runMinor, hi, runMinor + w);
+			else emit(runMinor, lo, runMinor + w, hi);
+			runStart = m;
+		}
+		runEnd = m;
+		runMinor = n0;
+	}
+	if(first != last) {
+		const int lo = MIN(runStart, runEnd), hi = MAX(runStart, runEnd) + 1;
+		if(xMajor) emit(lo, runMinor, hi, runMinor + w);
+		else emit(runMinor, lo, runMinor + w, hi);
+	}
+}
+
+void Raster::polygon(const struct point2f* p, int n) {
+	if(n < 3) return;
+
+	/*
+	 * an axis aligned rectangle in front of the camera is a single fill.  clipping only
+	 * moves its edges to the window border, so the unclipped corners say the same thing
+	 */
+	if(n == 4) {
+		GLfloat x[4], y[4];
+		bool visible = true;
+		for(int i = 0; i < 4; i++) {
+			struct vertex v = transform(p[i]);
+			visible = visible && v.w > 0.0f && v.z >= -v.w && v.z <= v.w;
+			project(v, &x[i], &y[i]);
+		}
+		const bool aligned = (x[0] == x[1] && y[1] == y[2] && x[2] == x[3] && y[3] == y[0]) ||
+			(y[0] == y[1] && x[1] == x[2] && y[2] == y[3] && x[3] == x[0]);
+		if(visible && aligned) {
+			const int64_t xa = (int64_t) (MIN(x[0], x[2]) * SUBPIXEL), xb = (int64_t) (MAX(x[0], x[2]) * SUBPIXEL);
+			const int64_t ya = (int64_t) (MIN(y[0], y[2]) * SUBPIXEL), yb = (int64_t) (MAX(y[0], y[2]) * SUBPIXEL);
+			if(xa == xb || ya == yb) return;
+
+			/* pixel centers on the left and top edges are in, on the right and bottom out */
+			emit((int) -floorDiv(SUBPIXEL / 2 - xa, SUBPIXEL), (int) floorDiv(ya - SUBPIXEL / 2, SUBPIXEL) + 1,
+				(int) -floorDiv(SUBPIXEL / 2 - xb, SUBPIXEL), (int) floorDiv(yb - SUBPIXEL / 2, SUBPIXEL) + 1);
+			return;
+		}
+	}
+
+	/* otherwise a fan of triangles, each clipped on its own */
+	for(int i = 1; i + 1 < n; i++) {
+		struct vertex tri[3] = { transform(p[0]), transform(p[i]), transform(p[i + 1]) };
+		GLfloat buf[2][CLIP_MAX][4];
+		for(int k = 0; k < 3; k++) {
+			buf[0][k][0] = tri[k].x;
+			buf[0][k][1] = tri[k].y;
+			buf[0][k][2] = tri[k].z;
+			buf[0][k][3] = tri[k].w;
+		}
+
+		/* Sutherland-Hodgman against each clip plane in turn */
+		int count = 3, cur = 0;
+		for(int plane = 0; plane < 6 && count > 0; plane++) {
+			GLfloat (*in)[4] = buf[cur];
+			GLfloat (*out)[4] = buf[!cur];
+			int m = 0;
+			for(int k = 0; k < count; k++) {
+				const GLfloat* u = in[k];
+				const GLfloat* v = in[(k + 1) % count];
+				const GLfloat du = planeDistance(u, plane), dv = planeDistance(v, plane);
+				if(du >= 0.0f) {
+					for(int j = 0; j < 4; j++) out[m][j] = u[j];
+					m++;
+				}
+				if((du >= 0.0f) != (dv >= 0.0f) && m < CLIP_MAX) {
+					if(du >= 0.0f) lerp(out[m++], u, v, du / (du - dv));
+					else lerp(out[m++], v, u, dv / (dv - du));
+				}
+			}
+			count = m;
+			cur = !cur;
+		}
+		if(count < 3) continue;
+
+		GLfloat x[CLIP_MAX], y[CLIP_MAX];
+		for(int k = 0; k < count; k++) {
+			struct vertex v = { buf[cur][k][0], buf[cur][k][1], buf[cur][k][2], buf[cur][k][3] };
+			project(v, &x[k], &y[k]);
+		}
+		for(int k = 1; k + 1 < count; k++) {
+			const GLfloat tx[3] = { x[0], x[k], x[k + 1] };
+			const GLfloat ty[3] = { y[0], y[k], y[k + 1] };
+			triangle(tx, ty);
+		}
+	}
+}
+
+/** the top-left rule: pixel centers exactly on an edge belong to top and left edges */
+static bool topLeft(int64_t ax, int64_t ay, int64_t bx, int64_t by) {
+	return by < ay || (by == ay && bx < ax);
+}
+
+void Raster::triangle(const GLfloat* x, const GLfloat* y) {
+	int64_t x0 = (int64_t) (x[0] * SUBPIXEL), y0 = (int64_t) (y[0] * SUBPIXEL);
+	int64_t x1 = (int64_t) (x[1] * SUBPIXEL), y1 = (int64_t) (y[1] * SUBPIXEL);
+	int64_t x2 = (int64_t) (x[2] * SUBPIXEL), y2 = (int64_t) (y[2] * SUBPIXEL);
+
+	const int64_t area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+	if(area == 0) return;
+	if(area < 0) {
+		int64_t tx = x1, ty = y1;
+		x1 = x2;
+		y1 = y2;
+		x2 = tx;
+		y2 = ty;
+	}
+
+	const int left = MAX((int) floorf(MIN(x[0], MIN(x[1], x[2]))), viewport[0]);
+	const int right = MIN((int) ceilf(MAX(x[0], MAX(x[1], x[2]))), viewport[0] + viewport[2]);
+	const int bottom = MAX((int) floorf(MIN(y[0], MIN(y[1], y[2]))), viewport[1]);
+	const int top = MIN((int) ceilf(MAX(y[0], MAX(y[1], y[2]))), viewport[1] + viewport[3]);
+
+	const bool tl0 = topLeft(x1, y1, x2, y2), tl1 = topLeft(x2, y2, x0, y0), tl2 = topLeft(x0, y0, x1, y1);
+
+	/* a triangle crosses each row in one run */
+	for(int row = bottom; row < top; row++) {
+		const int64_t py = (int64_t) row * SUBPIXEL + SUBPIXEL / 2;
+		int runStart = -1;
+		for(int col = left; col <= right; col++) {
+			bool covered = false;
+			if(col < right) {
+				const int64_t px = (int64_t) col * SUBPIXEL + SUBPIXEL / 2;
+				const int64_t e0 = (x2 - x1) * (py - y1) - (y2 - y1) * (px - x1);
+				const int64_t e1 = (x0 - x2) * (py - y2) - (y0 - y2) * (px - x2);
+				const int64_t e2 = (x1 - x0) * (py - y0) - (y1 - y0) * (px - x0);
+				covered = e0 >= 0 && e1 >= 0 && e2 >= 0 &&
+					(e0 != 0 || tl0) && (e1 != 0 || tl1) && (e2 != 0 || tl2);
+			}
+			if(covered && runStart < 0) {
+				runStart = col;
+			} else if(!covered && runStart >= 0) {
+				emit(runStart, row, col, row + 1);
+				break;
+			}
+		}
+	}
+}
@@ -1,5 +1,6 @@
 #include "structs.h"
 
+#include "Document.h"
 #include "Rectangle.h"
 
 Rectangle::Rectangle(bool filled) : Paintable() {
@@ -29,10 +30,10 @@ void Rectangle::paint() {
 	if(!filled) {
 		glLineWidth(1.0f);
 		float delta = getLineWidth() / 2.0f;
-		float xMin = min(start.x, end.x);
-		float xMax = max(start.x, end.x);
-		float yMin = min(start.y, end.y);
-		float yMax = max(start.y, end.y);
+		float xMin = MIN(start.x, end.x);
+		float xMax = MAX(start.x, end.x);
+		float yMin = MIN(start.y, end.y);
+		float yMax = MAX(start.y, end.y);
 		glBegin(GL_POLYGON);
 			glVertex2f(xMin, yMin);
 			glVertex2f(xMin - delta, yMin);
@@ -55,3 +56,51 @@ void Rectangle::paint() {
 		glEnd();
 	}
 }
+
+struct rect2f Rectangle::getBounds(GLfloat pixelSize) {
+	struct rect2f r = {
+		MIN(start.x, end.x), MIN(start.y, end.y), MAX(start.x, end.x), MAX(start.y, end.y)
+	};
+	if(filled) {
+		return grow(r, pixelSize);
+	}
+
+	// the outline and the bevels reach out by half the width, in pixels and in world units
+	return grow(r, getLineWidth() / 2.0f + (getLineWidth() / 2.0f + 1.0f) * pixelSize);
+}
+
+void Rectangle::rasterize(Raster* raster) {
+	raster->setColor(getColor());
+
+	struct point2f corners[4] = {
+		{ start.x, start.y }, { start.x, end.y }, { end.x, end.y }, { end.x, start.y }
+	};
+	if(filled) {
+		raster->polygon(corners, 4);
+		return;
+	}
+
+	for(int i = 0; i < 4; i++) {
+		raster->line(corners[i], corners[(i + 1) % 4], getLineWidth());
+	}
+
+	/* the bevels, as paint() draws them */
+	float delta = getLineWidth() / 2.0f;
+	float xMin = MIN(start.x, end.x);
+	float xMax = MAX(start.x, end.x);
+	float yMin = MIN(start.y, end.y);
+	float yMax = MAX(start.y, end.y);
+	struct point2f bevels[4][3] = {
+		{ { xMin, yMin }, { xMin - delta, yMin }, { xMin, yMin - delta } },
+		{ { xMin, yMax }, { xMin - delta, yMax }, { xMin, yMax + delta } },
+		{ { xMax, yMin }, { xMax + delta, yMin }, { xMax, yMin - delta } },
+		{ { xMax, yMax }, { xMax + delta, yMax }, { xMax, yMax + delta } }
+	};
+	for(int i = 0; i < 4; i++) {
+		raster->polygon(bevels[i], 3);
+	}
+}
+
+void Rectangle::write(DocumentWriter* writer) {
+	writer->addShape(this, filled ? Document::RECTANGLE_FILLED : Document::RECTANGLE, start, end);
+}
@@ -1,13 +1,14 @@
 #include "RectangleTool.h"
 
-RectangleTool::RectangleTool(bool filled) {
+RectangleTool::RectangleTool(bool filled, Pool* pool) {
 	rect = NULL;
 	this->filled = filled;
+	this->pool = pool;
 }
 
 void RectangleTool::mouseDown(struct point2f p) {
 	Tool::mouseDown(p);
-	rect = new Rectangle(filled);
+	rect = new (pool) Rectangle(filled);
 	rect->setColor(getColor());
 	rect->setLineWidth(getLineWidth());
 	rect->setStart(p);
@@ -0,0 +1,141 @@
+#include <math.h>
+
+#include "Stroke.h"
+
+/* curve steps per spacing when measuring the spline, more makes the spacing more even */
+#define RESAMPLE_STEPS 4
+
+Stroke::Stroke(GLfloat spacing) {
+	this->spacing = spacing;
+	started = false;
+}
+
+bool Stroke::accept(struct point2f p) {
+	if(started) {
+		const GLfloat dx = p.x - last.x, dy = p.y - last.y;
+		if(dx * dx + dy * dy < spacing * spacing) return false;
+	}
+	last = p;
+	started = true;
+	return true;
+}
+
+/** squared distance from p to the segment ab */
+static GLfloat segmentDistance2(struct point2f p, struct point2f a, struct point2f b) {
+	const GLfloat dx = b.x - a.x, dy = b.y - a.y;
+	const GLfloat length2 = dx * dx + dy * dy;
+	GLfloat t = 0.0f;
+	if(length2 > 0.0f) {
+		t = ((p.x - a.x) * dx + (p.y - a.y) * dy) / length2;
+		t = t < 0.0f ? 0.0f : t > 1.0f ? 1.0f : t;
+	}
+	const GLfloat ex = a.x + t * dx - p.x, ey = a.y + t * dy - p.y;
+	return ex * ex + ey * ey;
+}
+
+int Stroke::simplify(struct point2f* points, int n, GLfloat tolerance, GLfloat maxLength) {
+	if(n < 3) return n;
+
+	std::vector< bool > keep(n, false);
+	keep[0] = keep[n - 1] = true;
+
+	/* ranges still to split, as an explicit stack so long strokes cannot overflow the real one */
+	std::vector< std::pair< int, int > > ranges;
+	ranges.push_back(std::make_pair(0, n - 1));
+	while(!ranges.empty()) {
+		const int first = ranges.back().first, last = ranges.back().second;
+		ranges.pop_back();
+
+		GLfloat worst = tolerance * tolerance;
+		int split = -1;
+		for(int i = first + 1; i < last; i++) {
+			const GLfloat d = segmentDistance2(points[i], points[first], points[last]);
+			if(d > worst) {
+				worst = d;
+				split = i;
+			}
+		}
+		if(split < 0 && last - first > 1) {
+			const GLfloat dx = points[last].x - points[first].x, dy = points[last].y - points[first].y;
+			if(dx * dx + dy * dy > maxLength * maxLength) split = (first + last) / 2;
+		}
+		if(split >= 0) {
+			keep[split] = true;
+			ranges.push_back(std::make_pair(first, split));
+			ranges.push_back(std::make_pair(split, last));
+		}
+	}
+
+	int kept = 0;
+	for(int i = 0; i < n; i++) {
+		if(keep[i]) points[kept++] = points[i];
+	}
+	return kept;
+}
+
+/** knot spacing of the centripetal parameterization, kept off zero for repeated points */
+static GLfloat knot(struct point2f a, struct point2f b) {
+	return MAX(sqrtf(hypotf(b.x - a.x, b.y - a.y)), 1e-2f);
+}
+
+/**
+ * centripetal Catmull-Rom between p1 and p2, as a cubic Hermite.  unlike the uniform kind it
+ * does not loop or overshoot far at sharp corners
+ */
+static struct point2f catmullRom(struct point2f p0, struct point2f p1, struct point2f p2,
+		struct point2f p3, GLfloat t) {
+	const GLfloat d0 = knot(p0, p1), d1 = knot(p1, p2), d2 = knot(p2, p3);
+
+	/* tangents at p1 and p2, scaled to the segment */
+	const GLfloat m1x = d1 * ((p1.x - p0.x) / d0 - (p2.x - p0.x) / (d0 + d1) + (p2.x - p1.x) / d1);
+	const GLfloat m1y = d1 * ((p1.y - p0.y) / d0 - (p2.y - p0.y) / (d0 + d1) + (p2.y - p1.y) / d1);
+	const GLfloat m2x = d1 * ((p2.x - p1.x) / d1 - (p3.x - p1.x) / (d1 + d2) + (p3.x - p2.x) / d2);
+	const GLfloat m2y = d1 * ((p2.y - p1.y) / d1 - (p3.y - p1.y) / (d1 + d2) + (p3.y - p2.y) / d2);
+
+	const GLfloat t2 = t * t, t3 = t2 * t;
+	const GLfloat h00 = 2.0f * t3 - 3.0f * t2 + 1.0f, h10 = t3 - 2.0f * t2 + t;
+	const GLfloat h01 = 3.0f * t2 - 2.0f * t3, h11 = t3 - t2;
+	struct point2f r = {
+		h00 * p1.x + h10 * m1x + h01 * p2.x + h11 * m2x,
+		h00 * p1.y + h10 * m1y + h01 * p2.y + h11 * m2y
+	};
+	return r;
+}
+
+void Stroke::resample(const struct point2f* points, int n, GLfloat spacing,
+		std::vector< struct point2f >& out) {
+	out.clear();
+	if(n < 1) return;
+	out.push_back(points[0]);
+	if(n < 2 || spacing <= 0.0f) return;
+
+	/* walk the spline in short steps, dropping a sample every spacing of arc length */
+	struct point2f prev = points[0];
+	GLfloat travelled = 0.0f;
+	for(int i = 0; i + 1 < n; i++) {
+		const struct point2f p0 = points[i > 0 ? i - 1 : 0], p1 = points[i];
+		const struct point2f p2 = points[i + 1], p3 = points[i + 2 < n ? i + 2 : n - 1];
+		const GLfloat chord = hypotf(p2.x - p1.x, p2.y - p1.y);
+		const int steps = (int) ceilf(chord * RESAMPLE_STEPS / spacing) + 1;
+
+		for(int s = 1; s <= steps; s++) {
+			const struct point2f p = catmullRom(p0, p1, p2, p3, s / (GLfloat) steps);
+			GLfloat step = hypotf(p.x - prev.x, p.y - prev.y);
+			while(travelled + step >= spacing) {
+				const GLfloat t = (spacing - travelled) / step;
+				struct point2f q = { prev.x + (p.x - prev.x) * t, prev.y + (p.y - prev.y) * t };
+				out.push_back(q);
+				prev = q;
+				step = hypotf(p.x - prev.x, p.y - prev.y);
+				travelled = 0.0f;
+			}
+			travelled += step;
+			prev = p;
+		}
+	}
+
+	/* the stroke ends where it ended, not on the last whole spacing */
+	if(travelled > 0.0f) {
+		out.push_back(points[n - 1]);
+	}
+}
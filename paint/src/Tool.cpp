@@ -10,6 +10,8 @@ struct color4f Tool::color = { 1.0f, 1.0f, 1.0f, 1.0f };
 GLfloat Tool::size = 2.0f;
 GLfloat Tool::width = 2.0f;
 bool Tool::fill = false;
+bool Tool::smoothing = false;
+GLfloat Tool::pixelSize = 1.0f;
 
 Tool::Tool() {
 	mouseCurrentlyDown = false;
@@ -23,6 +25,12 @@ void Tool::mouseMove(struct point2f p) {
 	/* do nothing */
 }
 
+void Tool::mouseDrag(const struct point2f* points, int n) {
+	if(n > 0) {
+		mouseMove(points[n - 1]);
+	}
+}
+
 void Tool::mouseUp(struct point2f p) {
 	/* ignore up clicks from clicking the menus */
 	if(mouseCurrentlyDown) {
@@ -90,7 +90,16 @@ void buildMenus() {
 	glutAddSubMenu("Line Width", widthId);
 
 	glutAddMenuEntry("Toggle Fade",  FADE);
+	glutAddMenuEntry("Toggle Smoothing", SMOOTH);
+	glutAddMenuEntry("Toggle CPU Compose", COMPOSE);
+	glutAddMenuEntry("Toggle Raster Layer", LAYER);
+	glutAddMenuEntry("Export PPM", EXPORT);
+	glutAddMenuEntry("Save",  SAVE);
+	glutAddMenuEntry("Open",  OPEN);
+	glutAddMenuEntry("Undo",  UNDO);
+	glutAddMenuEntry("Redo",  REDO);
 	glutAddMenuEntry("Clear", CLEAR);
+	glutAddMenuEntry("New",   NEW);
 	glutAddMenuEntry("Quit",  QUIT);
 
 	glutAttachMenu(GLUT_RIGHT_BUTTON);
@@ -0,0 +1,177 @@
+/*
+ * sierpinski_ifs: render an iterated function system without a window,
+ * report its throughput as JSON and optionally write the image
+ *
+ * usage: sierpinski_ifs [-ifs file] [-points n] [-threads n] [-size n]
+ *                       [-kernel name] [-seed n] [-out file.ppm|file.pgm]
+ *
+ * the points are binned into the same density histogram the progressive mode
+ * draws.  a .ppm output gets its colors, a .pgm output the plain log density.
+ * the log the colors are tone mapped with is checked against log2f over every
+ * count a bin could reach, and the exit status is 1 if it strays too far.
+ */
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "chaos.h"
+
+/* benchmark parameters */
+struct options {
+    const char* ifs;
+    long points;
+    int threads, size;
+    const char* kernel;
+    unsigned long long seed;
+    const char* out;
+} options = { NULL, 100000000L, 0, DENSITY_SIZE, NULL, 1, NULL };
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void parseArgs(int argc, char** argv)
+{
+    for(int i = 1; i < argc; i++) {
+        if(i + 1 >= argc) {
+            fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+        } else if(strcmp(argv[i], "-ifs") == 0) {
+            options.ifs = argv[++i];
+        } else if(strcmp(argv[i], "-points") == 0) {
+            options.points = atol(argv[++i]);
+        } else if(strcmp(argv[i], "-threads") == 0) {
+            options.threads = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "-size") == 0) {
+            options.size = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "-kernel") == 0) {
+            options.kernel = argv[++i];
+        } else if(strcmp(argv[i], "-seed") == 0) {
+            options.seed = strtoull(argv[++i], NULL, 10);
+        } else if(strcmp(argv[i], "-out") == 0) {
+            options.out = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+        }
+    }
+    if(options.points < 1) options.points = 1;
+}
+
+/*
+ * write the density as a binary PGM (gray log density) or PPM (the tone
+ * mapped colors).  the histogram's row 0 is the bottom of the picture.
+ */
+static int writeImage(const density_t* d, const char* path)
+{
+    const size_t len = strlen(path);
+    const int gray = len > 4 && strcmp(path + len - 4, ".pgm") == 0;
+
+    FILE* fp = fopen(path, "wb");
+    if(fp == NULL) return 0;
+
+    fprintf(fp, "P%c\n%d %d\n255\n", gray ? '5' : '6', d->size, d->size);
+    unsigned char* row = (unsigned char*) malloc(d->size * 3);
+    const double scale = d->max > 0 ? 255.0 / log2(1.0 + d->max) : 0.0;
+
+    for(int by = d->size - 1; by >= 0; by--) {
+        for(int bx = 0; bx < d->size; bx++) {
+            const size_t i = (size_t) by * d->size + bx;
+            if(gray) {
+                row[bx] = (unsigned char) (log2(1.0 + d->bins[i]) * scale + 0.5);
+            } else {
+                memcpy(&row[bx * 3], &d->image[i * 4], 3);
+            }
+        }
+        fwrite(row, gray ? 1 : 3, d->size, fp);
+    }
+
+    free(row);
+    return fclose(fp) == 0;
+}
+
+/*
+ * splitmix64 finalizer
+ */
+static uint64_t mix(uint64_t h)
+{
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+int main(int argc, char** argv)
+{
+    parseArgs(argc, argv);
+    if(options.size < 1 || options.size > DENSITY_MAX_SIZE) {
+        fprintf(stderr, "Size must be between 1 and %d\n", DENSITY_MAX_SIZE);
+        return 1;
+    }
+
+    ifs_t ifs;
+    char error[160];
+    if(options.ifs == NULL) {
+        ifsTriangle(&ifs);
+    } else if(!ifsLoad(&ifs, options.ifs, 10.0f, error, sizeof(error))) {
+        fprintf(stderr, "%s: %s\n", options.ifs, error);
+        return 1;
+    }
+    if(options.kernel != NULL) {
+        ifs.iterate = ifsSelect(options.kernel);
+        if(ifs.iterate == NULL) {
+            fprintf(stderr, "Unsupported kernel '%s'\n", options.kernel);
+            return 1;
+        }
+    }
+
+    density_t density;
+    const int threads = options.threads > 0 ? options.threads : chaosDefaultThreads();
+    if(!densityInit(&density, &ifs, options.size, threads, options.seed)) {
+        fprintf(stderr, "Unable to allocate a %dx%d density image\n", options.size, options.size);
+        return 1;
+    }
+
+    const double start = now();
+    const long points = densityAdd(&density, options.points);
+    const double seconds = now() - start;
+
+    /* the bins only depend on the seed and thread count, never on the kernel */
+    uint64_t checksum = mix(options.size);
+    for(size_t i = 0; i < (size_t) options.size * options.size; i++) {
+        checksum = mix(checksum ^ density.bins[i]);
+    }
+
+    /* every count a bin can hold, each one up to 4096 and sparser above */
+    float log2Error = 0.0f;
+    for(uint64_t c = 0; c <= UINT32_MAX; c += (c >> 12) + 1) {
+        const float e = fabsf(fastLog2(1.0f + c) - log2f(1.0f + c));
+        if(e > log2Error) log2Error = e;
+    }
+
+    if(options.out != NULL && !writeImage(&density, options.out)) {
+        fprintf(stderr, "Unable to write %s\n", options.out);
+        return 1;
+    }
+
+    printf("{\n");
+    printf("  \"ifs\": \"%s\",\n", options.ifs ? options.ifs : "triangle");
+    printf("  \"maps\": %d,\n", ifs.count);
+    printf("  \"kernel\": \"%s\",\n", ifsName(ifs.iterate));
+    printf("  \"threads\": %d,\n", density.threads);
+    printf("  \"seed\": %llu,\n", options.seed);
+    printf("  \"size\": %d,\n", density.size);
+    printf("  \"points\": %ld,\n", points);
+    printf("  \"seconds\": %.4f,\n", seconds);
+    printf("  \"points_per_second\": %.0f,\n", seconds > 0.0 ? points / seconds : 0.0);
+    printf("  \"max_density\": %u,\n", density.max);
+    printf("  \"log2_error\": %g,\n", log2Error);
+    printf("  \"checksum\": \"%016" PRIx64 "\"\n", checksum);
+    printf("}\n");
+
+    densityFree(&density);
+    return log2Error <= DENSITY_LOG2_ERROR ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+#ifndef CHAOS_H_
+#define CHAOS_H_
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "ifs.h"
+
+/* largest number of points a frame may hold */
+#define CHAOS_MAX_POINTS 100000000L
+
+/* one colored point as handed to glDrawArrays */
+typedef struct {
+    float x, y;
+    unsigned char r, g, b, a;
+} vertex_t;
+
+/*
+ * threads started once and parked between frames.  every run wakes them to
+ * call fn(ctx, task) for each task, member m taking tasks m, m + size, ...,
+ * and waits until all are done.  the calling thread is member 0.
+ */
+typedef struct crew {
+    int size;
+    pthread_t* threads;
+    struct crewMember* members;
+
+    /* run hand-off */
+    pthread_mutex_t lock;
+    pthread_cond_t start, done;
+    int generation, busy, quit;
+
+    void (*fn)(void* ctx, int task);
+    void* ctx;
+    int tasks;
+} crew_t;
+
+/*
+ * the chaos game on an iterated function system, played by several
+ * independent streams at once.  every
+ * stream has its own random numbers and fills its own slice of vertices, so
+ * the slices can be generated on separate threads and drawn with one call.
+ */
+typedef struct {
+    const ifs_t* ifs;
+    vertex_t* vertices;
+    long count;
+    int threads;
+
+    /* the streams of frame n are seeded from (seed, n) */
+    uint64_t seed;
+    uint64_t frame;
+
+    /* one stream a thread, played by a crew kept across frames */
+    struct stream* streams;
+    crew_t crew;
+} chaos_t;
+
+/*
+ * allocate count points of the attractor of ifs, which must stay around,
+ * and start the threads generating them.  returns 0 on failure
+ */
+int chaosInit(chaos_t* chaos, const ifs_t* ifs, long count, int threads);
+
+/*
+ * stop the threads and release the points
+ */
+void chaosFree(chaos_t* chaos);
+
+/*
+ * play a fresh frame of the game into the vertices
+ */
+void chaosGenerate(chaos_t* chaos);
+
+/*
+ * number of online cpus
+ */
+int chaosDefaultThreads(void);
+
+/* default side of the density histogram, a power of two for GL textures */
+#define DENSITY_SIZE 1024
+
+/* largest side a density histogram may have */
+#define DENSITY_MAX_SIZE 4096
+
+/* furthest fastLog2 may stray from log2 */
+#define DENSITY_LOG2_ERROR 0.01f
+
+/*
+ * log2 good to DENSITY_LOG2_ERROR, plenty for 8 bit output and far cheaper
+ * than log2f.  the mantissa m in [1, 2) goes through a quadratic fitted to
+ * log2(m), the exponent is added back.
+ */
+static inline float fastLog2(float v)
+{
+    union { float f; uint32_t i; } u = { v };
+    const float e = (float) ((int) (u.i >> 23) - 127);
+    u.i = (u.i & 0x007fffff) | 0x3f800000;
+    const float m = u.f;
+    return e + (-0.34484843f * m + 2.02466578f) * m - 1.67487759f;
+}
+
+/* rows the image is tone mapped and uploaded in, a power of two */
+#define DENSITY_BAND 8
+
+/*
+ * progressive rendering of the attractor.  the streams keep playing across
+ * frames and count their hits in a persistent size x size histogram over
+ * [-10, 10]^2, which is tone mapped by log density into an RGBA image.  the
+ * image is mapped in bands of DENSITY_BAND rows, and only the bands hit since
+ * they were last mapped are mapped again.
+ */
+typedef struct {
+    const ifs_t* ifs;
+    int size;
+    int threads;
+    uint32_t* bins;
+    uint32_t max;
+    uint64_t hits;
+
+    /* RGBA, size x size */
+    unsigned char* image;
+
+    /* per band: hit since it was last mapped, and mapped since it was last uploaded */
+    int bands;
+    unsigned char* dirty;
+    unsigned char* mapped;
+
+    /* log2(1 + max) the image was last mapped with */
+    float mappedScale;
+
+    /* seconds a band took to map, bands dirty at the last tone map, and where the next starts */
+    double bandCost;
+    int dirtyBands;
+    int nextBand;
+
+    /* where every stream left off, and the threads playing them */
+    orbit_t* orbits;
+    struct worker* workers;
+    int* order;
+    crew_t crew;
+} density_t;
+
+/*
+ * allocate a size x size histogram of the attractor of ifs fed by the given
+ * number of streams, and start their threads.  returns 0 on failure or if
+ * size is not between 1 and DENSITY_MAX_SIZE
+ */
+int densityInit(density_t* density, const ifs_t* ifs, int size, int threads, uint64_t seed);
+
+/*
+ * stop the threads and release the histogram and image
+ */
+void densityFree(density_t* density);
+
+/*
+ * forget every hit and start over
+ */
+void densityClear(density_t* density);
+
+/*
+ * play the streams and tone map the bands they touched, the two together
+ * taking about budget seconds.  bands there is no time left for are mapped
+ * by later calls.  returns the number of points added.
+ */
+long densityAccumulate(density_t* density, double budget);
+
+/*
+ * play the streams until at least points more points have been added, then
+ * tone map every band they touched.  returns the number of points added.
+ */
+long densityAdd(density_t* density, long points);
+
+/*
+ * the next run of rows at or after *row that were mapped since they were last
+ * handed out, as [*row, *end), which are then no longer reported.  returns 0
+ * once there are none left.
+ */
+int densityNextRows(density_t* density, int* row, int* end);
+
+#endif /*CHAOS_H_*/
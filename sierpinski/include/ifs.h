@@ -0,0 +1,90 @@
+#ifndef IFS_H_
+#define IFS_H_
+
+#include <stdint.h>
+
+/* most affine maps a system may have */
+#define IFS_MAX_MAPS 64
+
+/* points iterated side by side */
+#define IFS_LANES 8
+
+struct ifs;
+typedef struct orbit orbit_t;
+
+/*
+ * moves every lane of the orbit steps times, writing the point of lane l after
+ * step i to x[i * IFS_LANES + l] and y[i * IFS_LANES + l].  all kernels must
+ * produce bit-identical results.
+ */
+typedef void (*iterator_t)(const struct ifs* ifs, orbit_t* orbit, float* x, float* y, int steps);
+
+/*
+ * an iterated function system: count weighted affine maps
+ *   x' = a x + b y + e
+ *   y' = c x + d y + f
+ * stored by coefficient so the lanes of a vector can gather them.  a map is
+ * picked with probability proportional to its weight through an alias table:
+ * column k = floor(u n) is kept if the fraction u n - k is below prob[k] and
+ * replaced by alias[k] otherwise.
+ */
+typedef struct ifs {
+    int count;
+    float a[IFS_MAX_MAPS], b[IFS_MAX_MAPS], c[IFS_MAX_MAPS];
+    float d[IFS_MAX_MAPS], e[IFS_MAX_MAPS], f[IFS_MAX_MAPS];
+    float weight[IFS_MAX_MAPS];
+
+    float prob[IFS_MAX_MAPS];
+    int32_t alias[IFS_MAX_MAPS];
+
+    /* kernel used to iterate it, the fastest one unless changed */
+    iterator_t iterate;
+} ifs_t;
+
+/*
+ * IFS_LANES points on the attractor, each with its own xoshiro128+ state
+ */
+struct orbit {
+    float x[IFS_LANES], y[IFS_LANES];
+    uint32_t s[4][IFS_LANES];
+};
+
+/*
+ * read a system from text, one map per line as seven numbers "a b c d e f w",
+ * where w is the relative weight.  '#' starts a comment.  an optional line
+ * "bounds xmin xmax ymin ymax" gives the box the attractor is fitted into;
+ * without one the box is estimated by iterating.  the maps are then changed
+ * so the attractor fills [-half, half]^2 keeping its aspect.  returns 0 and
+ * describes the problem in error (of errorSize bytes) on failure.
+ */
+int ifsParse(ifs_t* ifs, const char* text, float half, char* error, int errorSize);
+
+/*
+ * ifsParse the contents of a file
+ */
+int ifsLoad(ifs_t* ifs, const char* path, float half, char* error, int errorSize);
+
+/*
+ * the three maps of the sierpinski triangle with corners (-10, -10),
+ * (10, -10) and (0, 10)
+ */
+void ifsTriangle(ifs_t* ifs);
+
+/*
+ * seed every lane of an orbit from seed and move it onto the attractor
+ */
+void ifsSeed(const ifs_t* ifs, orbit_t* orbit, uint64_t seed);
+
+/*
+ * look up a kernel by name ("scalar" or "avx2").  NULL selects the fastest
+ * kernel supported by this cpu.  returns NULL if the named kernel is unknown
+ * or unsupported.
+ */
+iterator_t ifsSelect(const char* name);
+
+/*
+ * name of a kernel returned by ifsSelect
+ */
+const char* ifsName(iterator_t kernel);
+
+#endif /*IFS_H_*/
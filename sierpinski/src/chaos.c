@@ -0,0 +1,523 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "chaos.h"
+
+/* lane steps asked of the kernel at a time, IFS_LANES points each */
+#define CHAOS_BLOCK 256
+
+/* what one stream needs to fill its slice */
+typedef struct stream {
+    const ifs_t* ifs;
+    vertex_t* vertices;
+    long count;
+    uint64_t seed;
+} stream_t;
+
+/* what every crew thread needs to find its way back */
+struct crewMember {
+    crew_t* crew;
+    int index;
+};
+
+/*
+ * splitmix64, used to spread (seed, frame, stream) into independent seeds
+ */
+static uint64_t splitmix(uint64_t* s)
+{
+    uint64_t z = (*s += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/*
+ * clamp a color channel the way glColor3f does and scale it to a byte
+ */
+static inline unsigned char channel(float c)
+{
+    if(c <= 0.0f) return 0;
+    if(c >= 1.0f) return 255;
+    return (unsigned char) (c * 255.0f + 0.5f);
+}
+
+static void crewWork(crew_t* crew, int member)
+{
+    for(int t = member; t < crew->tasks; t += crew->size) {
+        crew->fn(crew->ctx, t);
+    }
+}
+
+static void* crewThread(void* arg)
+{
+    struct crewMember* m = (struct crewMember*) arg;
+    crew_t* crew = m->crew;
+    int seen = 0;
+
+    pthread_mutex_lock(&crew->lock);
+    for(;;) {
+        while(crew->generation == seen && !crew->quit) {
+            pthread_cond_wait(&crew->start, &crew->lock);
+        }
+        if(crew->quit) break;
+        seen = crew->generation;
+        pthread_mutex_unlock(&crew->lock);
+
+        crewWork(crew, m->index);
+
+        pthread_mutex_lock(&crew->lock);
+        if(--crew->busy == 0) pthread_cond_signal(&crew->done);
+    }
+    pthread_mutex_unlock(&crew->lock);
+
+    return NULL;
+}
+
+/*
+ * start size - 1 threads, or as many as the system allows.  returns 0 on
+ * failure
+ */
+static int crewInit(crew_t* crew, int size)
+{
+    crew->size = 1;
+    crew->generation = crew->busy = crew->quit = 0;
+    crew->threads = (pthread_t*) malloc(size * sizeof(pthread_t));
+    crew->members = (struct crewMember*) malloc(size * sizeof(struct crewMember));
+    if(!crew->threads || !crew->members) {
+        free(crew->threads);
+        free(crew->members);
+        crew->threads = NULL;
+        crew->members = NULL;
+        return 0;
+    }
+
+    pthread_mutex_init(&crew->lock, NULL);
+    pthread_cond_init(&crew->start, NULL);
+    pthread_cond_init(&crew->done, NULL);
+
+    /* fewer threads only mean more tasks each */
+    for(int t = 1; t < size; t++) {
+        crew->members[t].crew = crew;
+        crew->members[t].index = t;
+        if(pthread_create(&crew->threads[t], NULL, crewThread, &crew->members[t]) != 0) break;
+        crew->size = t + 1;
+    }
+    return 1;
+}
+
+static void crewFree(crew_t* crew)
+{
+    if(crew->members == NULL) return;
+
+    pthread_mutex_lock(&crew->lock);
+    crew->quit = 1;
+    pthread_cond_broadcast(&crew->start);
+    pthread_mutex_unlock(&crew->lock);
+
+    for(int t = 1; t < crew->size; t++) {
+        pthread_join(crew->threads[t], NULL);
+    }
+
+    pthread_cond_destroy(&crew->done);
+    pthread_cond_destroy(&crew->start);
+    pthread_mutex_destroy(&crew->lock);
+
+    free(crew->threads);
+    free(crew->members);
+    crew->threads = NULL;
+    crew->members = NULL;
+    crew->size = 0;
+}
+
+/*
+ * call fn(ctx, t) for every t in [0, tasks) on the crew and wait for all of
+ * them
+ */
+static void crewRun(crew_t* crew, int tasks, void (*fn)(void*, int), void* ctx)
+{
+    if(crew->size == 1 || tasks <= 1) {
+        for(int t = 0; t < tasks; t++) fn(ctx, t);
+        return;
+    }
+
+    pthread_mutex_lock(&crew->lock);
+    crew->fn = fn;
+    crew->ctx = ctx;
+    crew->tasks = tasks;
+    crew->busy = crew->size - 1;
+    crew->generation++;
+    pthread_cond_broadcast(&crew->start);
+    pthread_mutex_unlock(&crew->lock);
+
+    crewWork(crew, 0);
+
+    pthread_mutex_lock(&crew->lock);
+    while(crew->busy > 0) {
+        pthread_cond_wait(&crew->done, &crew->lock);
+    }
+    pthread_mutex_unlock(&crew->lock);
+}
+
+static void chaosStream(void* ctx, int index)
+{
+    stream_t* s = &((stream_t*) ctx)[index];
+    float x[CHAOS_BLOCK * IFS_LANES], y[CHAOS_BLOCK * IFS_LANES];
+    orbit_t orbit;
+    ifsSeed(s->ifs, &orbit, s->seed);
+
+    for(long i = 0; i < s->count; ) {
+        s->ifs->iterate(s->ifs, &orbit, x, y, CHAOS_BLOCK);
+
+        long n = s->count - i;
+        if(n > CHAOS_BLOCK * IFS_LANES) n = CHAOS_BLOCK * IFS_LANES;
+        for(int j = 0; j < n; j++, i++) {
+            vertex_t* v = &s->vertices[i];
+            v->x = x[j];
+            v->y = y[j];
+            v->r = channel(x[j] / 3);
+            v->g = channel(y[j] / 3);
+            v->b = channel((3 - x[j]) / 3);
+            v->a = 255;
+        }
+    }
+}
+
+int chaosDefaultThreads(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int) n : 1;
+}
+
+int chaosInit(chaos_t* chaos, const ifs_t* ifs, long count, int threads)
+{
+    if(count < 1) count = 1;
+    if(count > CHAOS_MAX_POINTS) count = CHAOS_MAX_POINTS;
+    if(threads < 1) threads = 1;
+
+    chaos->ifs = ifs;
+    chaos->count = count;
+    chaos->threads = threads;
+    chaos->seed = 1;
+    chaos->frame = 0;
+    if(!crewInit(&chaos->crew, threads)) return 0;
+
+    chaos->vertices = (vertex_t*) malloc(count * sizeof(vertex_t));
+    chaos->streams = (stream_t*) malloc(threads * sizeof(stream_t));
+    if(!chaos->vertices || !chaos->streams) {
+        chaosFree(chaos);
+        return 0;
+    }
+    return 1;
+}
+
+void chaosFree(chaos_t* chaos)
+{
+    crewFree(&chaos->crew);
+    free(chaos->vertices);
+    free(chaos->streams);
+    chaos->vertices = NULL;
+    chaos->streams = NULL;
+    chaos->count = 0;
+}
+
+void chaosGenerate(chaos_t* chaos)
+{
+    uint64_t mix = chaos->seed ^ (chaos->frame++ * 0xd1b54a32d192ed03ULL);
+
+    /* the slices only depend on the stream count, not on how many threads run them */
+    for(int t = 0; t < chaos->threads; t++) {
+        const long begin = chaos->count * t / chaos->threads;
+        const long end = chaos->count * (t + 1) / chaos->threads;
+        chaos->streams[t].ifs = chaos->ifs;
+        chaos->streams[t].vertices = chaos->vertices + begin;
+        chaos->streams[t].count = end - begin;
+        chaos->streams[t].seed = splitmix(&mix);
+    }
+
+    crewRun(&chaos->crew, chaos->threads, chaosStream, chaos->streams);
+}
+
+/* iterations between looks at the clock */
+#define DENSITY_BATCH 16384
+
+/* largest share of a frame's budget set aside for the tone map */
+#define DENSITY_MAP_SHARE 0.5
+
+/* what one stream needs to add to the histogram */
+typedef struct worker {
+    /* play until the deadline, or until quota points are in if there is one */
+    double deadline;
+    long quota;
+
+    /* results: points added, largest bin seen and bands touched */
+    long hits;
+    uint32_t max;
+    unsigned char* dirty;
+} worker_t;
+
+/* the dirty bands of one tone map, in density->order, claimed one at a time */
+typedef struct {
+    density_t* density;
+    int count;
+    int next;
+
+    /* bands mapped whatever the time, so the image never stalls */
+    int minimum;
+
+    /* no deadline if 0 */
+    double deadline;
+    float scale;
+} toneMap_t;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int densityInit(density_t* density, const ifs_t* ifs, int size, int threads, uint64_t seed)
+{
+    if(size < 1 || size > DENSITY_MAX_SIZE) return 0;
+    if(threads < 1) threads = 1;
+    density->ifs = ifs;
+    density->size = size;
+    density->threads = threads;
+    density->bands = (size + DENSITY_BAND - 1) / DENSITY_BAND;
+    density->bandCost = 0.0;
+    density->dirtyBands = 0;
+    if(!crewInit(&density->crew, threads)) return 0;
+
+    density->bins = (uint32_t*) malloc((size_t) size * size * sizeof(uint32_t));
+    density->image = (unsigned char*) malloc((size_t) size * size * 4);
+    density->dirty = (unsigned char*) malloc(density->bands);
+    density->mapped = (unsigned char*) malloc(density->bands);
+    density->order = (int*) malloc(density->bands * sizeof(int));
+    density->orbits = (orbit_t*) malloc(threads * sizeof(orbit_t));
+    density->workers = (worker_t*) calloc(threads, sizeof(worker_t));
+
+    int ok = density->bins && density->image && density->dirty && density->mapped &&
+             density->order && density->orbits && density->workers;
+    for(int t = 0; ok && t < threads; t++) {
+        density->workers[t].dirty = (unsigned char*) calloc(density->bands, 1);
+        ok = density->workers[t].dirty != NULL;
+    }
+    if(!ok) {
+        densityFree(density);
+        return 0;
+    }
+
+    for(int t = 0; t < threads; t++) {
+        ifsSeed(ifs, &density->orbits[t], splitmix(&seed));
+    }
+
+    densityClear(density);
+    return 1;
+}
+
+void densityFree(density_t* density)
+{
+    crewFree(&density->crew);
+    for(int t = 0; density->workers && t < density->threads; t++) {
+        free(density->workers[t].dirty);
+    }
+    free(density->bins);
+    free(density->image);
+    free(density->dirty);
+    free(density->mapped);
+    free(density->order);
+    free(density->orbits);
+    free(density->workers);
+    density->bins = NULL;
+    density->image = NULL;
+    density->dirty = NULL;
+    density->mapped = NULL;
+    density->order = NULL;
+    density->orbits = NULL;
+    density->workers = NULL;
+}
+
+void densityClear(density_t* density)
+{
+    const size_t n = (size_t) density->size * density->size;
+    memset(density->bins, 0, n * sizeof(uint32_t));
+    memset(density->image, 0, n * 4);
+    density->max = 0;
+    density->hits = 0;
+
+    /* forces the next tone map over every band, and the blank image out to the texture */
+    density->mappedScale = 0.0f;
+    memset(density->dirty, 0, density->bands);
+    memset(density->mapped, 1, density->bands);
+    density->nextBand = 0;
+}
+
+static void densityStream(void* ctx, int index)
+{
+    density_t* d = (density_t*) ctx;
+    worker_t* w = &d->workers[index];
+    const float scale = d->size / 20.0f;
+    orbit_t* orbit = &d->orbits[index];
+    float x[CHAOS_BLOCK * IFS_LANES], y[CHAOS_BLOCK * IFS_LANES];
+
+    do {
+        for(int b = 0; b < DENSITY_BATCH; b += CHAOS_BLOCK * IFS_LANES) {
+            d->ifs->iterate(d->ifs, orbit, x, y, CHAOS_BLOCK);
+
+            for(int i = 0; i < CHAOS_BLOCK * IFS_LANES; i++) {
+                int bx = (int) ((x[i] + 10.0f) * scale);
+                int by = (int) ((y[i] + 10.0f) * scale);
+                if(bx >= d->size) bx = d->size - 1;
+                if(by >= d->size) by = d->size - 1;
+                if(bx < 0) bx = 0;
+                if(by < 0) by = 0;
+
+                /* streams share the histogram, hits rarely collide */
+                const uint32_t c = __atomic_add_fetch(&d->bins[by * d->size + bx], 1, __ATOMIC_RELAXED);
+                if(c > w->max) w->max = c;
+                w->dirty[by / DENSITY_BAND] = 1;
+            }
+        }
+        w->hits += DENSITY_BATCH;
+    } while(w->quota > 0 ? w->hits < w->quota : now() < w->deadline);
+}
+
+/*
+ * map bands off the list until it is empty or, past the first few, the
+ * deadline has passed.  a band left over stays dirty.
+ */
+static void densityToneMap(void* ctx, int task)
+{
+    toneMap_t* m = (toneMap_t*) ctx;
+    density_t* d = m->density;
+    int k;
+
+    while((k = __atomic_fetch_add(&m->next, 1, __ATOMIC_RELAXED)) < m->count) {
+        if(k >= m->minimum && m->deadline > 0.0 && now() >= m->deadline) break;
+
+        const int band = d->order[k];
+        const int rowEnd = (band + 1) * DENSITY_BAND < d->size ? (band + 1) * DENSITY_BAND : d->size;
+        for(int by = band * DENSITY_BAND; by < rowEnd; by++) {
+            const float y = (by + 0.5f) * 20.0f / d->size - 10.0f;
+            for(int bx = 0; bx < d->size; bx++) {
+                const uint32_t c = d->bins[by * d->size + bx];
+                unsigned char* px = &d->image[(by * d->size + bx) * 4];
+                if(c == 0) {
+                    px[0] = px[1] = px[2] = px[3] = 0;
+                    continue;
+                }
+
+                /* log density, colored the way the immediate mode points are */
+                const float x = (bx + 0.5f) * 20.0f / d->size - 10.0f;
+                float v = fastLog2(1.0f + c) * m->scale;
+                if(v > 1.0f) v = 1.0f;
+                px[0] = channel(v * x / 3);
+                px[1] = channel(v * y / 3);
+                px[2] = channel(v * (3 - x) / 3);
+                px[3] = 255;
+            }
+        }
+        d->dirty[band] = 0;
+        d->mapped[band] = 1;
+    }
+}
+
+/*
+ * play every stream until the deadline or, if points is positive, until
+ * points more have been added.  then tone map what changed, by the deadline
+ * too if there is one.
+ */
+static long densityPlay(density_t* density, double deadline, long points)
+{
+    const int n = density->threads;
+
+    /* leave the tone map about what the last one needed, but never most of the budget */
+    double playDeadline = deadline;
+    if(points <= 0) {
+        double reserve = density->bandCost * density->dirtyBands;
+        const double most = (deadline - now()) * DENSITY_MAP_SHARE;
+        if(reserve > most) reserve = most;
+        if(reserve > 0.0) playDeadline -= reserve;
+    }
+
+    for(int t = 0; t < n; t++) {
+        worker_t* w = &density->workers[t];
+        w->deadline = playDeadline;
+        w->quota = points > 0 ? points * (t + 1) / n - points * t / n : 0;
+        w->hits = 0;
+        w->max = 0;
+    }
+    crewRun(&density->crew, n, densityStream, density);
+
+    long hits = 0;
+    for(int t = 0; t < n; t++) {
+        worker_t* w = &density->workers[t];
+        hits += w->hits;
+        if(w->max > density->max) density->max = w->max;
+        for(int b = 0; b < density->bands; b++) {
+            density->dirty[b] |= w->dirty[b];
+        }
+        memset(w->dirty, 0, density->bands);
+    }
+    density->hits += hits;
+
+    /* once the brightest bin has grown enough, every band needs mapping again */
+    const float scale = fastLog2(1.0f + density->max);
+    if(scale > density->mappedScale * 1.01f) {
+        density->mappedScale = scale;
+        memset(density->dirty, 1, density->bands);
+    }
+
+    /* dirty bands from where the last tone map ran out of time, so none starves */
+    int count = 0;
+    for(int i = 0; i < density->bands; i++) {
+        const int b = (density->nextBand + i) % density->bands;
+        if(density->dirty[b]) density->order[count++] = b;
+    }
+    density->dirtyBands = count;
+
+    if(count > 0) {
+        toneMap_t map = { density, count, 0, n, points > 0 ? 0.0 : deadline, 1.0f / density->mappedScale };
+        const double start = now();
+        crewRun(&density->crew, n, densityToneMap, &map);
+        const double elapsed = now() - start;
+
+        int done = 0;
+        for(int k = count - 1; k >= 0; k--) {
+            if(density->dirty[density->order[k]]) {
+                density->nextBand = density->order[k];
+            } else {
+                done++;
+            }
+        }
+        if(done > 0) density->bandCost = elapsed / done;
+    }
+
+    return hits;
+}
+
+long densityAccumulate(density_t* density, double budget)
+{
+    return densityPlay(density, now() + budget, 0);
+}
+
+long densityAdd(density_t* density, long points)
+{
+    return densityPlay(density, 0.0, points);
+}
+
+int densityNextRows(density_t* density, int* row, int* end)
+{
+    int b = *row / DENSITY_BAND;
+    while(b < density->bands && !density->mapped[b]) b++;
+    if(b >= density->bands) return 0;
+
+    *row = b * DENSITY_BAND;
+    while(b < density->bands && density->mapped[b]) density->mapped[b++] = 0;
+    *end = b * DENSITY_BAND < density->size ? b * DENSITY_BAND : density->size;
+    return 1;
+}
@@ -0,0 +1,411 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ifs.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+/* steps thrown away before an orbit is on the attractor */
+#define IFS_WARMUP 64
+
+/* steps taken to estimate the bounds of an attractor */
+#define IFS_BOUNDS_STEPS 8192
+
+/* the triangle the demo has always drawn */
+static const char* TRIANGLE =
+    "0.5 0 0 0.5 -5 -5 1\n"
+    "0.5 0 0 0.5  5 -5 1\n"
+    "0.5 0 0 0.5  0  5 1\n"
+    "bounds -10 10 -10 10\n";
+
+static inline uint32_t rotl(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+/*
+ * the vector kernel evaluates exactly the same float operations in the same
+ * order as this one (no fused multiply-add), which keeps them bit-identical
+ */
+static void iterateScalar(const ifs_t* ifs, orbit_t* o, float* x, float* y, int steps)
+{
+    const float n = (float) ifs->count;
+
+    for(int i = 0; i < steps; i++) {
+        for(int l = 0; l < IFS_LANES; l++) {
+            /* xoshiro128+, only its top 24 bits are used */
+            const uint32_t r = o->s[0][l] + o->s[3][l];
+            const uint32_t t = o->s[1][l] << 9;
+            o->s[2][l] ^= o->s[0][l];
+            o->s[3][l] ^= o->s[1][l];
+            o->s[1][l] ^= o->s[2][l];
+            o->s[0][l] ^= o->s[3][l];
+            o->s[2][l] ^= t;
+            o->s[3][l] = rotl(o->s[3][l], 11);
+
+            /* alias table lookup */
+            const float u = (float) (int32_t) (r >> 8) * (1.0f / 16777216.0f) * n;
+            int k = (int) u;
+            if(k > ifs->count - 1) k = ifs->count - 1;
+            if(!(u - (float) k < ifs->prob[k])) k = ifs->alias[k];
+
+            const float px = o->x[l], py = o->y[l];
+            o->x[l] = ifs->a[k] * px + ifs->b[k] * py + ifs->e[k];
+            o->y[l] = ifs->c[k] * px + ifs->d[k] * py + ifs->f[k];
+            x[i * IFS_LANES + l] = o->x[l];
+            y[i * IFS_LANES + l] = o->y[l];
+        }
+    }
+}
+
+#ifdef HAVE_X86
+
+__attribute__((target("avx2")))
+static void iterateAVX2(const ifs_t* ifs, orbit_t* o, float* x, float* y, int steps)
+{
+    const __m256 vN = _mm256_set1_ps((float) ifs->count);
+    const __m256 vScale = _mm256_set1_ps(1.0f / 16777216.0f);
+    const __m256i vLast = _mm256_set1_epi32(ifs->count - 1);
+
+    __m256i s0 = _mm256_loadu_si256((const __m256i*) o->s[0]);
+    __m256i s1 = _mm256_loadu_si256((const __m256i*) o->s[1]);
+    __m256i s2 = _mm256_loadu_si256((const __m256i*) o->s[2]);
+    __m256i s3 = _mm256_loadu_si256((const __m256i*) o->s[3]);
+    __m256 px = _mm256_loadu_ps(o->x);
+    __m256 py = _mm256_loadu_ps(o->y);
+
+    for(int i = 0; i < steps; i++) {
+        /* xoshiro128+ in every lane */
+        const __m256i r = _mm256_add_epi32(s0, s3);
+        const __m256i t = _mm256_slli_epi32(s1, 9);
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_or_si256(_mm256_slli_epi32(s3, 11), _mm256_srli_epi32(s3, 21));
+
+        /* alias table lookup */
+        const __m256 u = _mm256_mul_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(r, 8)), vScale), vN);
+        __m256i k = _mm256_min_epi32(_mm256_cvttps_epi32(u), vLast);
+        const __m256 keep = _mm256_cmp_ps(_mm256_sub_ps(u, _mm256_cvtepi32_ps(k)),
+                                          _mm256_i32gather_ps(ifs->prob, k, 4), _CMP_LT_OQ);
+        k = _mm256_castps_si256(_mm256_blendv_ps(
+                _mm256_castsi256_ps(_mm256_i32gather_epi32(ifs->alias, k, 4)),
+                _mm256_castsi256_ps(k), keep));
+
+        /* apply the chosen maps */
+        const __m256 nx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_i32gather_ps(ifs->a, k, 4), px),
+                                                      _mm256_mul_ps(_mm256_i32gather_ps(ifs->b, k, 4), py)),
+                                        _mm256_i32gather_ps(ifs->e, k, 4));
+        const __m256 ny = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_i32gather_ps(ifs->c, k, 4), px),
+                                                      _mm256_mul_ps(_mm256_i32gather_ps(ifs->d, k, 4), py)),
+                                        _mm256_i32gather_ps(ifs->f, k, 4));
+        px = nx;
+        py = ny;
+        _mm256_storeu_ps(x + i * IFS_LANES, px);
+        _mm256_storeu_ps(y + i * IFS_LANES, py);
+    }
+
+    _mm256_storeu_si256((__m256i*) o->s[0], s0);
+    _mm256_storeu_si256((__m256i*) o->s[1], s1);
+    _mm256_storeu_si256((__m256i*) o->s[2], s2);
+    _mm256_storeu_si256((__m256i*) o->s[3], s3);
+    _mm256_storeu_ps(o->x, px);
+    _mm256_storeu_ps(o->y, py);
+}
+
+#endif /* HAVE_X86 */
+
+/* known kernels, fastest first */
+static const struct {
+    const char* name;
+    iterator_t kernel;
+} kernels[] = {
+#ifdef HAVE_X86
+    { "avx2", iterateAVX2 },
+#endif
+    { "scalar", iterateScalar }
+};
+
+#define NUM_KERNELS ((int) (sizeof(kernels) / sizeof(kernels[0])))
+
+static int kernelSupported(iterator_t kernel)
+{
+#ifdef HAVE_X86
+    __builtin_cpu_init();
+    if(kernel == iterateAVX2) return __builtin_cpu_supports("avx2");
+#endif
+    return 1;
+}
+
+iterator_t ifsSelect(const char* name)
+{
+    for(int i = 0; i < NUM_KERNELS; i++) {
+        if(name == NULL || strcmp(name, kernels[i].name) == 0) {
+            if(kernelSupported(kernels[i].kernel)) return kernels[i].kernel;
+            if(name != NULL) return NULL;
+        }
+    }
+    return NULL;
+}
+
+const char* ifsName(iterator_t kernel)
+{
+    for(int i = 0; i < NUM_KERNELS; i++) {
+        if(kernels[i].kernel == kernel) return kernels[i].name;
+    }
+    return "unknown";
+}
+
+/*
+ * splitmix64, spreads one seed over all the lane states
+ */
+static uint64_t splitmix(uint64_t* s)
+{
+    uint64_t z = (*s += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void ifsSeed(const ifs_t* ifs, orbit_t* orbit, uint64_t seed)
+{
+    for(int l = 0; l < IFS_LANES; l++) {
+        const uint64_t lo = splitmix(&seed), hi = splitmix(&seed);
+        orbit->s[0][l] = (uint32_t) lo | 1;
+        orbit->s[1][l] = (uint32_t) (lo >> 32);
+        orbit->s[2][l] = (uint32_t) hi;
+        orbit->s[3][l] = (uint32_t) (hi >> 32);
+        orbit->x[l] = orbit->y[l] = 0.0f;
+    }
+
+    float x[IFS_WARMUP * IFS_LANES], y[IFS_WARMUP * IFS_LANES];
+    ifs->iterate(ifs, orbit, x, y, IFS_WARMUP);
+}
+
+/*
+ * build the alias table from the weights (Vose's method)
+ */
+static void buildAlias(ifs_t* ifs, float total)
+{
+    const int n = ifs->count;
+    float scaled[IFS_MAX_MAPS];
+    int small[IFS_MAX_MAPS], large[IFS_MAX_MAPS];
+    int numSmall = 0, numLarge = 0;
+
+    for(int k = 0; k < n; k++) {
+        scaled[k] = ifs->weight[k] * n / total;
+        if(scaled[k] < 1.0f) small[numSmall++] = k;
+        else large[numLarge++] = k;
+    }
+
+    /* every small column is topped up by a large one */
+    while(numSmall > 0 && numLarge > 0) {
+        const int s = small[--numSmall], l = large[--numLarge];
+        ifs->prob[s] = scaled[s];
+        ifs->alias[s] = l;
+        scaled[l] -= 1.0f - scaled[s];
+        if(scaled[l] < 1.0f) small[numSmall++] = l;
+        else large[numLarge++] = l;
+    }
+
+    /* whatever is left is full, up to rounding */
+    while(numLarge > 0) {
+        const int l = large[--numLarge];
+        ifs->prob[l] = 1.0f;
+        ifs->alias[l] = l;
+    }
+    while(numSmall > 0) {
+        const int s = small[--numSmall];
+        ifs->prob[s] = 1.0f;
+        ifs->alias[s] = s;
+    }
+}
+
+/*
+ * conjugate every map with the scaling that moves the box
+ * [xmin, xmax] x [ymin, ymax] into the middle of [-half, half]^2
+ */
+static int fit(ifs_t* ifs, float xmin, float xmax, float ymin, float ymax, float half)
+{
+    const float w = xmax - xmin, h = ymax - ymin;
+    const float side = w > h ? w : h;
+    if(!(side > 0.0f) || !isfinite(side)) return 0;
+
+    const float s = 2.0f * half / side;
+    const float cx = (xmin + xmax) / 2, cy = (ymin + ymax) / 2;
+    for(int k = 0; k < ifs->count; k++) {
+        ifs->e[k] = s * (ifs->a[k] * cx + ifs->b[k] * cy + ifs->e[k] - cx);
+        ifs->f[k] = s * (ifs->c[k] * cx + ifs->d[k] * cy + ifs->f[k] - cy);
+    }
+    return 1;
+}
+
+/*
+ * bounding box of a sample of the attractor, with a little room to spare
+ */
+static int estimateBounds(const ifs_t* ifs, float* bounds)
+{
+    orbit_t orbit;
+    ifsSeed(ifs, &orbit, 0);
+
+    float* x = (float*) malloc(IFS_BOUNDS_STEPS * IFS_LANES * sizeof(float));
+    float* y = (float*) malloc(IFS_BOUNDS_STEPS * IFS_LANES * sizeof(float));
+    if(!x || !y) {
+        free(x);
+        free(y);
+        return 0;
+    }
+    ifs->iterate(ifs, &orbit, x, y, IFS_BOUNDS_STEPS);
+
+    bounds[0] = bounds[1] = x[0];
+    bounds[2] = bounds[3] = y[0];
+    for(int i = 1; i < IFS_BOUNDS_STEPS * IFS_LANES; i++) {
+        if(x[i] < bounds[0]) bounds[0] = x[i];
+        if(x[i] > bounds[1]) bounds[1] = x[i];
+        if(y[i] < bounds[2]) bounds[2] = y[i];
+        if(y[i] > bounds[3]) bounds[3] = y[i];
+    }
+    free(x);
+    free(y);
+
+    const float mx = (bounds[1] - bounds[0]) * 0.02f, my = (bounds[3] - bounds[2]) * 0.02f;
+    bounds[0] -= mx;
+    bounds[1] += mx;
+    bounds[2] -= my;
+    bounds[3] += my;
+    return 1;
+}
+
+int ifsParse(ifs_t* ifs, const char* text, float half, char* error, int errorSize)
+{
+    float bounds[4];
+    int haveBounds = 0;
+    float total = 0.0f;
+
+    ifs->count = 0;
+    ifs->iterate = ifsSelect(NULL);
+
+    for(int line = 1; *text; line++) {
+        /* the line without its comment */
+        char buf[256];
+        const char* eol = strchr(text, '\n');
+        size_t len = eol ? (size_t) (eol - text) : strlen(text);
+        if(len >= sizeof(buf)) len = sizeof(buf) - 1;
+        memcpy(buf, text, len);
+        buf[len] = '\0';
+        text = eol ? eol + 1 : text + strlen(text);
+
+        char* hash = strchr(buf, '#');
+        if(hash) *hash = '\0';
+
+        char* p = buf;
+        while(*p == ' ' || *p == '\t' || *p == '\r') p++;
+        if(*p == '\0') continue;
+
+        if(strncmp(p, "bounds", 6) == 0) {
+            p += 6;
+            int i = 0;
+            for(; i < 4; i++) {
+                char* end;
+                bounds[i] = strtof(p, &end);
+                if(end == p) break;
+                p = end;
+            }
+            if(i < 4) {
+                snprintf(error, errorSize, "line %d: bounds needs xmin xmax ymin ymax", line);
+                return 0;
+            }
+            haveBounds = 1;
+            continue;
+        }
+
+        if(ifs->count == IFS_MAX_MAPS) {
+            snprintf(error, errorSize, "line %d: more than %d maps", line, IFS_MAX_MAPS);
+            return 0;
+        }
+
+        float v[7];
+        int i = 0;
+        for(; i < 7; i++) {
+            char* end;
+            v[i] = strtof(p, &end);
+            if(end == p) break;
+            p = end;
+        }
+        while(*p == ' ' || *p == '\t' || *p == '\r') p++;
+        if(i < 7 || *p != '\0') {
+            snprintf(error, errorSize, "line %d: expected \"a b c d e f weight\"", line);
+            return 0;
+        }
+        if(!(v[6] >= 0.0f)) {
+            snprintf(error, errorSize, "line %d: negative weight", line);
+            return 0;
+        }
+
+        const int k = ifs->count++;
+        ifs->a[k] = v[0];
+        ifs->b[k] = v[1];
+        ifs->c[k] = v[2];
+        ifs->d[k] = v[3];
+        ifs->e[k] = v[4];
+        ifs->f[k] = v[5];
+        ifs->weight[k] = v[6];
+        total += v[6];
+    }
+
+    if(ifs->count == 0 || !(total > 0.0f)) {
+        snprintf(error, errorSize, "no maps with a positive weight");
+        return 0;
+    }
+    buildAlias(ifs, total);
+
+    if(!haveBounds && !estimateBounds(ifs, bounds)) {
+        snprintf(error, errorSize, "out of memory");
+        return 0;
+    }
+    if(!fit(ifs, bounds[0], bounds[1], bounds[2], bounds[3], half)) {
+        snprintf(error, errorSize, "the attractor is not a bounded area, do the maps contract?");
+        return 0;
+    }
+    return 1;
+}
+
+int ifsLoad(ifs_t* ifs, const char* path, float half, char* error, int errorSize)
+{
+    FILE* fp = fopen(path, "rb");
+    if(fp == NULL) {
+        snprintf(error, errorSize, "unable to open %s", path);
+        return 0;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    const long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    char* text = (char*) malloc(size + 1);
+    if(text == NULL || fread(text, 1, size, fp) != (size_t) size) {
+        snprintf(error, errorSize, "unable to read %s", path);
+        free(text);
+        fclose(fp);
+        return 0;
+    }
+    text[size] = '\0';
+    fclose(fp);
+
+    const int ok = ifsParse(ifs, text, half, error, errorSize);
+    free(text);
+    return ok;
+}
+
+void ifsTriangle(ifs_t* ifs)
+{
+    char error[80];
+    ifsParse(ifs, TRIANGLE, 10.0f, error, sizeof(error));
+}
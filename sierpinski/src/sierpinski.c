@@ -1,39 +1,80 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <glut.h>
 
-typedef struct {
-    GLfloat x, y;
-} GLintPoint;
+#include "chaos.h"
+
+#define TITLE "Go home Sierpinski, you're drunk"
+
+/* points per frame unless -points says otherwise */
+#define POINTS_INITIAL 250000
+
+/* milliseconds of point generation and tone mapping per progressive frame */
+#define BUDGET_INITIAL 10.0
+
+/* the system being drawn, the sierpinski triangle unless -ifs says otherwise */
+ifs_t ifs;
+
+/* the points of the current frame */
+chaos_t chaos;
+
+/* progressive mode keeps adding to a density image instead */
+int progressive = 0;
+double budget = BUDGET_INITIAL / 1000.0;
+density_t density;
+GLuint densityTexture;
+
+/*
+ * add as many points to the density image as the time budget leaves room for
+ * after tone mapping, and draw it as one textured quad
+ */
+void myDisplayProgressive()
+{
+    densityAccumulate(&density, budget);
+
+    /* only the runs of rows that changed go to the card */
+    glBindTexture(GL_TEXTURE_2D, densityTexture);
+    int row = 0, end;
+    while(densityNextRows(&density, &row, &end)) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row, density.size, end - row, GL_RGBA, GL_UNSIGNED_BYTE,
+                        density.image + (size_t) row * density.size * 4);
+        row = end;
+    }
+
+    glEnable(GL_TEXTURE_2D);
+    glBegin(GL_QUADS);
+        glTexCoord2f(0.0, 0.0); glVertex2f(-10.0, -10.0);
+        glTexCoord2f(1.0, 0.0); glVertex2f(10.0, -10.0);
+        glTexCoord2f(1.0, 1.0); glVertex2f(10.0, 10.0);
+        glTexCoord2f(0.0, 1.0); glVertex2f(-10.0, 10.0);
+    glEnd();
+    glDisable(GL_TEXTURE_2D);
+
+    char title[80];
+    sprintf(title, "%s - %.1fM points", TITLE, density.hits / 1e6);
+    glutSetWindowTitle(title);
+}
 
 void myDisplay()
 {
     /* clear window */
     glClear(GL_COLOR_BUFFER_BIT);
 
-    GLintPoint T[3];
-    T[0].x = -10;
-    T[0].y = -10;
-    T[1].x = 10;
-    T[2].y = 10;
-    T[1].y = -10;
-    T[2].x = 0;
+    if(progressive) {
+        myDisplayProgressive();
+        glRotatef(1.0, 0.0, 0.0, 1.0);
+        glutSwapBuffers();
+        return;
+    }
 
-    int idx = rand() % 3;
-    GLintPoint pt = T[idx];
+    /* generate every stream's slice, then draw them all at once */
+    chaosGenerate(&chaos);
 
     glPointSize(1.0);
-    glBegin(GL_POINTS);
-        glVertex2i(pt.x, pt.y);
-        int i=0;
-        for(; i<250000; i++) {
-          idx = rand() % 3;
-          pt.x = (pt.x + T[idx].x) / 2;
-          pt.y = (pt.y + T[idx].y) / 2;
-          glColor3f(1.0 * ((float)pt.x / 3), 1.0 * ((float)pt.y / 3), 1.0 * ((float)(3-pt.x) / 3));
-          glVertex2f(pt.x, pt.y);
-        }
-    glEnd();
+    glVertexPointer(2, GL_FLOAT, sizeof(vertex_t), &chaos.vertices[0].x);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(vertex_t), &chaos.vertices[0].r);
+    glDrawArrays(GL_POINTS, 0, chaos.count);
 
     glRotatef(1.0, 0.0, 0.0, 1.0);
 
@@ -60,6 +101,20 @@ void myMovedMouse(int x, int y)
 void myKeyboard(unsigned char key, int x, int y)
 {
     printf("myKeyboard(%c, %d, %d)\n", key, x, y);
+
+    switch(key) {
+    case 'p':
+    case 'P':
+        /* toggle progressive mode, starting from a blank image */
+        progressive = !progressive;
+        densityClear(&density);
+        if(!progressive) glutSetWindowTitle(TITLE);
+        break;
+    case 'c':
+    case 'C':
+        densityClear(&density);
+        break;
+    }
 }
 
 void myInit(int w, int h)
@@ -70,6 +125,88 @@ void myInit(int w, int h)
     glLoadIdentity();
     gluOrtho2D(-10.0, 10.0, -10.0, 10.0);
     glViewport(0, 0, w, h);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    /* texture the density image is uploaded into */
+    glGenTextures(1, &densityTexture);
+    glBindTexture(GL_TEXTURE_2D, densityTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, density.size, density.size, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, density.image);
+}
+
+/*
+ * handle the command line left over once glut has taken its own options
+ *   -ifs <file>: draw the iterated function system in file (see ifs.h)
+ *   -kernel <name>: iterate with the "scalar" or "avx2" kernel
+ *   -points <n>: points per frame, up to 100M
+ *   -threads <n>: generator threads, one per cpu by default
+ *   -progressive: start in progressive mode (toggle with 'p', clear with 'c')
+ *   -budget <ms>: time spent generating and tone mapping points per progressive frame
+ *   -size <n>: side of the progressive density image, a power of two up to 4096
+ */
+void myArgs(int argc, char** argv)
+{
+    long points = POINTS_INITIAL;
+    int threads = chaosDefaultThreads();
+    int size = DENSITY_SIZE;
+    const char* kernel = NULL;
+    char error[160];
+
+    ifsTriangle(&ifs);
+
+    int i = 1;
+    for(; i < argc; i++) {
+        if(strcmp(argv[i], "-ifs") == 0 && i + 1 < argc) {
+            if(!ifsLoad(&ifs, argv[++i], 10.0f, error, sizeof(error))) {
+                fprintf(stderr, "%s: %s\n", argv[i], error);
+                exit(1);
+            }
+        } else if(strcmp(argv[i], "-kernel") == 0 && i + 1 < argc) {
+            kernel = argv[++i];
+        } else if(strcmp(argv[i], "-points") == 0 && i + 1 < argc) {
+            points = atol(argv[++i]);
+        } else if(strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "-progressive") == 0) {
+            progressive = 1;
+        } else if(strcmp(argv[i], "-budget") == 0 && i + 1 < argc) {
+            budget = atof(argv[++i]) / 1000.0;
+        } else if(strcmp(argv[i], "-size") == 0 && i + 1 < argc) {
+            size = atoi(argv[++i]);
+
+            /* the texture it goes into needs a power of two */
+            if(size < 1 || size > DENSITY_MAX_SIZE || (size & (size - 1)) != 0) {
+                fprintf(stderr, "Unsupported size '%s'\n", argv[i]);
+                exit(1);
+            }
+        } else {
+            fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+        }
+    }
+
+    if(kernel != NULL) {
+        ifs.iterate = ifsSelect(kernel);
+        if(ifs.iterate == NULL) {
+            fprintf(stderr, "Unsupported kernel '%s'\n", kernel);
+            exit(1);
+        }
+    }
+
+    if(!chaosInit(&chaos, &ifs, points, threads)) {
+        fprintf(stderr, "Unable to allocate %ld points\n", points);
+        exit(1);
+    }
+    if(!densityInit(&density, &ifs, size, threads, 1)) {
+        fprintf(stderr, "Unable to allocate a %dx%d density image\n", size, size);
+        exit(1);
+    }
+    printf("%d maps, %ld points on %d thread(s), %s kernel\n",
+           ifs.count, chaos.count, chaos.threads, ifsName(ifs.iterate));
 }
 
 int main(int argc, char** argv) {
@@ -80,7 +217,7 @@ int main(int argc, char** argv) {
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(w, h);
     glutInitWindowPosition(100, 150);
-    glutCreateWindow("Go home Sierpinski, you're drunk");
+    glutCreateWindow(TITLE);
 
     glutDisplayFunc(myDisplay);
     glutIdleFunc(myDisplay);
@@ -89,6 +226,7 @@ int main(int argc, char** argv) {
     glutMotionFunc(myMovedMouse);
     glutKeyboardFunc(myKeyboard);
 
+    myArgs(argc, argv);
     myInit(w, h);
     glutMainLoop();
 
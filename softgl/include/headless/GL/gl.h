@@ -0,0 +1 @@
+#include "../gl.h"
@@ -0,0 +1 @@
+#include "../glu.h"
@@ -0,0 +1 @@
+#include "../glut.h"
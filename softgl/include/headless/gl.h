@@ -0,0 +1,229 @@
+#ifndef SOFTGL_HEADLESS_GL_H_
+#define SOFTGL_HEADLESS_GL_H_
+
+/*
+ * the part of OpenGL 1.x and GLU the demos use, drawn by softgl.  this
+ * directory goes on the include path ahead of the system's so that a demo
+ * built against it runs without a window or a GPU.  calls that are not here
+ * are not supported headless.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef unsigned int GLbitfield;
+typedef void GLvoid;
+typedef signed char GLbyte;
+typedef short GLshort;
+typedef int GLint;
+typedef unsigned char GLubyte;
+typedef unsigned short GLushort;
+typedef unsigned int GLuint;
+typedef int GLsizei;
+typedef float GLfloat;
+typedef float GLclampf;
+typedef double GLdouble;
+typedef double GLclampd;
+
+#define GL_FALSE 0
+#define GL_TRUE 1
+
+/* primitives */
+#define GL_POINTS 0x0000
+#define GL_LINES 0x0001
+#define GL_LINE_LOOP 0x0002
+#define GL_LINE_STRIP 0x0003
+#define GL_TRIANGLES 0x0004
+#define GL_TRIANGLE_STRIP 0x0005
+#define GL_TRIANGLE_FAN 0x0006
+#define GL_QUADS 0x0007
+#define GL_QUAD_STRIP 0x0008
+#define GL_POLYGON 0x0009
+
+/* buffers */
+#define GL_DEPTH_BUFFER_BIT 0x00000100
+#define GL_COLOR_BUFFER_BIT 0x00004000
+
+/* capabilities */
+#define GL_DEPTH_TEST 0x0B71
+#define GL_BLEND 0x0BE2
+#define GL_TEXTURE_2D 0x0DE1
+#define GL_SCISSOR_TEST 0x0C11
+
+/* depth functions */
+#define GL_NEVER 0x0200
+#define GL_LESS 0x0201
+#define GL_EQUAL 0x0202
+#define GL_LEQUAL 0x0203
+#define GL_GREATER 0x0204
+#define GL_NOTEQUAL 0x0205
+#define GL_GEQUAL 0x0206
+#define GL_ALWAYS 0x0207
+
+/* blend factors */
+#define GL_ZERO 0
+#define GL_ONE 1
+#define GL_SRC_COLOR 0x0300
+#define GL_ONE_MINUS_SRC_COLOR 0x0301
+#define GL_SRC_ALPHA 0x0302
+#define GL_ONE_MINUS_SRC_ALPHA 0x0303
+#define GL_DST_ALPHA 0x0304
+#define GL_ONE_MINUS_DST_ALPHA 0x0305
+#define GL_DST_COLOR 0x0306
+#define GL_ONE_MINUS_DST_COLOR 0x0307
+
+/* matrices */
+#define GL_MODELVIEW 0x1700
+#define GL_PROJECTION 0x1701
+#define GL_MATRIX_MODE 0x0BA0
+#define GL_MODELVIEW_MATRIX 0x0BA6
+#define GL_PROJECTION_MATRIX 0x0BA7
+#define GL_VIEWPORT 0x0BA2
+
+/* data types */
+#define GL_BYTE 0x1400
+#define GL_UNSIGNED_BYTE 0x1401
+#define GL_SHORT 0x1402
+#define GL_UNSIGNED_SHORT 0x1403
+#define GL_INT 0x1404
+#define GL_UNSIGNED_INT 0x1405
+#define GL_FLOAT 0x1406
+#define GL_DOUBLE 0x140A
+
+/* vertex arrays */
+#define GL_VERTEX_ARRAY 0x8074
+#define GL_COLOR_ARRAY 0x8076
+#define GL_TEXTURE_COORD_ARRAY 0x8078
+
+/* textures */
+#define GL_RGB 0x1907
+#define GL_RGBA 0x1908
+#define GL_TEXTURE_ENV 0x2300
+#define GL_TEXTURE_ENV_MODE 0x2200
+#define GL_MODULATE 0x2100
+#define GL_REPLACE 0x1E01
+#define GL_TEXTURE_MAG_FILTER 0x2800
+#define GL_TEXTURE_MIN_FILTER 0x2801
+#define GL_TEXTURE_WRAP_S 0x2802
+#define GL_TEXTURE_WRAP_T 0x2803
+#define GL_NEAREST 0x2600
+#define GL_LINEAR 0x2601
+#define GL_REPEAT 0x2901
+#define GL_CLAMP 0x2900
+
+/* display lists */
+#define GL_COMPILE 0x1300
+#define GL_COMPILE_AND_EXECUTE 0x1301
+
+/* render modes */
+#define GL_RENDER 0x1C00
+#define GL_FEEDBACK 0x1C01
+#define GL_SELECT 0x1C02
+
+/* strings */
+#define GL_VENDOR 0x1F00
+#define GL_RENDERER 0x1F01
+#define GL_VERSION 0x1F02
+#define GL_EXTENSIONS 0x1F03
+
+/* drawing */
+void glBegin(GLenum mode);
+void glEnd(void);
+void glVertex2f(GLfloat x, GLfloat y);
+void glVertex2i(GLint x, GLint y);
+void glVertex2d(GLdouble x, GLdouble y);
+void glVertex3f(GLfloat x, GLfloat y, GLfloat z);
+void glVertex3i(GLint x, GLint y, GLint z);
+void glVertex3d(GLdouble x, GLdouble y, GLdouble z);
+void glVertex3fv(const GLfloat* v);
+void glColor3f(GLfloat r, GLfloat g, GLfloat b);
+void glColor4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+void glColor3ub(GLubyte r, GLubyte g, GLubyte b);
+void glColor3fv(const GLfloat* c);
+void glColor4fv(const GLfloat* c);
+void glTexCoord2f(GLfloat s, GLfloat t);
+
+/* state */
+void glClear(GLbitfield mask);
+void glClearColor(GLclampf r, GLclampf g, GLclampf b, GLclampf a);
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+void glScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+void glEnable(GLenum cap);
+void glDisable(GLenum cap);
+GLboolean glIsEnabled(GLenum cap);
+void glDepthFunc(GLenum func);
+void glBlendFunc(GLenum src, GLenum dst);
+void glPointSize(GLfloat size);
+void glLineWidth(GLfloat width);
+void glFlush(void);
+void glFinish(void);
+void glGetFloatv(GLenum name, GLfloat* params);
+void glGetIntegerv(GLenum name, GLint* params);
+const GLubyte* glGetString(GLenum name);
+
+/* matrices */
+void glMatrixMode(GLenum mode);
+void glLoadIdentity(void);
+void glLoadMatrixf(const GLfloat* m);
+void glMultMatrixf(const GLfloat* m);
+void glMultMatrixd(const GLdouble* m);
+void glPushMatrix(void);
+void glPopMatrix(void);
+void glTranslatef(GLfloat x, GLfloat y, GLfloat z);
+void glTranslated(GLdouble x, GLdouble y, GLdouble z);
+void glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z);
+void glRotated(GLdouble angle, GLdouble x, GLdouble y, GLdouble z);
+void glScalef(GLfloat x, GLfloat y, GLfloat z);
+void glScaled(GLdouble x, GLdouble y, GLdouble z);
+void glOrtho(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble zNear, GLdouble zFar);
+void glFrustum(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble zNear, GLdouble zFar);
+
+/* vertex arrays */
+void glEnableClientState(GLenum array);
+void glDisableClientState(GLenum array);
+void glVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+void glColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+void glTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+
+/* textures, RGBA or RGB unsigned bytes only */
+void glGenTextures(GLsizei n, GLuint* textures);
+void glDeleteTextures(GLsizei n, const GLuint* textures);
+void glBindTexture(GLenum target, GLuint texture);
+void glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+                  GLint border, GLenum format, GLenum type, const GLvoid* pixels);
+void glTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                     GLenum format, GLenum type, const GLvoid* pixels);
+void glTexParameteri(GLenum target, GLenum name, GLint param);
+void glTexEnvi(GLenum target, GLenum name, GLint param);
+
+/* display lists */
+GLuint glGenLists(GLsizei range);
+void glDeleteLists(GLuint list, GLsizei range);
+void glNewList(GLuint list, GLenum mode);
+void glEndList(void);
+void glCallList(GLuint list);
+
+/* selection */
+void glSelectBuffer(GLsizei size, GLuint* buffer);
+GLint glRenderMode(GLenum mode);
+void glInitNames(void);
+void glPushName(GLuint name);
+void glPopName(void);
+void glLoadName(GLuint name);
+
+/* GLU */
+void gluOrtho2D(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top);
+void gluPerspective(GLdouble fovy, GLdouble aspect, GLdouble zNear, GLdouble zFar);
+void gluLookAt(GLdouble eyeX, GLdouble eyeY, GLdouble eyeZ, GLdouble centerX, GLdouble centerY,
+               GLdouble centerZ, GLdouble upX, GLdouble upY, GLdouble upZ);
+void gluPickMatrix(GLdouble x, GLdouble y, GLdouble width, GLdouble height, GLint* viewport);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*SOFTGL_HEADLESS_GL_H_*/
@@ -0,0 +1,91 @@
+#ifndef SOFTGL_HEADLESS_GLUT_H_
+#define SOFTGL_HEADLESS_GLUT_H_
+
+/* the real glut.h pulls in stdlib.h, and programs come to rely on it */
+#include <stdlib.h>
+
+#include "gl.h"
+
+/*
+ * GLUT without a window.  glutCreateWindow makes a softgl framebuffer and
+ * glutMainLoop runs a fixed number of ticks on a virtual clock of 60 ticks a
+ * second, so timers, idle callbacks and GLUT_ELAPSED_TIME are the same on
+ * every run.  each tick delivers the scripted input for it, fires due timers,
+ * redisplays if asked to and calls the idle callback, then the loop exits.
+ * glutInit takes these options off the command line:
+ *   -frames <n>: ticks to run, 60 by default
+ *   -ppm <prefix>: write every swapped frame to <prefix>NNNNN.ppm
+ *   -input <file>: scripted input, one event per line in tick order:
+ *       <tick> key <char or decimal code>
+ *       <tick> mouse <left|middle|right> <down|up> <x> <y>
+ *       <tick> motion <x> <y>
+ *       <tick> passive <x> <y>
+ * every swapped frame's checksum is printed to stderr.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* display modes, accepted and ignored */
+#define GLUT_RGB 0
+#define GLUT_RGBA 0
+#define GLUT_SINGLE 0
+#define GLUT_DOUBLE 2
+#define GLUT_ALPHA 8
+#define GLUT_DEPTH 16
+
+/* mouse */
+#define GLUT_LEFT_BUTTON 0
+#define GLUT_MIDDLE_BUTTON 1
+#define GLUT_RIGHT_BUTTON 2
+#define GLUT_DOWN 0
+#define GLUT_UP 1
+
+/* glutGet */
+#define GLUT_WINDOW_X 100
+#define GLUT_WINDOW_Y 101
+#define GLUT_WINDOW_WIDTH 102
+#define GLUT_WINDOW_HEIGHT 103
+#define GLUT_ELAPSED_TIME 700
+
+/* cursors, accepted and ignored */
+#define GLUT_CURSOR_INHERIT 100
+#define GLUT_CURSOR_NONE 101
+
+void glutInit(int* argc, char** argv);
+void glutInitDisplayMode(unsigned int mode);
+void glutInitWindowSize(int width, int height);
+void glutInitWindowPosition(int x, int y);
+int glutCreateWindow(const char* title);
+void glutSetWindowTitle(const char* title);
+void glutSetCursor(int cursor);
+
+void glutDisplayFunc(void (*func)(void));
+void glutReshapeFunc(void (*func)(int width, int height));
+void glutKeyboardFunc(void (*func)(unsigned char key, int x, int y));
+void glutMouseFunc(void (*func)(int button, int state, int x, int y));
+void glutMotionFunc(void (*func)(int x, int y));
+void glutPassiveMotionFunc(void (*func)(int x, int y));
+void glutIdleFunc(void (*func)(void));
+void glutTimerFunc(unsigned int millis, void (*func)(int value), int value);
+
+void glutMainLoop(void);
+void glutPostRedisplay(void);
+void glutSwapBuffers(void);
+int glutGet(GLenum state);
+
+/* menus never open headless, they only hand out ids */
+int glutCreateMenu(void (*func)(int value));
+void glutAddMenuEntry(const char* label, int value);
+void glutAddSubMenu(const char* label, int menu);
+void glutAttachMenu(int button);
+
+void glutSolidCube(GLdouble size);
+void glutWireCube(GLdouble size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*SOFTGL_HEADLESS_GLUT_H_*/
@@ -0,0 +1,188 @@
+#ifndef SOFTGL_H_
+#define SOFTGL_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * softgl: a small software rasterizer with an immediate mode interface
+ * modelled on fixed-function GL.  it draws points, lines, triangles, quads,
+ * quad strips and polygons with smooth colors, an optional texture, blending
+ * and a depth test into an RGBA framebuffer that can be written out as a PPM.
+ * there is a single global context, like GL's.
+ *
+ * every enum below has the value of its GL counterpart, so a GL facade can
+ * pass them straight through.
+ */
+
+/* primitives */
+#define SGL_POINTS 0x0000
+#define SGL_LINES 0x0001
+#define SGL_LINE_LOOP 0x0002
+#define SGL_LINE_STRIP 0x0003
+#define SGL_TRIANGLES 0x0004
+#define SGL_TRIANGLE_STRIP 0x0005
+#define SGL_TRIANGLE_FAN 0x0006
+#define SGL_QUADS 0x0007
+#define SGL_QUAD_STRIP 0x0008
+#define SGL_POLYGON 0x0009
+
+/* capabilities */
+#define SGL_DEPTH_TEST 0x0B71
+#define SGL_BLEND 0x0BE2
+#define SGL_TEXTURE_2D 0x0DE1
+#define SGL_SCISSOR_TEST 0x0C11
+
+/* depth functions */
+#define SGL_NEVER 0x0200
+#define SGL_LESS 0x0201
+#define SGL_EQUAL 0x0202
+#define SGL_LEQUAL 0x0203
+#define SGL_GREATER 0x0204
+#define SGL_NOTEQUAL 0x0205
+#define SGL_GEQUAL 0x0206
+#define SGL_ALWAYS 0x0207
+
+/* blend factors */
+#define SGL_ZERO 0
+#define SGL_ONE 1
+#define SGL_SRC_COLOR 0x0300
+#define SGL_ONE_MINUS_SRC_COLOR 0x0301
+#define SGL_SRC_ALPHA 0x0302
+#define SGL_ONE_MINUS_SRC_ALPHA 0x0303
+#define SGL_DST_ALPHA 0x0304
+#define SGL_ONE_MINUS_DST_ALPHA 0x0305
+#define SGL_DST_COLOR 0x0306
+#define SGL_ONE_MINUS_DST_COLOR 0x0307
+
+/* matrix stacks */
+#define SGL_MODELVIEW 0x1700
+#define SGL_PROJECTION 0x1701
+
+/* texture environment */
+#define SGL_MODULATE 0x2100
+#define SGL_REPLACE 0x1E01
+
+/* render modes */
+#define SGL_RENDER 0x1C00
+#define SGL_SELECT 0x1C02
+
+/* entries per matrix stack */
+#define SGL_STACK_DEPTH 32
+
+/* entries in the selection name stack */
+#define SGL_NAME_DEPTH 64
+
+/*
+ * (re)create the framebuffer at width x height and reset all state.  the
+ * viewport covers the whole framebuffer.  returns 0 on failure
+ */
+int sglInit(int width, int height);
+
+/*
+ * release the framebuffer and textures
+ */
+void sglFree(void);
+
+int sglWidth(void);
+int sglHeight(void);
+
+/*
+ * the framebuffer, RGBA bytes, bottom row first like glReadPixels
+ */
+const unsigned char* sglPixels(void);
+
+/*
+ * write the framebuffer as a binary PPM, top row first.  returns 0 on failure
+ */
+int sglWritePPM(const char* path);
+
+/*
+ * hash of the framebuffer's colors, for comparing frames without files
+ */
+uint64_t sglChecksum(void);
+
+void sglViewport(int x, int y, int width, int height);
+void sglGetViewport(int viewport[4]);
+
+/*
+ * with SGL_SCISSOR_TEST enabled, drawing and clearing only touch the pixels
+ * in this box
+ */
+void sglScissor(int x, int y, int width, int height);
+void sglClearColor(float r, float g, float b, float a);
+void sglClear(int color, int depth);
+
+void sglEnable(int cap, int on);
+int sglIsEnabled(int cap);
+void sglDepthFunc(int func);
+void sglBlendFunc(int src, int dst);
+void sglPointSize(float size);
+void sglLineWidth(float width);
+
+/*
+ * matrices are column major, as GL keeps them
+ */
+void sglMatrixMode(int mode);
+void sglLoadIdentity(void);
+void sglLoadMatrixf(const float m[16]);
+void sglMultMatrixf(const float m[16]);
+void sglPushMatrix(void);
+void sglPopMatrix(void);
+void sglGetMatrixf(int mode, float m[16]);
+
+/*
+ * build the matrices glTranslate, glRotate (angle in degrees), glScale,
+ * glOrtho, glFrustum, gluPerspective, gluLookAt and gluPickMatrix multiply by
+ */
+void sglMatTranslate(float m[16], float x, float y, float z);
+void sglMatRotate(float m[16], float angle, float x, float y, float z);
+void sglMatScale(float m[16], float x, float y, float z);
+void sglMatOrtho(float m[16], float left, float right, float bottom, float top, float zNear, float zFar);
+void sglMatFrustum(float m[16], float left, float right, float bottom, float top, float zNear, float zFar);
+void sglMatPerspective(float m[16], float fovy, float aspect, float zNear, float zFar);
+void sglMatLookAt(float m[16], float eyeX, float eyeY, float eyeZ,
+                  float centerX, float centerY, float centerZ, float upX, float upY, float upZ);
+void sglMatPick(float m[16], float x, float y, float width, float height, const int viewport[4]);
+
+/*
+ * immediate mode.  vertices between sglBegin and sglEnd are transformed as
+ * they arrive and assembled into primitives at sglEnd.
+ */
+void sglBegin(int mode);
+void sglEnd(void);
+void sglVertex4f(float x, float y, float z, float w);
+void sglColor4f(float r, float g, float b, float a);
+void sglTexCoord2f(float s, float t);
+
+/*
+ * textures are RGBA bytes, sampled nearest with repeat.  texture 0 is none.
+ */
+unsigned int sglGenTexture(void);
+void sglDeleteTexture(unsigned int texture);
+void sglBindTexture(unsigned int texture);
+int sglTexImage(int width, int height, const unsigned char* rgba);
+void sglTexSubImage(int x, int y, int width, int height, const unsigned char* rgba);
+void sglTexEnv(int mode);
+
+/*
+ * selection.  in SGL_SELECT mode nothing is drawn, instead every change of
+ * the name stack after a primitive survived clipping writes a GL hit record
+ * (name count, min z, max z, names) to the buffer.  leaving the mode returns
+ * the number of hits, -1 if the buffer overflowed.
+ */
+void sglSelectBuffer(int size, unsigned int* buffer);
+int sglRenderMode(int mode);
+void sglInitNames(void);
+void sglPushName(unsigned int name);
+void sglPopName(void);
+void sglLoadName(unsigned int name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*SOFTGL_H_*/
@@ -0,0 +1,600 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "softgl.h"
+#include "headless/gl.h"
+
+/* nested glCallList limit, as in most GL implementations */
+#define LIST_NESTING 64
+
+/* initial commands in a display list */
+#define LIST_INITIAL 64
+
+/* what a display list can hold */
+enum {
+  OP_BEGIN, OP_END, OP_VERTEX, OP_COLOR, OP_TEXCOORD,
+  OP_MATRIX_MODE, OP_LOAD_IDENTITY, OP_LOAD, OP_MULT, OP_PUSH, OP_POP,
+  OP_ENABLE, OP_DISABLE, OP_DEPTH_FUNC, OP_BLEND_FUNC, OP_POINT_SIZE, OP_LINE_WIDTH,
+  OP_BIND_TEXTURE, OP_CALL, OP_INIT_NAMES, OP_PUSH_NAME, OP_POP_NAME, OP_LOAD_NAME
+};
+
+typedef struct {
+  int op;
+  unsigned int u[2];
+  float f[16];
+} command_t;
+
+typedef struct {
+  command_t* commands;
+  int count, capacity;
+} list_t;
+
+static list_t* lists = NULL;
+static int numLists = 0;
+
+/* the list being compiled, 0 if none */
+static unsigned int compiling = 0;
+static int compileOnly = 0;
+
+/* a client side array */
+typedef struct {
+  int enabled;
+  int size;
+  GLenum type;
+  int stride;
+  const unsigned char* pointer;
+} array_t;
+
+static array_t vertexArray, colorArray, texCoordArray;
+
+/*
+ * append a command to the list being compiled, NULL if there is none
+ */
+static command_t* record(int op) {
+  if(compiling == 0) return NULL;
+
+  list_t* l = &lists[compiling - 1];
+  if(l->count == l->capacity) {
+    const int capacity = l->capacity ? 2 * l->capacity : LIST_INITIAL;
+    command_t* commands = (command_t*) realloc(l->commands, capacity * sizeof(command_t));
+    if(commands == NULL) return NULL;
+    l->commands = commands;
+    l->capacity = capacity;
+  }
+
+  command_t* c = &l->commands[l->count++];
+  c->op = op;
+  return c;
+}
+
+/*
+ * record op with up to four float arguments, returns 1 if it must not run now
+ */
+static int record4f(int op, float a, float b, float c, float d) {
+  command_t* cmd = record(op);
+  if(cmd != NULL) {
+    cmd->f[0] = a;
+    cmd->f[1] = b;
+    cmd->f[2] = c;
+    cmd->f[3] = d;
+  }
+  return compiling && compileOnly;
+}
+
+static int record2u(int op, unsigned int a, unsigned int b) {
+  command_t* cmd = record(op);
+  if(cmd != NULL) {
+    cmd->u[0] = a;
+    cmd->u[1] = b;
+  }
+  return compiling && compileOnly;
+}
+
+static void callList(unsigned int list, int depth);
+
+static void execute(const command_t* c, int depth) {
+  switch(c->op) {
+  case OP_BEGIN: sglBegin(c->u[0]); break;
+  case OP_END: sglEnd(); break;
+  case OP_VERTEX: sglVertex4f(c->f[0], c->f[1], c->f[2], c->f[3]); break;
+  case OP_COLOR: sglColor4f(c->f[0], c->f[1], c->f[2], c->f[3]); break;
+  case OP_TEXCOORD: sglTexCoord2f(c->f[0], c->f[1]); break;
+  case OP_MATRIX_MODE: sglMatrixMode(c->u[0]); break;
+  case OP_LOAD_IDENTITY: sglLoadIdentity(); break;
+  case OP_LOAD: sglLoadMatrixf(c->f); break;
+  case OP_MULT: sglMultMatrixf(c->f); break;
+  case OP_PUSH: sglPushMatrix(); break;
+  case OP_POP: sglPopMatrix(); break;
+  case OP_ENABLE: sglEnable(c->u[0], 1); break;
+  case OP_DISABLE: sglEnable(c->u[0], 0); break;
+  case OP_DEPTH_FUNC: sglDepthFunc(c->u[0]); break;
+  case OP_BLEND_FUNC: sglBlendFunc(c->u[0], c->u[1]); break;
+  case OP_POINT_SIZE: sglPointSize(c->f[0]); break;
+  case OP_LINE_WIDTH: sglLineWidth(c->f[0]); break;
+  case OP_BIND_TEXTURE: sglBindTexture(c->u[0]); break;
+  case OP_CALL: callList(c->u[0], depth + 1); break;
+  case OP_INIT_NAMES: sglInitNames(); break;
+  case OP_PUSH_NAME: sglPushName(c->u[0]); break;
+  case OP_POP_NAME: sglPopName(); break;
+  case OP_LOAD_NAME: sglLoadName(c->u[0]); break;
+  }
+}
+
+static void callList(unsigned int list, int depth) {
+  if(list == 0 || list > (unsigned int) numLists || depth > LIST_NESTING) return;
+  const list_t* l = &lists[list - 1];
+  for(int i = 0; i < l->count; i++) execute(&l->commands[i], depth);
+}
+
+/*
+ * drawing
+ */
+
+void glBegin(GLenum mode) {
+  if(record2u(OP_BEGIN, mode, 0)) return;
+  sglBegin(mode);
+}
+
+void glEnd(void) {
+  if(record2u(OP_END, 0, 0)) return;
+  sglEnd();
+}
+
+static void vertex(float x, float y, float z) {
+  if(record4f(OP_VERTEX, x, y, z, 1.0f)) return;
+  sglVertex4f(x, y, z, 1.0f);
+}
+
+void glVertex2f(GLfloat x, GLfloat y) { vertex(x, y, 0.0f); }
+void glVertex2i(GLint x, GLint y) { vertex((float) x, (float) y, 0.0f); }
+void glVertex2d(GLdouble x, GLdouble y) { vertex((float) x, (float) y, 0.0f); }
+void glVertex3f(GLfloat x, GLfloat y, GLfloat z) { vertex(x, y, z); }
+void glVertex3i(GLint x, GLint y, GLint z) { vertex((float) x, (float) y, (float) z); }
+void glVertex3d(GLdouble x, GLdouble y, GLdouble z) { vertex((float) x, (float) y, (float) z); }
+void glVertex3fv(const GLfloat* v) { vertex(v[0], v[1], v[2]); }
+
+void glColor4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+  if(record4f(OP_COLOR, r, g, b, a)) return;
+  sglColor4f(r, g, b, a);
+}
+
+void glColor3f(GLfloat r, GLfloat g, GLfloat b) { glColor4f(r, g, b, 1.0f); }
+void glColor3ub(GLubyte r, GLubyte g, GLubyte b) { glColor4f(r / 255.0f, g / 255.0f, b / 255.0f, 1.0f); }
+void glColor3fv(const GLfloat* c) { glColor4f(c[0], c[1], c[2], 1.0f); }
+void glColor4fv(const GLfloat* c) { glColor4f(c[0], c[1], c[2], c[3]); }
+
+void glTexCoord2f(GLfloat s, GLfloat t) {
+  if(record4f(OP_TEXCOORD, s, t, 0.0f, 0.0f)) return;
+  sglTexCoord2f(s, t);
+}
+
+/*
+ * state
+ */
+
+void glClear(GLbitfield mask) {
+  sglClear((mask & GL_COLOR_BUFFER_BIT) != 0, (mask & GL_DEPTH_BUFFER_BIT) != 0);
+}
+
+void glClearColor(GLclampf r, GLclampf g, GLclampf b, GLclampf a) {
+  sglClearColor(r, g, b, a);
+}
+
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+  sglViewport(x, y, width, height);
+}
+
+void glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+  sglScissor(x, y, width, height);
+}
+
+void glEnable(GLenum cap) {
+  if(record2u(OP_ENABLE, cap, 0)) return;
+  sglEnable(cap, 1);
+}
+
+void glDisable(GLenum cap) {
+  if(record2u(OP_DISABLE, cap, 0)) return;
+  sglEnable(cap, 0);
+}
+
+GLboolean glIsEnabled(GLenum cap) {
+  return (GLboolean) sglIsEnabled(cap);
+}
+
+void glDepthFunc(GLenum func) {
+  if(record2u(OP_DEPTH_FUNC, func, 0)) return;
+  sglDepthFunc(func);
+}
+
+void glBlendFunc(GLenum src, GLenum dst) {
+  if(record2u(OP_BLEND_FUNC, src, dst)) return;
+  sglBlendFunc(src, dst);
+}
+
+void glPointSize(GLfloat size) {
+  if(record4f(OP_POINT_SIZE, size, 0.0f, 0.0f, 0.0f)) return;
+  sglPointSize(size);
+}
+
+void glLineWidth(GLfloat width) {
+  if(record4f(OP_LINE_WIDTH, width, 0.0f, 0.0f, 0.0f)) return;
+  sglLineWidth(width);
+}
+
+void glFlush(void) {
+}
+
+void glFinish(void) {
+}
+
+void glGetFloatv(GLenum name, GLfloat* params) {
+  switch(name) {
+  case GL_MODELVIEW_MATRIX: sglGetMatrixf(SGL_MODELVIEW, params); break;
+  case GL_PROJECTION_MATRIX: sglGetMatrixf(SGL_PROJECTION, params); break;
+  }
+}
+
+void glGetIntegerv(GLenum name, GLint* params) {
+  switch(name) {
+  case GL_VIEWPORT: sglGetViewport(params); break;
+  }
+}
+
+const GLubyte* glGetString(GLenum name) {
+  switch(name) {
+  case GL_VENDOR: return (const GLubyte*) "opengl-play";
+  case GL_RENDERER: return (const GLubyte*) "softgl";
+  case GL_VERSION: return (const GLubyte*) "1.1 softgl";
+  }
+  return (const GLubyte*) "";
+}
+
+/*
+ * matrices
+ */
+
+void glMatrixMode(GLenum mode) {
+  if(record2u(OP_MATRIX_MODE, mode, 0)) return;
+  sglMatrixMode(mode);
+}
+
+void glLoadIdentity(void) {
+  if(record2u(OP_LOAD_IDENTITY, 0, 0)) return;
+  sglLoadIdentity();
+}
+
+void glLoadMatrixf(const GLfloat* m) {
+  command_t* c = record(OP_LOAD);
+  if(c != NULL) memcpy(c->f, m, 16 * sizeof(float));
+  if(compiling && compileOnly) return;
+  sglLoadMatrixf(m);
+}
+
+void glMultMatrixf(const GLfloat* m) {
+  command_t* c = record(OP_MULT);
+  if(c != NULL) memcpy(c->f, m, 16 * sizeof(float));
+  if(compiling && compileOnly) return;
+  sglMultMatrixf(m);
+}
+
+void glMultMatrixd(const GLdouble* m) {
+  float f[16];
+  for(int i = 0; i < 16; i++) f[i] = (float) m[i];
+  glMultMatrixf(f);
+}
+
+void glPushMatrix(void) {
+  if(record2u(OP_PUSH, 0, 0)) return;
+  sglPushMatrix();
+}
+
+void glPopMatrix(void) {
+  if(record2u(OP_POP, 0, 0)) return;
+  sglPopMatrix();
+}
+
+void glTranslatef(GLfloat x, GLfloat y, GLfloat z) {
+  float m[16];
+  sglMatTranslate(m, x, y, z);
+  glMultMatrixf(m);
+}
+
+void glTranslated(GLdouble x, GLdouble y, GLdouble z) {
+  glTranslatef((float) x, (float) y, (float) z);
+}
+
+void glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z) {
+  float m[16];
+  sglMatRotate(m, angle, x, y, z);
+  glMultMatrixf(m);
+}
+
+void glRotated(GLdouble angle, GLdouble x, GLdouble y, GLdouble z) {
+  glRotatef((float) angle, (float) x, (float) y, (float) z);
+}
+
+void glScalef(GLfloat x, GLfloat y, GLfloat z) {
+  float m[16];
+  sglMatScale(m, x, y, z);
+  glMultMatrixf(m);
+}
+
+void glScaled(GLdouble x, GLdouble y, GLdouble z) {
+  glScalef((float) x, (float) y, (float) z);
+}
+
+void glOrtho(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble zNear, GLdouble zFar) {
+  float m[16];
+  sglMatOrtho(m, left, right, bottom, top, zNear, zFar);
+  glMultMatrixf(m);
+}
+
+void glFrustum(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble zNear, GLdouble zFar) {
+  float m[16];
+  sglMatFrustum(m, left, right, bottom, top, zNear, zFar);
+  glMultMatrixf(m);
+}
+
+/*
+ * vertex arrays
+ */
+
+static array_t* clientArray(GLenum array) {
+  switch(array) {
+  case GL_VERTEX_ARRAY: return &vertexArray;
+  case GL_COLOR_ARRAY: return &colorArray;
+  case GL_TEXTURE_COORD_ARRAY: return &texCoordArray;
+  }
+  return NULL;
+}
+
+void glEnableClientState(GLenum array) {
+  array_t* a = clientArray(array);
+  if(a) a->enabled = 1;
+}
+
+void glDisableClientState(GLenum array) {
+  array_t* a = clientArray(array);
+  if(a) a->enabled = 0;
+}
+
+static int typeSize(GLenum type) {
+  switch(type) {
+  case GL_BYTE: case GL_UNSIGNED_BYTE: return 1;
+  case GL_SHORT: case GL_UNSIGNED_SHORT: return 2;
+  case GL_DOUBLE: return 8;
+  }
+  return 4;
+}
+
+static void setArray(array_t* a, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) {
+  a->size = size;
+  a->type = type;
+  a->stride = stride ? stride : size * typeSize(type);
+  a->pointer = (const unsigned char*) pointer;
+}
+
+void glVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) {
+  setArray(&vertexArray, size, type, stride, pointer);
+}
+
+void glColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) {
+  setArray(&colorArray, size, type, stride, pointer);
+}
+
+void glTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) {
+  setArray(&texCoordArray, size, type, stride, pointer);
+}
+
+/*
+ * component k of element i, integer colors normalized the way GL does
+ */
+static float element(const array_t* a, int i, int k, int normalize) {
+  const unsigned char* p = a->pointer + (size_t) i * a->stride;
+  switch(a->type) {
+  case GL_UNSIGNED_BYTE: return normalize ? p[k] / 255.0f : p[k];
+  case GL_BYTE: return ((const signed char*) p)[k];
+  case GL_SHORT: return ((const short*) p)[k];
+  case GL_UNSIGNED_SHORT: return ((const unsigned short*) p)[k];
+  case GL_INT: return (float) ((const int*) p)[k];
+  case GL_UNSIGNED_INT: return (float) ((const unsigned int*) p)[k];
+  case GL_DOUBLE: return (float) ((const double*) p)[k];
+  }
+  return ((const float*) p)[k];
+}
+
+void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
+  if(!vertexArray.enabled) return;
+
+  glBegin(mode);
+  for(int i = first; i < first + count; i++) {
+    if(colorArray.enabled) {
+      glColor4f(element(&colorArray, i, 0, 1), element(&colorArray, i, 1, 1), element(&colorArray, i, 2, 1),
+                colorArray.size > 3 ? element(&colorArray, i, 3, 1) : 1.0f);
+    }
+    if(texCoordArray.enabled) {
+      glTexCoord2f(element(&texCoordArray, i, 0, 0), element(&texCoordArray, i, 1, 0));
+    }
+    vertex(element(&vertexArray, i, 0, 0), element(&vertexArray, i, 1, 0),
+           vertexArray.size > 2 ? element(&vertexArray, i, 2, 0) : 0.0f);
+  }
+  glEnd();
+}
+
+/*
+ * textures
+ */
+
+void glGenTextures(GLsizei n, GLuint* textures) {
+  for(int i = 0; i < n; i++) textures[i] = sglGenTexture();
+}
+
+void glDeleteTextures(GLsizei n, const GLuint* textures) {
+  for(int i = 0; i < n; i++) sglDeleteTexture(textures[i]);
+}
+
+void glBindTexture(GLenum target, GLuint texture) {
+  (void) target;
+  if(record2u(OP_BIND_TEXTURE, texture, 0)) return;
+  sglBindTexture(texture);
+}
+
+/*
+ * RGBA copy of RGB or RGBA unsigned bytes, NULL for anything else
+ */
+static unsigned char* toRGBA(GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels) {
+  if(type != GL_UNSIGNED_BYTE || (format != GL_RGB && format != GL_RGBA) || pixels == NULL) return NULL;
+
+  const size_t n = (size_t) width * height;
+  unsigned char* rgba = (unsigned char*) malloc(n * 4);
+  if(rgba == NULL) return NULL;
+
+  const unsigned char* p = (const unsigned char*) pixels;
+  if(format == GL_RGBA) {
+    memcpy(rgba, p, n * 4);
+  } else {
+    for(size_t i = 0; i < n; i++) {
+      memcpy(&rgba[i * 4], &p[i * 3], 3);
+      rgba[i * 4 + 3] = 255;
+    }
+  }
+  return rgba;
+}
+
+void glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+                  GLint border, GLenum format, GLenum type, const GLvoid* pixels) {
+  (void) target;
+  (void) internalFormat;
+  (void) border;
+  if(level != 0) return;
+
+  unsigned char* rgba = toRGBA(width, height, format, type, pixels);
+  sglTexImage(width, height, rgba);
+  free(rgba);
+}
+
+void glTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                     GLenum format, GLenum type, const GLvoid* pixels) {
+  (void) target;
+  if(level != 0) return;
+
+  /* the common case needs no copy */
+  if(format == GL_RGBA && type == GL_UNSIGNED_BYTE) {
+    sglTexSubImage(x, y, width, height, (const unsigned char*) pixels);
+    return;
+  }
+  unsigned char* rgba = toRGBA(width, height, format, type, pixels);
+  if(rgba) sglTexSubImage(x, y, width, height, rgba);
+  free(rgba);
+}
+
+void glTexParameteri(GLenum target, GLenum name, GLint param) {
+  /* always nearest and repeat */
+  (void) target;
+  (void) name;
+  (void) param;
+}
+
+void glTexEnvi(GLenum target, GLenum name, GLint param) {
+  if(target == GL_TEXTURE_ENV && name == GL_TEXTURE_ENV_MODE) sglTexEnv(param);
+}
+
+/*
+ * display lists
+ */
+
+GLuint glGenLists(GLsizei range) {
+  if(range <= 0) return 0;
+  list_t* l = (list_t*) realloc(lists, (numLists + range) * sizeof(list_t));
+  if(l == NULL) return 0;
+  lists = l;
+  memset(&lists[numLists], 0, range * sizeof(list_t));
+
+  const GLuint first = numLists + 1;
+  numLists += range;
+  return first;
+}
+
+void glDeleteLists(GLuint list, GLsizei range) {
+  for(GLuint i = list; i < list + range && i <= (GLuint) numLists; i++) {
+    if(i == 0) continue;
+    free(lists[i - 1].commands);
+    memset(&lists[i - 1], 0, sizeof(list_t));
+  }
+}
+
+void glNewList(GLuint list, GLenum mode) {
+  if(list == 0 || list > (GLuint) numLists || compiling) return;
+  lists[list - 1].count = 0;
+  compiling = list;
+  compileOnly = mode == GL_COMPILE;
+}
+
+void glEndList(void) {
+  compiling = 0;
+}
+
+void glCallList(GLuint list) {
+  if(record2u(OP_CALL, list, 0)) return;
+  callList(list, 0);
+}
+
+/*
+ * selection
+ */
+
+void glSelectBuffer(GLsizei size, GLuint* buffer) {
+  sglSelectBuffer(size, buffer);
+}
+
+GLint glRenderMode(GLenum mode) {
+  return sglRenderMode(mode);
+}
+
+void glInitNames(void) {
+  if(record2u(OP_INIT_NAMES, 0, 0)) return;
+  sglInitNames();
+}
+
+void glPushName(GLuint name) {
+  if(record2u(OP_PUSH_NAME, name, 0)) return;
+  sglPushName(name);
+}
+
+void glPopName(void) {
+  if(record2u(OP_POP_NAME, 0, 0)) return;
+  sglPopName();
+}
+
+void glLoadName(GLuint name) {
+  if(record2u(OP_LOAD_NAME, name, 0)) return;
+  sglLoadName(name);
+}
+
+/*
+ * GLU
+ */
+
+void gluOrtho2D(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top) {
+  glOrtho(left, right, bottom, top, -1.0, 1.0);
+}
+
+void gluPerspective(GLdouble fovy, GLdouble aspect, GLdouble zNear, GLdouble zFar) {
+  float m[16];
+  sglMatPerspective(m, fovy, aspect, zNear, zFar);
+  glMultMatrixf(m);
+}
+
+void gluLookAt(GLdouble eyeX, GLdouble eyeY, GLdouble eyeZ, GLdouble centerX, GLdouble centerY,
+               GLdouble centerZ, GLdouble upX, GLdouble upY, GLdouble upZ) {
+  float m[16];
+  sglMatLookAt(m, eyeX, eyeY, eyeZ, centerX, centerY, centerZ, upX, upY, upZ);
+  glMultMatrixf(m);
+}
+
+void gluPickMatrix(GLdouble x, GLdouble y, GLdouble width, GLdouble height, GLint* viewport) {
+  float m[16];
+  sglMatPick(m, x, y, width, height, viewport);
+  glMultMatrixf(m);
+}
@@ -0,0 +1,317 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "softgl.h"
+#include "headless/glut.h"
+
+/* ticks of the virtual clock per second */
+#define TICKS_PER_SECOND 60
+
+/* ticks glutMainLoop runs unless -frames says otherwise */
+#define FRAMES_INITIAL 60
+
+/* timers that may be pending at once */
+#define MAX_TIMERS 64
+
+/* a scripted input event */
+typedef struct {
+  int tick;
+  enum { EVENT_KEY, EVENT_MOUSE, EVENT_MOTION, EVENT_PASSIVE } type;
+  int key, button, state, x, y;
+} event_t;
+
+typedef struct {
+  void (*func)(int value);
+  int value;
+  double due;
+
+  /* set by glutTimerFunc calls from a timer, which wait for the next tick */
+  int fresh;
+} pending_t;
+
+/* options taken off the command line */
+static struct {
+  int frames;
+  const char* ppm;
+  const char* input;
+} options = { FRAMES_INITIAL, NULL, NULL };
+
+static int width = 300, height = 300;
+static int tick = 0;
+static int redisplay = 0;
+static int swaps = 0;
+
+static void (*displayFunc)(void);
+static void (*reshapeFunc)(int, int);
+static void (*keyboardFunc)(unsigned char, int, int);
+static void (*mouseFunc)(int, int, int, int);
+static void (*motionFunc)(int, int);
+static void (*passiveFunc)(int, int);
+static void (*idleFunc)(void);
+
+static pending_t timers[MAX_TIMERS];
+static int numTimers = 0;
+static int firing = 0;
+
+static event_t* events = NULL;
+static int numEvents = 0;
+
+static int menus = 0;
+
+/* milliseconds on the virtual clock */
+static double elapsed(void) {
+  return tick * 1000.0 / TICKS_PER_SECOND;
+}
+
+void glutInit(int* argc, char** argv) {
+  int kept = 1;
+  for(int i = 1; i < *argc; i++) {
+    if(strcmp(argv[i], "-frames") == 0 && i + 1 < *argc) {
+      options.frames = atoi(argv[++i]);
+    } else if(strcmp(argv[i], "-ppm") == 0 && i + 1 < *argc) {
+      options.ppm = argv[++i];
+    } else if(strcmp(argv[i], "-input") == 0 && i + 1 < *argc) {
+      options.input = argv[++i];
+    } else {
+      argv[kept++] = argv[i];
+    }
+  }
+  *argc = kept;
+  argv[kept] = NULL;
+}
+
+void glutInitDisplayMode(unsigned int mode) {
+  (void) mode;
+}
+
+void glutInitWindowSize(int w, int h) {
+  width = w;
+  height = h;
+}
+
+void glutInitWindowPosition(int x, int y) {
+  (void) x;
+  (void) y;
+}
+
+int glutCreateWindow(const char* title) {
+  (void) title;
+  if(!sglInit(width, height)) {
+    fprintf(stderr, "Unable to allocate a %dx%d framebuffer\n", width, height);
+    exit(1);
+  }
+  redisplay = 1;
+  return 1;
+}
+
+void glutSetWindowTitle(const char* title) {
+  (void) title;
+}
+
+void glutSetCursor(int cursor) {
+  (void) cursor;
+}
+
+void glutDisplayFunc(void (*func)(void)) { displayFunc = func; }
+void glutReshapeFunc(void (*func)(int, int)) { reshapeFunc = func; }
+void glutKeyboardFunc(void (*func)(unsigned char, int, int)) { keyboardFunc = func; }
+void glutMouseFunc(void (*func)(int, int, int, int)) { mouseFunc = func; }
+void glutMotionFunc(void (*func)(int, int)) { motionFunc = func; }
+void glutPassiveMotionFunc(void (*func)(int, int)) { passiveFunc = func; }
+void glutIdleFunc(void (*func)(void)) { idleFunc = func; }
+
+void glutTimerFunc(unsigned int millis, void (*func)(int value), int value) {
+  if(numTimers == MAX_TIMERS) return;
+  timers[numTimers].func = func;
+  timers[numTimers].value = value;
+  timers[numTimers].due = elapsed() + millis;
+  timers[numTimers].fresh = firing;
+  numTimers++;
+}
+
+void glutPostRedisplay(void) {
+  redisplay = 1;
+}
+
+void glutSwapBuffers(void) {
+  fprintf(stderr, "frame %d tick %d checksum %016" PRIx64 "\n", swaps, tick, sglChecksum());
+  if(options.ppm != NULL) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s%05d.ppm", options.ppm, swaps);
+    if(!sglWritePPM(path)) fprintf(stderr, "Unable to write %s\n", path);
+  }
+  swaps++;
+}
+
+int glutGet(GLenum state) {
+  switch(state) {
+  case GLUT_WINDOW_X: return 0;
+  case GLUT_WINDOW_Y: return 0;
+  case GLUT_WINDOW_WIDTH: return width;
+  case GLUT_WINDOW_HEIGHT: return height;
+  case GLUT_ELAPSED_TIME: return (int) elapsed();
+  }
+  return 0;
+}
+
+int glutCreateMenu(void (*func)(int value)) {
+  (void) func;
+  return ++menus;
+}
+
+void glutAddMenuEntry(const char* label, int value) {
+  (void) label;
+  (void) value;
+}
+
+void glutAddSubMenu(const char* label, int menu) {
+  (void) label;
+  (void) menu;
+}
+
+void glutAttachMenu(int button) {
+  (void) button;
+}
+
+/*
+ * a cube of the given side around the origin, as GL quads
+ */
+static void cube(GLdouble size, GLenum mode) {
+  static const float corners[8][3] = {
+    { -1, -1, -1 }, { 1, -1, -1 }, { 1, 1, -1 }, { -1, 1, -1 },
+    { -1, -1, 1 }, { 1, -1, 1 }, { 1, 1, 1 }, { -1, 1, 1 }
+  };
+  static const int faces[6][4] = {
+    { 0, 3, 2, 1 }, { 4, 5, 6, 7 }, { 0, 1, 5, 4 },
+    { 3, 7, 6, 2 }, { 0, 4, 7, 3 }, { 1, 2, 6, 5 }
+  };
+  const float h = (float) size / 2.0f;
+
+  for(int f = 0; f < 6; f++) {
+    glBegin(mode);
+    for(int i = 0; i < 4; i++) {
+      const float* c = corners[faces[f][i]];
+      glVertex3f(c[0] * h, c[1] * h, c[2] * h);
+    }
+    glEnd();
+  }
+}
+
+void glutSolidCube(GLdouble size) {
+  cube(size, GL_QUADS);
+}
+
+void glutWireCube(GLdouble size) {
+  cube(size, GL_LINE_LOOP);
+}
+
+/*
+ * read the scripted input, see glut.h for the format
+ */
+static void loadInput(const char* path) {
+  FILE* fp = fopen(path, "r");
+  if(fp == NULL) {
+    fprintf(stderr, "Unable to open %s\n", path);
+    exit(1);
+  }
+
+  char line[256];
+  int capacity = 0, lineNumber = 0;
+  while(fgets(line, sizeof(line), fp)) {
+    lineNumber++;
+    char type[16] = "", a[16] = "", b[16] = "";
+    event_t e;
+    memset(&e, 0, sizeof(e));
+
+    if(line[0] == '#' || sscanf(line, "%d %15s", &e.tick, type) < 2) continue;
+
+    if(strcmp(type, "key") == 0 && sscanf(line, "%*d %*s %15s", a) == 1) {
+      e.type = EVENT_KEY;
+      e.key = strlen(a) == 1 ? (unsigned char) a[0] : atoi(a);
+    } else if(strcmp(type, "mouse") == 0 &&
+              sscanf(line, "%*d %*s %15s %15s %d %d", a, b, &e.x, &e.y) == 4) {
+      e.type = EVENT_MOUSE;
+      e.button = strcmp(a, "right") == 0 ? GLUT_RIGHT_BUTTON :
+                 strcmp(a, "middle") == 0 ? GLUT_MIDDLE_BUTTON : GLUT_LEFT_BUTTON;
+      e.state = strcmp(b, "up") == 0 ? GLUT_UP : GLUT_DOWN;
+    } else if(strcmp(type, "motion") == 0 && sscanf(line, "%*d %*s %d %d", &e.x, &e.y) == 2) {
+      e.type = EVENT_MOTION;
+    } else if(strcmp(type, "passive") == 0 && sscanf(line, "%*d %*s %d %d", &e.x, &e.y) == 2) {
+      e.type = EVENT_PASSIVE;
+    } else {
+      fprintf(stderr, "%s:%d: unknown event\n", path, lineNumber);
+      continue;
+    }
+
+    if(numEvents == capacity) {
+      capacity = capacity ? 2 * capacity : 64;
+      events = (event_t*) realloc(events, capacity * sizeof(event_t));
+      if(events == NULL) exit(1);
+    }
+    events[numEvents++] = e;
+  }
+  fclose(fp);
+}
+
+static void deliver(const event_t* e) {
+  switch(e->type) {
+  case EVENT_KEY:
+    if(keyboardFunc) keyboardFunc((unsigned char) e->key, 0, 0);
+    break;
+  case EVENT_MOUSE:
+    if(mouseFunc) mouseFunc(e->button, e->state, e->x, e->y);
+    break;
+  case EVENT_MOTION:
+    if(motionFunc) motionFunc(e->x, e->y);
+    break;
+  case EVENT_PASSIVE:
+    if(passiveFunc) passiveFunc(e->x, e->y);
+    break;
+  }
+}
+
+/*
+ * fire every timer due by now, earliest first
+ */
+static void fireTimers(void) {
+  firing = 1;
+  for(;;) {
+    int next = -1;
+    for(int i = 0; i < numTimers; i++) {
+      if(timers[i].fresh || timers[i].due > elapsed()) continue;
+      if(next < 0 || timers[i].due < timers[next].due) next = i;
+    }
+    if(next < 0) break;
+
+    const pending_t t = timers[next];
+    timers[next] = timers[--numTimers];
+    t.func(t.value);
+  }
+
+  firing = 0;
+  for(int i = 0; i < numTimers; i++) timers[i].fresh = 0;
+}
+
+void glutMainLoop(void) {
+  if(options.input) loadInput(options.input);
+  if(reshapeFunc) reshapeFunc(width, height);
+  else glViewport(0, 0, width, height);
+
+  int e = 0;
+  for(tick = 0; tick < options.frames; tick++) {
+    for(; e < numEvents && events[e].tick <= tick; e++) deliver(&events[e]);
+    fireTimers();
+
+    if(redisplay && displayFunc) {
+      redisplay = 0;
+      displayFunc();
+    }
+    if(idleFunc) idleFunc();
+  }
+
+  free(events);
+  sglFree();
+  exit(0);
+}
@@ -0,0 +1,1002 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "softgl.h"
+
+#define PI 3.14159265358979f
+
+/* vertices an sglBegin/sglEnd pair starts out with room for */
+#define VERTS_INITIAL 1024
+
+/* most vertices a triangle can have after clipping against six planes */
+#define CLIP_MAX 9
+
+/* window coordinates snap to this many steps per pixel, as GL hardware does */
+#define SUBPIXEL 256
+
+/* a vertex in clip space with everything interpolated across primitives */
+typedef struct {
+  float x, y, z, w;
+  float r, g, b, a;
+  float s, t;
+} vert_t;
+
+/* a vertex in window coordinates, ready for rasterization */
+typedef struct {
+  float x, y, z;
+
+  /* 1 / w, and the attributes divided by w for perspective correction */
+  float q;
+  float r, g, b, a;
+  float s, t;
+} win_t;
+
+typedef struct {
+  int width, height;
+  unsigned char* texels;
+} texture_t;
+
+typedef struct {
+  float m[SGL_STACK_DEPTH][16];
+  int top;
+} matstack_t;
+
+/* the one context */
+static struct {
+  int width, height;
+  unsigned char* color;
+  float* depth;
+
+  int viewport[4];
+  int scissor[4];
+  float clear[4];
+  int depthTest, blend, texturing, scissorTest;
+
+  /* the pixels drawing may touch: the framebuffer, cut down by the scissor box */
+  int left, bottom, right, top;
+  int depthFunc, blendSrc, blendDst;
+  float pointSize, lineWidth;
+
+  matstack_t modelview, projection;
+  matstack_t* stack;
+  float mvp[16];
+  int mvpDirty;
+
+  /* current attributes and the primitive being built */
+  float rgba[4];
+  float st[2];
+  int mode;
+  vert_t* verts;
+  int numVerts, maxVerts;
+
+  texture_t* textures;
+  int numTextures;
+  unsigned int bound;
+  int texEnv;
+
+  /* selection */
+  int renderMode;
+  unsigned int* select;
+  int selectSize, selectUsed, hits, overflow;
+  unsigned int names[SGL_NAME_DEPTH];
+  int numNames;
+  int hit;
+  float hitMin, hitMax;
+} ctx;
+
+static void identity(float m[16]) {
+  memset(m, 0, 16 * sizeof(float));
+  m[0] = m[5] = m[10] = m[15] = 1.0f;
+}
+
+/*
+ * r = a * b, all column major.  r may alias neither a nor b
+ */
+static void multiply(float r[16], const float a[16], const float b[16]) {
+  for(int c = 0; c < 4; c++) {
+    for(int row = 0; row < 4; row++) {
+      r[c * 4 + row] = a[row] * b[c * 4] + a[4 + row] * b[c * 4 + 1] +
+                       a[8 + row] * b[c * 4 + 2] + a[12 + row] * b[c * 4 + 3];
+    }
+  }
+}
+
+static float* top(void) {
+  return ctx.stack->m[ctx.stack->top];
+}
+
+int sglInit(int width, int height) {
+  sglFree();
+  if(width < 1) width = 1;
+  if(height < 1) height = 1;
+
+  ctx.color = (unsigned char*) calloc((size_t) width * height, 4);
+  ctx.depth = (float*) malloc((size_t) width * height * sizeof(float));
+  ctx.verts = (vert_t*) malloc(VERTS_INITIAL * sizeof(vert_t));
+  if(!ctx.color || !ctx.depth || !ctx.verts) {
+    sglFree();
+    return 0;
+  }
+  ctx.maxVerts = VERTS_INITIAL;
+  for(int i = 0; i < width * height; i++) ctx.depth[i] = 1.0f;
+
+  ctx.width = width;
+  ctx.height = height;
+  sglViewport(0, 0, width, height);
+  ctx.scissorTest = 0;
+  sglScissor(0, 0, width, height);
+  sglClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  ctx.depthTest = ctx.blend = ctx.texturing = 0;
+  ctx.depthFunc = SGL_LESS;
+  ctx.blendSrc = SGL_ONE;
+  ctx.blendDst = SGL_ZERO;
+  ctx.pointSize = ctx.lineWidth = 1.0f;
+
+  identity(ctx.modelview.m[0]);
+  identity(ctx.projection.m[0]);
+  ctx.modelview.top = ctx.projection.top = 0;
+  ctx.stack = &ctx.modelview;
+  ctx.mvpDirty = 1;
+
+  sglColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+  sglTexCoord2f(0.0f, 0.0f);
+  ctx.mode = -1;
+  ctx.numVerts = 0;
+  ctx.bound = 0;
+  ctx.texEnv = SGL_MODULATE;
+
+  ctx.renderMode = SGL_RENDER;
+  ctx.select = NULL;
+  ctx.selectSize = ctx.numNames = 0;
+  return 1;
+}
+
+void sglFree(void) {
+  free(ctx.color);
+  free(ctx.depth);
+  free(ctx.verts);
+  for(int i = 0; i < ctx.numTextures; i++) free(ctx.textures[i].texels);
+  free(ctx.textures);
+  ctx.color = NULL;
+  ctx.depth = NULL;
+  ctx.verts = NULL;
+  ctx.textures = NULL;
+  ctx.numTextures = 0;
+  ctx.width = ctx.height = 0;
+}
+
+int sglWidth(void) {
+  return ctx.width;
+}
+
+int sglHeight(void) {
+  return ctx.height;
+}
+
+const unsigned char* sglPixels(void) {
+  return ctx.color;
+}
+
+int sglWritePPM(const char* path) {
+  FILE* fp = fopen(path, "wb");
+  if(fp == NULL) return 0;
+
+  fprintf(fp, "P6\n%d %d\n255\n", ctx.width, ctx.height);
+  unsigned char* row = (unsigned char*) malloc(ctx.width * 3);
+  for(int y = ctx.height - 1; y >= 0; y--) {
+    const unsigned char* p = ctx.color + (size_t) y * ctx.width * 4;
+    for(int x = 0; x < ctx.width; x++) {
+      memcpy(&row[x * 3], &p[x * 4], 3);
+    }
+    fwrite(row, 3, ctx.width, fp);
+  }
+  free(row);
+  return fclose(fp) == 0;
+}
+
+uint64_t sglChecksum(void) {
+  /* FNV-1a over the color bytes */
+  uint64_t h = 0xcbf29ce484222325ULL;
+  const size_t n = (size_t) ctx.width * ctx.height * 4;
+  for(size_t i = 0; i < n; i++) {
+    h = (h ^ ctx.color[i]) * 0x100000001b3ULL;
+  }
+  return h;
+}
+
+void sglViewport(int x, int y, int width, int height) {
+  ctx.viewport[0] = x;
+  ctx.viewport[1] = y;
+  ctx.viewport[2] = width;
+  ctx.viewport[3] = height;
+}
+
+void sglGetViewport(int viewport[4]) {
+  memcpy(viewport, ctx.viewport, 4 * sizeof(int));
+}
+
+/*
+ * work out the pixels drawing may touch after the scissor box or test changed
+ */
+static void updateBounds(void) {
+  ctx.left = ctx.bottom = 0;
+  ctx.right = ctx.width;
+  ctx.top = ctx.height;
+  if(!ctx.scissorTest) return;
+
+  if(ctx.scissor[0] > ctx.left) ctx.left = ctx.scissor[0];
+  if(ctx.scissor[1] > ctx.bottom) ctx.bottom = ctx.scissor[1];
+  if(ctx.scissor[0] + ctx.scissor[2] < ctx.right) ctx.right = ctx.scissor[0] + ctx.scissor[2];
+  if(ctx.scissor[1] + ctx.scissor[3] < ctx.top) ctx.top = ctx.scissor[1] + ctx.scissor[3];
+  if(ctx.right < ctx.left) ctx.right = ctx.left;
+  if(ctx.top < ctx.bottom) ctx.top = ctx.bottom;
+}
+
+void sglScissor(int x, int y, int width, int height) {
+  ctx.scissor[0] = x;
+  ctx.scissor[1] = y;
+  ctx.scissor[2] = width < 0 ? 0 : width;
+  ctx.scissor[3] = height < 0 ? 0 : height;
+  updateBounds();
+}
+
+void sglClearColor(float r, float g, float b, float a) {
+  ctx.clear[0] = r;
+  ctx.clear[1] = g;
+  ctx.clear[2] = b;
+  ctx.clear[3] = a;
+}
+
+static unsigned char toByte(float c) {
+  if(c <= 0.0f) return 0;
+  if(c >= 1.0f) return 255;
+  return (unsigned char) (c * 255.0f + 0.5f);
+}
+
+void sglClear(int color, int depth) {
+  const unsigned char c[4] = { toByte(ctx.clear[0]), toByte(ctx.clear[1]),
+                               toByte(ctx.clear[2]), toByte(ctx.clear[3]) };
+  for(int y = ctx.bottom; y < ctx.top; y++) {
+    const int row = y * ctx.width;
+    for(int x = ctx.left; x < ctx.right; x++) {
+      if(color) memcpy(&ctx.color[(row + x) * 4], c, 4);
+      if(depth) ctx.depth[row + x] = 1.0f;
+    }
+  }
+}
+
+void sglEnable(int cap, int on) {
+  switch(cap) {
+  case SGL_DEPTH_TEST: ctx.depthTest = on; break;
+  case SGL_BLEND: ctx.blend = on; break;
+  case SGL_TEXTURE_2D: ctx.texturing = on; break;
+  case SGL_SCISSOR_TEST: ctx.scissorTest = on; updateBounds(); break;
+  }
+}
+
+int sglIsEnabled(int cap) {
+  switch(cap) {
+  case SGL_DEPTH_TEST: return ctx.depthTest;
+  case SGL_BLEND: return ctx.blend;
+  case SGL_TEXTURE_2D: return ctx.texturing;
+  case SGL_SCISSOR_TEST: return ctx.scissorTest;
+  }
+  return 0;
+}
+
+void sglDepthFunc(int func) {
+  ctx.depthFunc = func;
+}
+
+void sglBlendFunc(int src, int dst) {
+  ctx.blendSrc = src;
+  ctx.blendDst = dst;
+}
+
+void sglPointSize(float size) {
+  ctx.pointSize = size;
+}
+
+void sglLineWidth(float width) {
+  ctx.lineWidth = width;
+}
+
+void sglMatrixMode(int mode) {
+  ctx.stack = mode == SGL_PROJECTION ? &ctx.projection : &ctx.modelview;
+}
+
+void sglLoadIdentity(void) {
+  identity(top());
+  ctx.mvpDirty = 1;
+}
+
+void sglLoadMatrixf(const float m[16]) {
+  memcpy(top(), m, 16 * sizeof(float));
+  ctx.mvpDirty = 1;
+}
+
+void sglMultMatrixf(const float m[16]) {
+  float r[16];
+  multiply(r, top(), m);
+  sglLoadMatrixf(r);
+}
+
+void sglPushMatrix(void) {
+  matstack_t* s = ctx.stack;
+  if(s->top + 1 < SGL_STACK_DEPTH) {
+    memcpy(s->m[s->top + 1], s->m[s->top], 16 * sizeof(float));
+    s->top++;
+  }
+}
+
+void sglPopMatrix(void) {
+  if(ctx.stack->top > 0) {
+    ctx.stack->top--;
+    ctx.mvpDirty = 1;
+  }
+}
+
+void sglGetMatrixf(int mode, float m[16]) {
+  const matstack_t* s = mode == SGL_PROJECTION ? &ctx.projection : &ctx.modelview;
+  memcpy(m, s->m[s->top], 16 * sizeof(float));
+}
+
+void sglMatTranslate(float m[16], float x, float y, float z) {
+  identity(m);
+  m[12] = x;
+  m[13] = y;
+  m[14] = z;
+}
+
+void sglMatRotate(float m[16], float angle, float x, float y, float z) {
+  identity(m);
+  const float len = sqrtf(x * x + y * y + z * z);
+  if(len == 0.0f) return;
+  x /= len;
+  y /= len;
+  z /= len;
+
+  const float c = cosf(angle * PI / 180.0f), s = sinf(angle * PI / 180.0f), t = 1.0f - c;
+  m[0] = x * x * t + c;
+  m[1] = y * x * t + z * s;
+  m[2] = x * z * t - y * s;
+  m[4] = x * y * t - z * s;
+  m[5] = y * y * t + c;
+  m[6] = y * z * t + x * s;
+  m[8] = x * z * t + y * s;
+  m[9] = y * z * t - x * s;
+  m[10] = z * z * t + c;
+}
+
+void sglMatScale(float m[16], float x, float y, float z) {
+  identity(m);
+  m[0] = x;
+  m[5] = y;
+  m[10] = z;
+}
+
+void sglMatOrtho(float m[16], float left, float right, float bottom, float top,
+                 float zNear, float zFar) {
+  identity(m);
+  m[0] = 2.0f / (right - left);
+  m[5] = 2.0f / (top - bottom);
+  m[10] = -2.0f / (zFar - zNear);
+  m[12] = -(right + left) / (right - left);
+  m[13] = -(top + bottom) / (top - bottom);
+  m[14] = -(zFar + zNear) / (zFar - zNear);
+}
+
+void sglMatFrustum(float m[16], float left, float right, float bottom, float top,
+                   float zNear, float zFar) {
+  memset(m, 0, 16 * sizeof(float));
+  m[0] = 2.0f * zNear / (right - left);
+  m[5] = 2.0f * zNear / (top - bottom);
+  m[8] = (right + left) / (right - left);
+  m[9] = (top + bottom) / (top - bottom);
+  m[10] = -(zFar + zNear) / (zFar - zNear);
+  m[11] = -1.0f;
+  m[14] = -2.0f * zFar * zNear / (zFar - zNear);
+}
+
+void sglMatPerspective(float m[16], float fovy, float aspect, float zNear, float zFar) {
+  const float top = zNear * tanf(fovy * PI / 360.0f);
+  sglMatFrustum(m, -top * aspect, top * aspect, -top, top, zNear, zFar);
+}
+
+void sglMatLookAt(float m[16], float eyeX, float eyeY, float eyeZ,
+                  float centerX, float centerY, float centerZ, float upX, float upY, float upZ) {
+  float f[3] = { centerX - eyeX, centerY - eyeY, centerZ - eyeZ };
+  float len = sqrtf(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+  if(len > 0.0f) {
+    f[0] /= len;
+    f[1] /= len;
+    f[2] /= len;
+  }
+
+  /* side = f x up, u = side x f */
+  float s[3] = { f[1] * upZ - f[2] * upY, f[2] * upX - f[0] * upZ, f[0] * upY - f[1] * upX };
+  len = sqrtf(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+  if(len > 0.0f) {
+    s[0] /= len;
+    s[1] /= len;
+    s[2] /= len;
+  }
+  const float u[3] = { s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2], s[0] * f[1] - s[1] * f[0] };
+
+  float r[16], t[16];
+  identity(r);
+  r[0] = s[0]; r[4] = s[1]; r[8] = s[2];
+  r[1] = u[0]; r[5] = u[1]; r[9] = u[2];
+  r[2] = -f[0]; r[6] = -f[1]; r[10] = -f[2];
+  sglMatTranslate(t, -eyeX, -eyeY, -eyeZ);
+  multiply(m, r, t);
+}
+
+void sglMatPick(float m[16], float x, float y, float width, float height, const int viewport[4]) {
+  float t[16], s[16];
+  identity(m);
+  if(width <= 0.0f || height <= 0.0f) return;
+
+  sglMatTranslate(t, (viewport[2] - 2.0f * (x - viewport[0])) / width,
+                  (viewport[3] - 2.0f * (y - viewport[1])) / height, 0.0f);
+  sglMatScale(s, viewport[2] / width, viewport[3] / height, 1.0f);
+  multiply(m, t, s);
+}
+
+void sglColor4f(float r, float g, float b, float a) {
+  ctx.rgba[0] = r;
+  ctx.rgba[1] = g;
+  ctx.rgba[2] = b;
+  ctx.rgba[3] = a;
+}
+
+void sglTexCoord2f(float s, float t) {
+  ctx.st[0] = s;
+  ctx.st[1] = t;
+}
+
+void sglBegin(int mode) {
+  ctx.mode = mode;
+  ctx.numVerts = 0;
+  if(ctx.mvpDirty) {
+    multiply(ctx.mvp, ctx.projection.m[ctx.projection.top], ctx.modelview.m[ctx.modelview.top]);
+    ctx.mvpDirty = 0;
+  }
+}
+
+void sglVertex4f(float x, float y, float z, float w) {
+  if(ctx.mode < 0) return;
+  if(ctx.numVerts == ctx.maxVerts) {
+    vert_t* verts = (vert_t*) realloc(ctx.verts, 2 * ctx.maxVerts * sizeof(vert_t));
+    if(verts == NULL) return;
+    ctx.verts = verts;
+    ctx.maxVerts *= 2;
+  }
+
+  const float* m = ctx.mvp;
+  vert_t* v = &ctx.verts[ctx.numVerts++];
+  v->x = m[0] * x + m[4] * y + m[8] * z + m[12] * w;
+  v->y = m[1] * x + m[5] * y + m[9] * z + m[13] * w;
+  v->z = m[2] * x + m[6] * y + m[10] * z + m[14] * w;
+  v->w = m[3] * x + m[7] * y + m[11] * z + m[15] * w;
+  v->r = ctx.rgba[0];
+  v->g = ctx.rgba[1];
+  v->b = ctx.rgba[2];
+  v->a = ctx.rgba[3];
+  v->s = ctx.st[0];
+  v->t = ctx.st[1];
+}
+
+/*
+ * fragments
+ */
+
+static int depthPasses(float z, float stored) {
+  switch(ctx.depthFunc) {
+  case SGL_NEVER: return 0;
+  case SGL_LESS: return z < stored;
+  case SGL_EQUAL: return z == stored;
+  case SGL_LEQUAL: return z <= stored;
+  case SGL_GREATER: return z > stored;
+  case SGL_NOTEQUAL: return z != stored;
+  case SGL_GEQUAL: return z >= stored;
+  }
+  return 1;
+}
+
+static float factor(int f, float src, float srcAlpha, float dst, float dstAlpha) {
+  switch(f) {
+  case SGL_ZERO: return 0.0f;
+  case SGL_ONE: return 1.0f;
+  case SGL_SRC_COLOR: return src;
+  case SGL_ONE_MINUS_SRC_COLOR: return 1.0f - src;
+  case SGL_SRC_ALPHA: return srcAlpha;
+  case SGL_ONE_MINUS_SRC_ALPHA: return 1.0f - srcAlpha;
+  case SGL_DST_ALPHA: return dstAlpha;
+  case SGL_ONE_MINUS_DST_ALPHA: return 1.0f - dstAlpha;
+  case SGL_DST_COLOR: return dst;
+  case SGL_ONE_MINUS_DST_COLOR: return 1.0f - dst;
+  }
+  return 1.0f;
+}
+
+static const texture_t* boundTexture(void) {
+  if(!ctx.texturing || ctx.bound == 0 || ctx.bound > (unsigned int) ctx.numTextures) return NULL;
+  const texture_t* t = &ctx.textures[ctx.bound - 1];
+  return t->texels ? t : NULL;
+}
+
+/*
+ * depth test, texture, blend and store one fragment
+ */
+static void fragment(int x, int y, float z, float c[4], float s, float t) {
+  if(x < ctx.left || y < ctx.bottom || x >= ctx.right || y >= ctx.top) return;
+  const int i = y * ctx.width + x;
+
+  if(ctx.depthTest) {
+    if(!depthPasses(z, ctx.depth[i])) return;
+    ctx.depth[i] = z;
+  }
+
+  const texture_t* tex = boundTexture();
+  if(tex != NULL) {
+    int tx = (int) floorf(s * tex->width) % tex->width;
+    int ty = (int) floorf(t * tex->height) % tex->height;
+    if(tx < 0) tx += tex->width;
+    if(ty < 0) ty += tex->height;
+    const unsigned char* texel = &tex->texels[(ty * tex->width + tx) * 4];
+    for(int k = 0; k < 4; k++) {
+      const float v = texel[k] / 255.0f;
+      c[k] = ctx.texEnv == SGL_REPLACE ? v : c[k] * v;
+    }
+  }
+
+  for(int k = 0; k < 4; k++) {
+    if(c[k] < 0.0f) c[k] = 0.0f;
+    if(c[k] > 1.0f) c[k] = 1.0f;
+  }
+
+  unsigned char* p = &ctx.color[i * 4];
+  if(ctx.blend) {
+    const float dstAlpha = p[3] / 255.0f;
+    for(int k = 0; k < 4; k++) {
+      const float dst = p[k] / 255.0f;
+      const float srcAlpha = c[3];
+      c[k] = c[k] * factor(ctx.blendSrc, c[k], srcAlpha, dst, dstAlpha) +
+             dst * factor(ctx.blendDst, c[k], srcAlpha, dst, dstAlpha);
+    }
+  }
+  for(int k = 0; k < 4; k++) p[k] = toByte(c[k]);
+}
+
+/*
+ * clipping and projection
+ */
+
+/* signed distance of v to clip plane p, inside when >= 0 */
+static float planeDistance(const vert_t* v, int p) {
+  switch(p) {
+  case 0: return v->w + v->x;
+  case 1: return v->w - v->x;
+  case 2: return v->w + v->y;
+  case 3: return v->w - v->y;
+  case 4: return v->w + v->z;
+  default: return v->w - v->z;
+  }
+}
+
+static void lerp(vert_t* r, const vert_t* a, const vert_t* b, float t) {
+  const float* pa = &a->x;
+  const float* pb = &b->x;
+  float* pr = &r->x;
+  for(int k = 0; k < (int) (sizeof(vert_t) / sizeof(float)); k++) {
+    pr[k] = pa[k] + (pb[k] - pa[k]) * t;
+  }
+}
+
+static int inside(const vert_t* v) {
+  return v->x >= -v->w && v->x <= v->w && v->y >= -v->w && v->y <= v->w &&
+         v->z >= -v->w && v->z <= v->w;
+}
+
+static float snap(float v) {
+  return floorf(v * SUBPIXEL + 0.5f) / SUBPIXEL;
+}
+
+static void project(win_t* o, const vert_t* v) {
+  const float q = 1.0f / v->w;
+  o->x = snap(ctx.viewport[0] + (v->x * q + 1.0f) * 0.5f * ctx.viewport[2]);
+  o->y = snap(ctx.viewport[1] + (v->y * q + 1.0f) * 0.5f * ctx.viewport[3]);
+  o->z = (v->z * q + 1.0f) * 0.5f;
+  o->q = q;
+  o->r = v->r * q;
+  o->g = v->g * q;
+  o->b = v->b * q;
+  o->a = v->a * q;
+  o->s = v->s * q;
+  o->t = v->t * q;
+}
+
+/* in select mode a primitive reaching the rasterizer is a hit */
+static void selectHit(const win_t* v, int n) {
+  for(int i = 0; i < n; i++) {
+    if(!ctx.hit || v[i].z < ctx.hitMin) ctx.hitMin = v[i].z;
+    if(!ctx.hit || v[i].z > ctx.hitMax) ctx.hitMax = v[i].z;
+    ctx.hit = 1;
+  }
+}
+
+/*
+ * rasterization
+ */
+
+static void drawPoint(const vert_t* v) {
+  if(!inside(v)) return;
+
+  win_t p;
+  project(&p, v);
+  if(ctx.renderMode == SGL_SELECT) {
+    selectHit(&p, 1);
+    return;
+  }
+
+  int size = (int) (ctx.pointSize + 0.5f);
+  if(size < 1) size = 1;
+
+  /* the square GL covers for a point of this size */
+  int x0, y0;
+  if(size & 1) {
+    x0 = (int) floorf(p.x) - (size - 1) / 2;
+    y0 = (int) floorf(p.y) - (size - 1) / 2;
+  } else {
+    x0 = (int) floorf(p.x + 0.5f) - size / 2;
+    y0 = (int) floorf(p.y + 0.5f) - size / 2;
+  }
+
+  for(int y = y0; y < y0 + size; y++) {
+    for(int x = x0; x < x0 + size; x++) {
+      float c[4] = { v->r, v->g, v->b, v->a };
+      fragment(x, y, p.z, c, v->s, v->t);
+    }
+  }
+}
+
+static void drawLine(const vert_t* a, const vert_t* b) {
+  /* Liang-Barsky against the six clip planes */
+  float t0 = 0.0f, t1 = 1.0f;
+  for(int p = 0; p < 6; p++) {
+    const float da = planeDistance(a, p), db = planeDistance(b, p);
+    if(da < 0.0f && db < 0.0f) return;
+    if(da < 0.0f) {
+      const float t = da / (da - db);
+      if(t > t0) t0 = t;
+    } else if(db < 0.0f) {
+      const float t = da / (da - db);
+      if(t < t1) t1 = t;
+    }
+  }
+  if(t0 > t1) return;
+
+  vert_t ca, cb;
+  lerp(&ca, a, b, t0);
+  lerp(&cb, a, b, t1);
+  win_t w[2];
+  project(&w[0], &ca);
+  project(&w[1], &cb);
+  if(ctx.renderMode == SGL_SELECT) {
+    selectHit(w, 2);
+    return;
+  }
+
+  int width = (int) (ctx.lineWidth + 0.5f);
+  if(width < 1) width = 1;
+
+  /* step along the major axis, one pixel per column (or row) */
+  const float dx = w[1].x - w[0].x, dy = w[1].y - w[0].y;
+  const int xMajor = fabsf(dx) >= fabsf(dy);
+  const float major0 = xMajor ? w[0].x : w[0].y, major1 = xMajor ? w[1].x : w[1].y;
+  const float minor0 = xMajor ? w[0].y : w[0].x, minor1 = xMajor ? w[1].y : w[1].x;
+  const int step = major1 >= major0 ? 1 : -1;
+
+  /* the pixels whose centers lie in [major0, major1) */
+  const int first = step > 0 ? (int) ceilf(major0 - 0.5f) : (int) floorf(major0 - 0.5f);
+  const int last = step > 0 ? (int) ceilf(major1 - 0.5f) : (int) floorf(major1 - 0.5f);
+  if(first == last) return;
+
+  for(int m = first; m != last; m += step) {
+    float t = (m + 0.5f - major0) / (major1 - major0);
+    if(t < 0.0f) t = 0.0f;
+    if(t > 1.0f) t = 1.0f;
+    const float minor = minor0 + (minor1 - minor0) * t;
+
+    /* perspective correct attributes */
+    const float q = w[0].q + (w[1].q - w[0].q) * t;
+    const float z = w[0].z + (w[1].z - w[0].z) * t;
+    float c[4] = { (w[0].r + (w[1].r - w[0].r) * t) / q, (w[0].g + (w[1].g - w[0].g) * t) / q,
+                   (w[0].b + (w[1].b - w[0].b) * t) / q, (w[0].a + (w[1].a - w[0].a) * t) / q };
+    const float s = (w[0].s + (w[1].s - w[0].s) * t) / q;
+    const float tt = (w[0].t + (w[1].t - w[0].t) * t) / q;
+
+    /* a wide line is a column of width pixels across the minor axis */
+    const int n0 = (int) floorf(minor - (width - 1) / 2.0f);
+    for(int n = n0; n < n0 + width; n++) {
+      float cc[4] = { c[0], c[1], c[2], c[3] };
+      if(xMajor) fragment(m, n, z, cc, s, tt);
+      else fragment(n, m, z, cc, s, tt);
+    }
+  }
+}
+
+/*
+ * the top-left rule: pixel centers exactly on an edge belong to top and left
+ * edges.  coordinates are in subpixels
+ */
+static int topLeft(int64_t ax, int64_t ay, int64_t bx, int64_t by) {
+  return by < ay || (by == ay && bx < ax);
+}
+
+/*
+ * interpolate relative to the first vertex, so an attribute equal at every
+ * vertex comes out exact
+ */
+static float bary(float a0, float a1, float a2, float l1, float l2) {
+  return a0 + l1 * (a1 - a0) + l2 * (a2 - a0);
+}
+
+/*
+ * edge functions are evaluated exactly on the snapped coordinates, so triangles
+ * sharing an edge never both cover, or both miss, a pixel on it
+ */
+static void rasterTriangle(const win_t* v0, const win_t* v1, const win_t* v2) {
+  int64_t x0 = (int64_t) (v0->x * SUBPIXEL), y0 = (int64_t) (v0->y * SUBPIXEL);
+  int64_t x1 = (int64_t) (v1->x * SUBPIXEL), y1 = (int64_t) (v1->y * SUBPIXEL);
+  int64_t x2 = (int64_t) (v2->x * SUBPIXEL), y2 = (int64_t) (v2->y * SUBPIXEL);
+
+  int64_t area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+  if(area == 0) return;
+  if(area < 0) {
+    const win_t* t = v1;
+    v1 = v2;
+    v2 = t;
+    int64_t tx = x1, ty = y1;
+    x1 = x2;
+    y1 = y2;
+    x2 = tx;
+    y2 = ty;
+    area = -area;
+  }
+
+  float xmin = fminf(v0->x, fminf(v1->x, v2->x)), xmax = fmaxf(v0->x, fmaxf(v1->x, v2->x));
+  float ymin = fminf(v0->y, fminf(v1->y, v2->y)), ymax = fmaxf(v0->y, fmaxf(v1->y, v2->y));
+  int left = (int) floorf(xmin), right = (int) ceilf(xmax);
+  int bottom = (int) floorf(ymin), top = (int) ceilf(ymax);
+  if(left < ctx.left) left = ctx.left;
+  if(bottom < ctx.bottom) bottom = ctx.bottom;
+  if(right > ctx.right) right = ctx.right;
+  if(top > ctx.top) top = ctx.top;
+
+  const int tl0 = topLeft(x1, y1, x2, y2), tl1 = topLeft(x2, y2, x0, y0), tl2 = topLeft(x0, y0, x1, y1);
+  const float inv = 1.0f / (float) area;
+
+  for(int y = bottom; y < top; y++) {
+    const int64_t py = (int64_t) y * SUBPIXEL + SUBPIXEL / 2;
+    for(int x = left; x < right; x++) {
+      const int64_t px = (int64_t) x * SUBPIXEL + SUBPIXEL / 2;
+      const int64_t e0 = (x2 - x1) * (py - y1) - (y2 - y1) * (px - x1);
+      const int64_t e1 = (x0 - x2) * (py - y2) - (y0 - y2) * (px - x2);
+      const int64_t e2 = (x1 - x0) * (py - y0) - (y1 - y0) * (px - x0);
+      if(e0 < 0 || e1 < 0 || e2 < 0) continue;
+      if((e0 == 0 && !tl0) || (e1 == 0 && !tl1) || (e2 == 0 && !tl2)) continue;
+
+      const float l1 = e1 * inv, l2 = e2 * inv;
+      const float q = bary(v0->q, v1->q, v2->q, l1, l2);
+      float c[4] = { bary(v0->r, v1->r, v2->r, l1, l2) / q, bary(v0->g, v1->g, v2->g, l1, l2) / q,
+                     bary(v0->b, v1->b, v2->b, l1, l2) / q, bary(v0->a, v1->a, v2->a, l1, l2) / q };
+      fragment(x, y, bary(v0->z, v1->z, v2->z, l1, l2), c,
+               bary(v0->s, v1->s, v2->s, l1, l2) / q, bary(v0->t, v1->t, v2->t, l1, l2) / q);
+    }
+  }
+}
+
+static void drawTriangle(const vert_t* a, const vert_t* b, const vert_t* c) {
+  vert_t buf[2][CLIP_MAX];
+  int n = 3;
+  buf[0][0] = *a;
+  buf[0][1] = *b;
+  buf[0][2] = *c;
+
+  /* Sutherland-Hodgman against each clip plane in turn */
+  int cur = 0;
+  for(int p = 0; p < 6 && n > 0; p++) {
+    const vert_t* in = buf[cur];
+    vert_t* out = buf[!cur];
+    int m = 0;
+    for(int i = 0; i < n; i++) {
+      const vert_t* u = &in[i];
+      const vert_t* v = &in[(i + 1) % n];
+      const float du = planeDistance(u, p), dv = planeDistance(v, p);
+      if(du >= 0.0f) out[m++] = *u;
+      if((du >= 0.0f) != (dv >= 0.0f) && m < CLIP_MAX) {
+        /* always from the inside vertex, so triangles sharing an edge cut it at the same point */
+        if(du >= 0.0f) lerp(&out[m++], u, v, du / (du - dv));
+        else lerp(&out[m++], v, u, dv / (dv - du));
+      }
+    }
+    n = m;
+    cur = !cur;
+  }
+  if(n < 3) return;
+
+  win_t w[CLIP_MAX];
+  for(int i = 0; i < n; i++) project(&w[i], &buf[cur][i]);
+  if(ctx.renderMode == SGL_SELECT) {
+    selectHit(w, n);
+    return;
+  }
+  for(int i = 1; i + 1 < n; i++) {
+    rasterTriangle(&w[0], &w[i], &w[i + 1]);
+  }
+}
+
+void sglEnd(void) {
+  const vert_t* v = ctx.verts;
+  const int n = ctx.numVerts;
+
+  switch(ctx.mode) {
+  case SGL_POINTS:
+    for(int i = 0; i < n; i++) drawPoint(&v[i]);
+    break;
+  case SGL_LINES:
+    for(int i = 0; i + 1 < n; i += 2) drawLine(&v[i], &v[i + 1]);
+    break;
+  case SGL_LINE_STRIP:
+  case SGL_LINE_LOOP:
+    for(int i = 0; i + 1 < n; i++) drawLine(&v[i], &v[i + 1]);
+    if(ctx.mode == SGL_LINE_LOOP && n > 2) drawLine(&v[n - 1], &v[0]);
+    break;
+  case SGL_TRIANGLES:
+    for(int i = 0; i + 2 < n; i += 3) drawTriangle(&v[i], &v[i + 1], &v[i + 2]);
+    break;
+  case SGL_TRIANGLE_STRIP:
+    for(int i = 0; i + 2 < n; i++) {
+      if(i & 1) drawTriangle(&v[i + 1], &v[i], &v[i + 2]);
+      else drawTriangle(&v[i], &v[i + 1], &v[i + 2]);
+    }
+    break;
+  case SGL_TRIANGLE_FAN:
+  case SGL_POLYGON:
+    for(int i = 1; i + 1 < n; i++) drawTriangle(&v[0], &v[i], &v[i + 1]);
+    break;
+  case SGL_QUADS:
+    for(int i = 0; i + 3 < n; i += 4) {
+      drawTriangle(&v[i], &v[i + 1], &v[i + 2]);
+      drawTriangle(&v[i], &v[i + 2], &v[i + 3]);
+    }
+    break;
+  case SGL_QUAD_STRIP:
+    for(int i = 0; i + 3 < n; i += 2) {
+      drawTriangle(&v[i], &v[i + 1], &v[i + 3]);
+      drawTriangle(&v[i], &v[i + 3], &v[i + 2]);
+    }
+    break;
+  }
+
+  ctx.mode = -1;
+  ctx.numVerts = 0;
+}
+
+/*
+ * textures
+ */
+
+unsigned int sglGenTexture(void) {
+  texture_t* textures = (texture_t*) realloc(ctx.textures, (ctx.numTextures + 1) * sizeof(texture_t));
+  if(textures == NULL) return 0;
+  ctx.textures = textures;
+  ctx.textures[ctx.numTextures].width = ctx.textures[ctx.numTextures].height = 0;
+  ctx.textures[ctx.numTextures].texels = NULL;
+  return ++ctx.numTextures;
+}
+
+void sglDeleteTexture(unsigned int texture) {
+  if(texture == 0 || texture > (unsigned int) ctx.numTextures) return;
+  free(ctx.textures[texture - 1].texels);
+  ctx.textures[texture - 1].texels = NULL;
+  ctx.textures[texture - 1].width = ctx.textures[texture - 1].height = 0;
+}
+
+void sglBindTexture(unsigned int texture) {
+  ctx.bound = texture;
+}
+
+int sglTexImage(int width, int height, const unsigned char* rgba) {
+  if(ctx.bound == 0 || ctx.bound > (unsigned int) ctx.numTextures) return 0;
+  texture_t* t = &ctx.textures[ctx.bound - 1];
+
+  unsigned char* texels = (unsigned char*) realloc(t->texels, (size_t) width * height * 4);
+  if(texels == NULL) return 0;
+  t->texels = texels;
+  t->width = width;
+  t->height = height;
+  if(rgba) memcpy(texels, rgba, (size_t) width * height * 4);
+  else memset(texels, 0, (size_t) width * height * 4);
+  return 1;
+}
+
+void sglTexSubImage(int x, int y, int width, int height, const unsigned char* rgba) {
+  if(ctx.bound == 0 || ctx.bound > (unsigned int) ctx.numTextures) return;
+  texture_t* t = &ctx.textures[ctx.bound - 1];
+  if(t->texels == NULL || x < 0 || y < 0 || x + width > t->width || y + height > t->height) return;
+
+  for(int row = 0; row < height; row++) {
+    memcpy(&t->texels[((size_t) (y + row) * t->width + x) * 4],
+           &rgba[(size_t) row * width * 4], (size_t) width * 4);
+  }
+}
+
+void sglTexEnv(int mode) {
+  ctx.texEnv = mode;
+}
+
+/*
+ * selection
+ */
+
+/* write a hit record for the primitives since the last name stack change */
+static void flushHit(void) {
+  if(ctx.renderMode != SGL_SELECT || !ctx.hit) return;
+  ctx.hit = 0;
+
+  if(ctx.selectUsed + 3 + ctx.numNames > ctx.selectSize) {
+    ctx.overflow = 1;
+    return;
+  }
+  unsigned int* r = ctx.select + ctx.selectUsed;
+  r[0] = ctx.numNames;
+  r[1] = (unsigned int) (ctx.hitMin * 4294967295.0);
+  r[2] = (unsigned int) (ctx.hitMax * 4294967295.0);
+  memcpy(&r[3], ctx.names, ctx.numNames * sizeof(unsigned int));
+  ctx.selectUsed += 3 + ctx.numNames;
+  ctx.hits++;
+}
+
+void sglSelectBuffer(int size, unsigned int* buffer) {
+  ctx.select = buffer;
+  ctx.selectSize = size;
+}
+
+int sglRenderMode(int mode) {
+  int result = 0;
+  if(ctx.renderMode == SGL_SELECT) {
+    flushHit();
+    result = ctx.overflow ? -1 : ctx.hits;
+  }
+
+  ctx.renderMode = mode;
+  ctx.selectUsed = ctx.hits = ctx.overflow = ctx.hit = 0;
+  ctx.numNames = 0;
+  return result;
+}
+
+void sglInitNames(void) {
+  flushHit();
+  ctx.numNames = 0;
+}
+
+void sglPushName(unsigned int name) {
+  flushHit();
+  if(ctx.numNames < SGL_NAME_DEPTH) ctx.names[ctx.numNames++] = name;
+}
+
+void sglPopName(void) {
+  flushHit();
+  if(ctx.numNames > 0) ctx.numNames--;
+}
+
+void sglLoadName(unsigned int name) {
+  flushHit();
+  if(ctx.numNames > 0) ctx.names[ctx.numNames - 1] = name;
+}
@@ -0,0 +1,208 @@
+/*
+ * sparks_bench: drive the simulation from a scripted mouse drag without a
+ * window and report update timings as JSON
+ *
+ * usage: sparks_bench [-frames n] [-warmup n] [-bursts n] [-sparks n]
+ *                     [-threads n] [-kernel name] [-seed n]
+ *
+ * every frame queues a number of bursts along a Lissajous path, then times
+ * one simUpdate.  reported are update time percentiles and a log2 histogram,
+ * heap allocations per frame, sparks integrated per second and peak RSS.
+ */
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "sim.h"
+
+/* histogram buckets, bucket b counts frames taking under 2^b microseconds */
+#define HIST_BUCKETS 24
+
+#ifdef COUNT_ALLOCS
+/*
+ * the build wraps the allocator (ld --wrap) so that heap allocations made by
+ * the simulation can be counted
+ */
+static long allocs = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* p, size_t size);
+int __real_posix_memalign(void** p, size_t align, size_t size);
+
+void* __wrap_malloc(size_t size) { allocs++; return __real_malloc(size); }
+void* __wrap_calloc(size_t n, size_t size) { allocs++; return __real_calloc(n, size); }
+void* __wrap_realloc(void* p, size_t size) { allocs++; return __real_realloc(p, size); }
+int __wrap_posix_memalign(void** p, size_t align, size_t size) {
+  allocs++;
+  return __real_posix_memalign(p, align, size);
+}
+#endif
+
+/* benchmark parameters */
+struct options {
+  int frames, warmup, bursts, sparks, threads;
+  const char* kernel;
+  unsigned long long seed;
+} options = { 600, 60, 8, 200, 0, NULL, 1 };
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compareDoubles(const void* a, const void* b) {
+  const double x = *(const double*) a, y = *(const double*) b;
+  return x < y ? -1 : x > y;
+}
+
+/*
+ * nearest-rank percentile of sorted values
+ */
+static double percentile(const double* sorted, int n, double p) {
+  int rank = (int) ceil(p / 100.0 * n);
+  if(rank < 1) rank = 1;
+  return sorted[rank - 1];
+}
+
+/*
+ * peak resident set size in bytes
+ */
+static long peakRSS() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  return usage.ru_maxrss * 1024L;
+#endif
+}
+
+static void parseArgs(int argc, char** argv) {
+  for(int i = 1; i < argc; i++) {
+    if(i + 1 >= argc) {
+      fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+    } else if(strcmp(argv[i], "-frames") == 0) {
+      options.frames = atoi(argv[++i]);
+    } else if(strcmp(argv[i], "-warmup") == 0) {
+      options.warmup = atoi(argv[++i]);
+    } else if(strcmp(argv[i], "-bursts") == 0) {
+      options.bursts = atoi(argv[++i]);
+    } else if(strcmp(argv[i], "-sparks") == 0) {
+      options.sparks = atoi(argv[++i]);
+    } else if(strcmp(argv[i], "-threads") == 0) {
+      options.threads = atoi(argv[++i]);
+    } else if(strcmp(argv[i], "-kernel") == 0) {
+      options.kernel = argv[++i];
+    } else if(strcmp(argv[i], "-seed") == 0) {
+      options.seed = strtoull(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+    }
+  }
+  if(options.frames < 1) options.frames = 1;
+}
+
+/*
+ * queue this frame's bursts along the drag path
+ */
+static void spawnFrame(sim_t* sim, int frame) {
+  for(int b = 0; b < options.bursts; b++) {
+    const float t = frame + b / (float) options.bursts;
+    simAddSpark(sim, 500.0f + 400.0f * sinf(t * 0.05f), 600.0f + 300.0f * sinf(t * 0.07f));
+  }
+}
+
+int main(int argc, char** argv) {
+  parseArgs(argc, argv);
+
+  sim_t sim;
+  const int threads = options.threads > 0 ? options.threads : jobsDefaultWorkers();
+  if(!simInit(&sim, POOL_CAPACITY_INITIAL, threads)) {
+    fprintf(stderr, "Unable to allocate %d sparks\n", POOL_CAPACITY_INITIAL);
+    return 1;
+  }
+  if(options.kernel != NULL) {
+    sim.points.integrate = integrateSelect(options.kernel);
+    if(sim.points.integrate == NULL) {
+      fprintf(stderr, "Unsupported kernel '%s'\n", options.kernel);
+      return 1;
+    }
+  }
+  simSeed(&sim, options.seed);
+  sim.settings.sparks = options.sparks;
+
+  for(int f = 0; f < options.warmup; f++) {
+    spawnFrame(&sim, f);
+    simUpdate(&sim);
+  }
+
+  double* times = (double*) malloc(options.frames * sizeof(double));
+  long histogram[HIST_BUCKETS] = { 0 };
+  double sparks = 0.0, total = 0.0;
+  int peakSparks = 0;
+#ifdef COUNT_ALLOCS
+  allocs = 0;
+#endif
+
+  for(int f = 0; f < options.frames; f++) {
+    spawnFrame(&sim, options.warmup + f);
+
+    const double start = now();
+    simUpdate(&sim);
+    times[f] = now() - start;
+
+    total += times[f];
+    sparks += sim.points.count;
+    if(sim.points.count > peakSparks) peakSparks = sim.points.count;
+
+    int b = 0;
+    while(b < HIST_BUCKETS - 1 && times[f] * 1e6 >= (double) (1L << b)) b++;
+    histogram[b]++;
+  }
+
+#ifdef COUNT_ALLOCS
+  const double allocsPerFrame = allocs / (double) options.frames;
+#endif
+  const uint64_t checksum = simChecksum(&sim);
+  qsort(times, options.frames, sizeof(double), compareDoubles);
+
+  printf("{\n");
+  printf("  \"integrator\": \"%s\",\n", integrateName(sim.points.integrate));
+  printf("  \"threads\": %d,\n", sim.jobs.numWorkers);
+  printf("  \"seed\": %llu,\n", options.seed);
+  printf("  \"frames\": %d,\n", options.frames);
+  printf("  \"bursts_per_frame\": %d,\n", options.bursts);
+  printf("  \"max_sparks_per_burst\": %d,\n", options.sparks);
+  printf("  \"update_ms\": { \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f, \"mean\": %.4f },\n",
+         percentile(times, options.frames, 50) * 1e3, percentile(times, options.frames, 95) * 1e3,
+         percentile(times, options.frames, 99) * 1e3, times[options.frames - 1] * 1e3,
+         total / options.frames * 1e3);
+  printf("  \"update_histogram_us\": [");
+  for(int b = 0; b < HIST_BUCKETS; b++) {
+    printf("%s{ \"lt\": ", b ? ", " : "");
+    if(b < HIST_BUCKETS - 1) printf("%ld", 1L << b); else printf("null");
+    printf(", \"count\": %ld }", histogram[b]);
+  }
+  printf("],\n");
+#ifdef COUNT_ALLOCS
+  printf("  \"allocations_per_frame\": %.3f,\n", allocsPerFrame);
+#else
+  printf("  \"allocations_per_frame\": null,\n");
+#endif
+  printf("  \"mean_sparks\": %.1f,\n", sparks / options.frames);
+  printf("  \"peak_sparks\": %d,\n", peakSparks);
+  printf("  \"sparks_per_second\": %.0f,\n", total > 0.0 ? sparks / total : 0.0);
+  printf("  \"peak_rss_bytes\": %ld,\n", peakRSS());
+  printf("  \"checksum\": \"%016" PRIx64 "\"\n", checksum);
+  printf("}\n");
+
+  free(times);
+  simFree(&sim);
+  return 0;
+}
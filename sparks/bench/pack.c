@@ -0,0 +1,60 @@
+/*
+ * sparks_pack: time renderPack, the CPU side of drawing the sparks, without
+ * a window or GL context
+ *
+ * usage: sparks_pack [frames]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "render.h"
+#include "sim.h"
+
+static const int counts[] = { 10000, 100000, 1000000, 10000000 };
+
+#define NUM_COUNTS ((int) (sizeof(counts) / sizeof(counts[0])))
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv) {
+  const int frames = argc > 1 ? atoi(argv[1]) : 60;
+
+  printf("%10s %12s %14s\n", "sparks", "ms/pack", "Msparks/s");
+
+  for(int c = 0; c < NUM_COUNTS; c++) {
+    sim_t sim;
+    batch_t batch;
+    if(!simInit(&sim, counts[c], 1) || !renderInit(&batch, counts[c])) {
+      fprintf(stderr, "Unable to allocate %d sparks\n", counts[c]);
+      return 1;
+    }
+
+    /* a full pool of sparks with a spread of sizes and colors */
+    sim.settings.maxSize = 16;
+    sim.settings.sparks = 1000;
+    for(int queued = 0; queued < counts[c]; queued += sim.settings.sparks / 2) {
+      simAddSpark(&sim, 500.0f, 500.0f);
+    }
+    simUpdate(&sim);
+
+    double total = 0.0;
+    for(int f = 0; f < frames; f++) {
+      const double start = now();
+      renderPack(&batch, &sim.points, sim.settings.maxAge);
+      total += now() - start;
+    }
+
+    const double secs = total / frames;
+    printf("%10d %12.3f %14.1f\n", sim.points.count, secs * 1e3, sim.points.count / secs * 1e-6);
+
+    renderFree(&batch);
+    simFree(&sim);
+  }
+
+  return 0;
+}
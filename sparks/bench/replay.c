@@ -0,0 +1,85 @@
+/*
+ * sparks_replay: run an input log recorded with 'sparks -record' through the
+ * simulation without a window and print a checksum of the final sparks
+ *
+ * usage: sparks_replay <log> [-threads n] [-kernel name]
+ *
+ * the checksum does not depend on the thread count or kernel, so it can be
+ * compared across builds and machines.
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "replay.h"
+#include "sim.h"
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv) {
+  if(argc < 2) {
+    fprintf(stderr, "usage: %s <log> [-threads n] [-kernel name]\n", argv[0]);
+    return 1;
+  }
+
+  int threads = jobsDefaultWorkers();
+  const char* kernel = NULL;
+  for(int i = 2; i < argc; i++) {
+    if(strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+      threads = atoi(argv[++i]);
+    } else if(strcmp(argv[i], "-kernel") == 0 && i + 1 < argc) {
+      kernel = argv[++i];
+    } else {
+      fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+    }
+  }
+
+  FILE* log = fopen(argv[1], "r");
+  if(log == NULL) {
+    fprintf(stderr, "Unable to open '%s'\n", argv[1]);
+    return 1;
+  }
+
+  sim_t sim;
+  if(!simInit(&sim, POOL_CAPACITY_INITIAL, threads)) {
+    fprintf(stderr, "Unable to allocate %d sparks\n", POOL_CAPACITY_INITIAL);
+    return 1;
+  }
+  if(kernel != NULL) {
+    sim.points.integrate = integrateSelect(kernel);
+    if(sim.points.integrate == NULL) {
+      fprintf(stderr, "Unsupported kernel '%s'\n", kernel);
+      return 1;
+    }
+  }
+
+  event_t e;
+  int status, events = 0, ticks = 0, line = 0;
+  const double start = now();
+  while((status = eventRead(log, &e)) != 0) {
+    line++;
+    if(status < 0) {
+      fprintf(stderr, "%s:%d: malformed event\n", argv[1], line);
+      return 1;
+    }
+    eventApply(&sim, &e);
+    events++;
+    if(e.type == EVENT_TICK) ticks++;
+  }
+  const double secs = now() - start;
+  fclose(log);
+
+  printf("events:   %d (%d ticks)\n", events, ticks);
+  printf("time:     %.3f s (%.3f ms/tick)\n", secs, ticks ? secs * 1e3 / ticks : 0.0);
+  printf("sparks:   %d\n", sim.points.count);
+  printf("checksum: %016" PRIx64 "\n", simChecksum(&sim));
+
+  simFree(&sim);
+  return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * sparks_scaling: time simUpdate over a range of spark and thread counts
+ *
+ * usage: sparks_scaling [maxThreads] [frames]
+ *
+ * every frame the population is topped back up to the target count through
+ * simAddSpark, so the timings include spawning, integration and compaction.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sim.h"
+
+/* frames run before timing starts */
+#define WARMUP_FRAMES 10
+
+/* sparks per burst, roughly half of this on average */
+#define BURST_SPARKS 1000
+
+static const int counts[] = { 10000, 100000, 1000000, 10000000 };
+
+#define NUM_COUNTS ((int) (sizeof(counts) / sizeof(counts[0])))
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * queue bursts until live plus queued sparks reach target
+ */
+static void topUp(sim_t* sim, int target) {
+  int queued = 0;
+  for(int q = 0; q < sim->jobs.numWorkers; q++) {
+    queued += sim->queues[q].sparks;
+  }
+
+  while(sim->points.count + queued < target) {
+    const int q = sim->nextQueue;
+    const int before = sim->queues[q].sparks;
+    simAddSpark(sim, 500.0f, 500.0f);
+    queued += sim->queues[q].sparks - before;
+  }
+}
+
+/*
+ * mean seconds per simUpdate holding count sparks on threads workers
+ */
+static double timeUpdate(int count, int threads, int frames) {
+  sim_t sim;
+  if(!simInit(&sim, count + count / 2, threads)) {
+    fprintf(stderr, "Unable to allocate %d sparks\n", count);
+    exit(1);
+  }
+  sim.settings.sparks = BURST_SPARKS;
+
+  double total = 0.0;
+  for(int f = 0; f < WARMUP_FRAMES + frames; f++) {
+    topUp(&sim, count);
+
+    const double start = now();
+    simUpdate(&sim);
+    if(f >= WARMUP_FRAMES) total += now() - start;
+  }
+
+  simFree(&sim);
+  return total / frames;
+}
+
+int main(int argc, char** argv) {
+  const int maxThreads = argc > 1 ? atoi(argv[1]) : jobsDefaultWorkers();
+  const int frames = argc > 2 ? atoi(argv[2]) : 60;
+
+  printf("integrator: %s\n", integrateName(integrateSelect(NULL)));
+  printf("%10s %8s %12s %14s %10s\n", "sparks", "threads", "ms/update", "Msparks/s", "speedup");
+
+  for(int c = 0; c < NUM_COUNTS; c++) {
+    double base = 0.0;
+    for(int t = 1; t <= maxThreads; t++) {
+      const double secs = timeUpdate(counts[c], t, frames);
+      if(t == 1) base = secs;
+      printf("%10d %8d %12.3f %14.1f %10.2f\n", counts[c], t, secs * 1e3,
+             counts[c] / secs * 1e-6, base / secs);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef INTEGRATE_H_
+#define INTEGRATE_H_
+
+/* sparks handled per word of the dead mask */
+#define MASK_BITS 32
+
+/* # of mask words needed to cover n sparks */
+#define maskWords(n) (((n) + MASK_BITS - 1) / MASK_BITS)
+
+/*
+ * integrates sparks [0, n) one timestep in place.  a spark that is off the
+ * world or at least maxAge old on entry is left untouched and its bit is set
+ * in the dead mask (bit i % 32 of dead[i / 32]), every other spark is aged
+ * and moved.  all kernels must produce bit-identical results.
+ */
+typedef void (*integrator_t)(float* x, float* y, float* age,
+                             const float* vx0, const float* vy0, int n,
+                             float yg, int maxAge, unsigned int* dead);
+
+/*
+ * look up a kernel by name ("scalar", "sse2" or "avx2").  NULL selects the
+ * fastest kernel supported by this cpu.  returns NULL if the named kernel is
+ * unknown or unsupported.
+ */
+integrator_t integrateSelect(const char* name);
+
+/*
+ * name of a kernel returned by integrateSelect
+ */
+const char* integrateName(integrator_t kernel);
+
+#endif /*INTEGRATE_H_*/
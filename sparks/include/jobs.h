@@ -0,0 +1,70 @@
+#ifndef JOBS_H_
+#define JOBS_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* size of a cache line, used to keep per-worker state apart */
+#define JOBS_CACHE_LINE 64
+
+/* runs one task of a batch on the given worker */
+typedef void (*task_t)(void* ctx, int task, int worker);
+
+/*
+ * the tasks of the current batch still owned by one worker.  the owner and any
+ * thief both claim tasks with an atomic increment of next.
+ */
+typedef struct {
+  atomic_int next;
+  int end;
+  char pad[JOBS_CACHE_LINE - sizeof(atomic_int) - sizeof(int)];
+} range_t;
+
+/* what each worker thread needs to find its way back */
+struct worker {
+  struct jobs* jobs;
+  int index;
+};
+
+/*
+ * a fixed pool of worker threads running batches of indexed tasks.  every batch
+ * is split evenly over the workers, and a worker that runs out of its own tasks
+ * steals from the others.  the calling thread acts as worker 0.
+ */
+typedef struct jobs {
+  int numWorkers;
+  pthread_t* threads;
+  struct worker* workers;
+  range_t* ranges;
+
+  /* batch hand-off */
+  pthread_mutex_t lock;
+  pthread_cond_t start, done;
+  int generation, busy, quit;
+
+  task_t task;
+  void* ctx;
+} jobs_t;
+
+/*
+ * number of workers to use when none is asked for, one per online cpu
+ */
+int jobsDefaultWorkers(void);
+
+/*
+ * start numWorkers - 1 threads, returns 0 on failure
+ */
+int jobsInit(jobs_t* jobs, int numWorkers);
+
+/*
+ * stop and join all threads
+ */
+void jobsFree(jobs_t* jobs);
+
+/*
+ * run task(ctx, t, worker) for every t in [0, numTasks) and wait for all of
+ * them to finish.  tasks may run in any order and on any worker.
+ */
+void jobsRun(jobs_t* jobs, int numTasks, task_t task, void* ctx);
+
+#endif /*JOBS_H_*/
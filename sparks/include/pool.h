@@ -0,0 +1,89 @@
+#ifndef POOL_H_
+#define POOL_H_
+
+#include "integrate.h"
+#include "jobs.h"
+
+/* default number of sparks the pool can hold */
+#define POOL_CAPACITY_INITIAL (1 << 20)
+
+/* sparks per task in a parallel update, a multiple of MASK_BITS */
+#define POOL_CHUNK 16384
+
+/* stores a rgb color */
+struct color {
+  float r, g, b;
+};
+
+/*
+ * fixed-capacity structure-of-arrays spark storage.  every attribute lives in
+ * its own contiguous, cache-line aligned array, live sparks occupy [0, count)
+ * and dead sparks are removed by moving the last live spark into their slot.
+ */
+typedef struct {
+  int count, capacity;
+
+  /* model attributes */
+  float* age;
+  float* x;
+  float* y;
+  float* vx0;
+  float* vy0;
+
+  /* visual attributes */
+  float* size;
+  struct color* color;
+
+  /* dead mask filled in by the integrator, one bit per spark */
+  unsigned int* dead;
+  integrator_t integrate;
+
+  /* per-chunk survivor counts and merge offsets for parallel updates */
+  int* survivors;
+  int* holes;
+  int* sources;
+} pool_t;
+
+/*
+ * allocate storage for capacity sparks, integrating with the fastest kernel
+ * this cpu supports.  returns 0 on allocation failure
+ */
+int poolInit(pool_t* pool, int capacity);
+
+/*
+ * release all storage held by the pool
+ */
+void poolFree(pool_t* pool);
+
+/*
+ * reserve a slot for a new spark, returns its index or -1 if the pool is full
+ */
+int poolSpawn(pool_t* pool);
+
+/*
+ * age and move every spark, removing those that are off the world or older
+ * than maxAge
+ */
+void poolUpdate(pool_t* pool, float yg, int maxAge);
+
+/*
+ * poolUpdate split into POOL_CHUNK sized tasks run on jobs.  every chunk is
+ * integrated and compacted on its own, then a prefix sum over the chunk
+ * survivor counts tells each move task which holes to fill from the tail.
+ * the order of sparks differs from poolUpdate, the set of sparks does not.
+ */
+void poolUpdateParallel(pool_t* pool, jobs_t* jobs, float yg, int maxAge);
+
+/*
+ * swap-remove the sparks in [begin, end) marked in the dead mask, packing the
+ * survivors at the front of the range.  begin must be a multiple of MASK_BITS.
+ * returns the number of survivors
+ */
+int poolCompact(pool_t* pool, int begin, int end);
+
+/*
+ * remove all sparks
+ */
+void poolClear(pool_t* pool);
+
+#endif /*POOL_H_*/
@@ -0,0 +1,46 @@
+#ifndef RENDER_H_
+#define RENDER_H_
+
+#include "pool.h"
+
+/* largest point size with its own bucket, bigger sparks share the last one */
+#define RENDER_MAX_SIZE 64
+
+/* one spark as handed to glDrawArrays */
+typedef struct {
+  float x, y;
+  float r, g, b;
+} vertex_t;
+
+/*
+ * interleaved client-side vertex array of every spark, grouped by point size
+ * so each size can be drawn with a single glDrawArrays.  sparks of point size
+ * s occupy [first[s], first[s] + count[s]).  packing does not touch GL, so it
+ * can run (and be timed) without a window.
+ */
+typedef struct {
+  vertex_t* vertices;
+  int capacity;
+  int first[RENDER_MAX_SIZE + 1];
+  int count[RENDER_MAX_SIZE + 1];
+
+  /* point size bucket of every spark, kept between the two packing passes */
+  unsigned char* bucket;
+} batch_t;
+
+/*
+ * allocate room for capacity sparks, returns 0 on allocation failure
+ */
+int renderInit(batch_t* batch, int capacity);
+
+/*
+ * release the vertex array
+ */
+void renderFree(batch_t* batch);
+
+/*
+ * fill the vertex array from the pool, fading colors by age
+ */
+void renderPack(batch_t* batch, const pool_t* points, int maxAge);
+
+#endif /*RENDER_H_*/
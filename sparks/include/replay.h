@@ -0,0 +1,50 @@
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sim.h"
+
+/* kinds of recorded input */
+typedef enum {
+  EVENT_SEED,   /* simSeed(seed) */
+  EVENT_SPARK,  /* simAddSpark(x, y), world coordinates */
+  EVENT_KEY,    /* simKeyPress(key) */
+  EVENT_TICK,   /* simUpdate() */
+  EVENT_CLEAR,  /* simClear() */
+  EVENT_RESET   /* simResetSettings() */
+} event_type_t;
+
+/*
+ * one line of an input log: "<ms> <type> [args]", for example
+ *   0 seed 42
+ *   16 tick
+ *   20 spark 512 300
+ *   31 key a
+ */
+typedef struct {
+  int time;
+  event_type_t type;
+  float x, y;
+  unsigned char key;
+  uint64_t seed;
+} event_t;
+
+/*
+ * append an event to a log, returns 0 on write failure
+ */
+int eventWrite(FILE* log, const event_t* e);
+
+/*
+ * read the next event, returns 1 on success, 0 at the end of the log and -1
+ * on a malformed line
+ */
+int eventRead(FILE* log, event_t* e);
+
+/*
+ * feed an event to the simulation
+ */
+void eventApply(sim_t* sim, const event_t* e);
+
+#endif /*REPLAY_H_*/
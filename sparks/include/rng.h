@@ -0,0 +1,38 @@
+#ifndef RNG_H_
+#define RNG_H_
+
+#include <stdint.h>
+
+/*
+ * PCG32 (pcg-random.org): 64 bits of state, 32 bits of output per step.  every
+ * (seed, stream) pair gives an independent sequence, which lets each burst of
+ * sparks draw from its own stream no matter which thread spawns it.
+ */
+typedef struct {
+  uint64_t state, inc;
+} rng_t;
+
+static inline uint32_t rngNext(rng_t* rng) {
+  const uint64_t old = rng->state;
+  rng->state = old * 6364136223846793005ULL + rng->inc;
+  const uint32_t xorshifted = (uint32_t) (((old >> 18u) ^ old) >> 27u);
+  const uint32_t rot = (uint32_t) (old >> 59u);
+  return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+static inline void rngSeed(rng_t* rng, uint64_t seed, uint64_t stream) {
+  rng->state = 0u;
+  rng->inc = (stream << 1u) | 1u;
+  rngNext(rng);
+  rng->state += seed;
+  rngNext(rng);
+}
+
+/*
+ * uniform float in [0, 1)
+ */
+static inline float rngFloat(rng_t* rng) {
+  return (rngNext(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+#endif /*RNG_H_*/
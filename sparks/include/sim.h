@@ -0,0 +1,111 @@
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdint.h>
+
+#include "jobs.h"
+#include "pool.h"
+#include "rng.h"
+
+/* initial physical settings */
+#define SPARK_MAX_SIZE_INITIAL 4
+#define SPARK_MAX_AGE_INITIAL 80
+#define SPARKS_INITIAL 20
+#define YG_INITIAL 0.0055f
+
+/* stores application data */
+struct settings {
+  int sparks, maxAge, maxSize;
+  float yg;
+};
+
+/* a burst of sparks waiting to be spawned at a world location */
+typedef struct {
+  float x, y;
+  int count;
+
+  /* rng stream the burst's sparks are drawn from */
+  uint64_t stream;
+} burst_t;
+
+/*
+ * bursts handed to one worker.  filled by simAddSpark and drained in parallel
+ * at the start of the next simUpdate.
+ */
+typedef struct {
+  burst_t* bursts;
+  int count, capacity;
+
+  /* total sparks in all bursts, and where they land in the pool */
+  int sparks;
+  int base;
+} spawnq_t;
+
+/*
+ * the spark simulation, independent of any window
+ */
+typedef struct {
+  struct settings settings;
+  pool_t points;
+  jobs_t jobs;
+
+  spawnq_t* queues;
+  int nextQueue;
+
+  /* burst sizes come from rng, burst n's sparks from stream n + 1 of seed */
+  uint64_t seed;
+  uint64_t bursts;
+  rng_t rng;
+} sim_t;
+
+/*
+ * set up a simulation holding at most capacity sparks, updated by numWorkers
+ * threads.  returns 0 on failure
+ */
+int simInit(sim_t* sim, int capacity, int numWorkers);
+
+/*
+ * stop the workers and release all storage
+ */
+void simFree(sim_t* sim);
+
+/*
+ * restart the random sequences from seed.  two simulations with the same seed
+ * fed the same calls end with the same sparks, whatever their thread count.
+ */
+void simSeed(sim_t* sim, uint64_t seed);
+
+/*
+ * restore the initial physical settings
+ */
+void simResetSettings(sim_t* sim);
+
+/*
+ * queue a random amount of sparks at the given world location.  this only
+ * records the burst, the sparks appear on the next simUpdate.
+ */
+void simAddSpark(sim_t* sim, float x, float y);
+
+/*
+ * spawn the queued bursts, then age and move every spark
+ */
+void simUpdate(sim_t* sim);
+
+/*
+ * remove all sparks, including queued ones
+ */
+void simClear(sim_t* sim);
+
+/*
+ * adjust the settings for a key, returns 0 if the key means nothing
+ *   A/Z: more/less sparks, S/X: more/less gravity,
+ *   D/C: bigger/smaller sparks, F/V: longer/shorter life
+ */
+int simKeyPress(sim_t* sim, unsigned char key);
+
+/*
+ * order-independent hash of every live spark, for comparing runs
+ */
+uint64_t simChecksum(const sim_t* sim);
+
+#endif /*SIM_H_*/
@@ -0,0 +1,158 @@
+#include <string.h>
+
+#include "integrate.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * the vector kernels evaluate exactly the same float operations in the same
+ * order as this one (no fused multiply-add), which is what keeps them
+ * bit-identical to it.  the tail of every vector kernel also runs through here.
+ */
+static inline void integrateOne(float* x, float* y, float* age,
+                                const float* vx0, const float* vy0, int i,
+                                float halfYg, float maxAge, unsigned int* dead) {
+  if(y[i] <= 0.0f || age[i] >= maxAge) {
+    dead[i / MASK_BITS] |= 1u << (i % MASK_BITS);
+  } else {
+    const float a = age[i] + 1.0f;
+    age[i] = a;
+    x[i] += vx0[i];
+    y[i] -= vy0[i] + halfYg * a * a;
+  }
+}
+
+static void integrateScalar(float* x, float* y, float* age,
+                            const float* vx0, const float* vy0, int n,
+                            float yg, int maxAge, unsigned int* dead) {
+  const float halfYg = 0.5f * yg;
+  memset(dead, 0, maskWords(n) * sizeof(unsigned int));
+
+  for(int i = 0; i < n; i++) {
+    integrateOne(x, y, age, vx0, vy0, i, halfYg, (float) maxAge, dead);
+  }
+}
+
+#ifdef HAVE_X86
+
+__attribute__((target("sse2")))
+static void integrateSSE2(float* x, float* y, float* age,
+                          const float* vx0, const float* vy0, int n,
+                          float yg, int maxAge, unsigned int* dead) {
+  const float halfYg = 0.5f * yg;
+  const __m128 vHalfYg = _mm_set1_ps(halfYg);
+  const __m128 vMaxAge = _mm_set1_ps((float) maxAge);
+  const __m128 vZero = _mm_setzero_ps();
+  const __m128 vOne = _mm_set1_ps(1.0f);
+  memset(dead, 0, maskWords(n) * sizeof(unsigned int));
+
+  int i = 0;
+  for(; i + 4 <= n; i += 4) {
+    const __m128 py = _mm_loadu_ps(y + i);
+    const __m128 pa = _mm_loadu_ps(age + i);
+    const __m128 px = _mm_loadu_ps(x + i);
+
+    /* are we off the world or 'dead'? */
+    const __m128 d = _mm_or_ps(_mm_cmple_ps(py, vZero), _mm_cmpge_ps(pa, vMaxAge));
+    dead[i / MASK_BITS] |= (unsigned int) _mm_movemask_ps(d) << (i % MASK_BITS);
+
+    /* update position */
+    const __m128 a = _mm_add_ps(pa, vOne);
+    const __m128 nx = _mm_add_ps(px, _mm_loadu_ps(vx0 + i));
+    const __m128 ny = _mm_sub_ps(py, _mm_add_ps(_mm_loadu_ps(vy0 + i),
+                                                _mm_mul_ps(_mm_mul_ps(vHalfYg, a), a)));
+
+    /* dead lanes keep their old values */
+    _mm_storeu_ps(age + i, _mm_or_ps(_mm_and_ps(d, pa), _mm_andnot_ps(d, a)));
+    _mm_storeu_ps(x + i, _mm_or_ps(_mm_and_ps(d, px), _mm_andnot_ps(d, nx)));
+    _mm_storeu_ps(y + i, _mm_or_ps(_mm_and_ps(d, py), _mm_andnot_ps(d, ny)));
+  }
+
+  for(; i < n; i++) {
+    integrateOne(x, y, age, vx0, vy0, i, halfYg, (float) maxAge, dead);
+  }
+}
+
+__attribute__((target("avx2")))
+static void integrateAVX2(float* x, float* y, float* age,
+                          const float* vx0, const float* vy0, int n,
+                          float yg, int maxAge, unsigned int* dead) {
+  const float halfYg = 0.5f * yg;
+  const __m256 vHalfYg = _mm256_set1_ps(halfYg);
+  const __m256 vMaxAge = _mm256_set1_ps((float) maxAge);
+  const __m256 vZero = _mm256_setzero_ps();
+  const __m256 vOne = _mm256_set1_ps(1.0f);
+  memset(dead, 0, maskWords(n) * sizeof(unsigned int));
+
+  int i = 0;
+  for(; i + 8 <= n; i += 8) {
+    const __m256 py = _mm256_loadu_ps(y + i);
+    const __m256 pa = _mm256_loadu_ps(age + i);
+    const __m256 px = _mm256_loadu_ps(x + i);
+
+    /* are we off the world or 'dead'? */
+    const __m256 d = _mm256_or_ps(_mm256_cmp_ps(py, vZero, _CMP_LE_OQ),
+                                  _mm256_cmp_ps(pa, vMaxAge, _CMP_GE_OQ));
+    dead[i / MASK_BITS] |= (unsigned int) _mm256_movemask_ps(d) << (i % MASK_BITS);
+
+    /* update position */
+    const __m256 a = _mm256_add_ps(pa, vOne);
+    const __m256 nx = _mm256_add_ps(px, _mm256_loadu_ps(vx0 + i));
+    const __m256 ny = _mm256_sub_ps(py, _mm256_add_ps(_mm256_loadu_ps(vy0 + i),
+                                                      _mm256_mul_ps(_mm256_mul_ps(vHalfYg, a), a)));
+
+    /* dead lanes keep their old values */
+    _mm256_storeu_ps(age + i, _mm256_blendv_ps(a, pa, d));
+    _mm256_storeu_ps(x + i, _mm256_blendv_ps(nx, px, d));
+    _mm256_storeu_ps(y + i, _mm256_blendv_ps(ny, py, d));
+  }
+
+  for(; i < n; i++) {
+    integrateOne(x, y, age, vx0, vy0, i, halfYg, (float) maxAge, dead);
+  }
+}
+
+#endif /* HAVE_X86 */
+
+/* known kernels, fastest first */
+static const struct {
+  const char* name;
+  integrator_t kernel;
+} kernels[] = {
+#ifdef HAVE_X86
+  { "avx2", integrateAVX2 },
+  { "sse2", integrateSSE2 },
+#endif
+  { "scalar", integrateScalar }
+};
+
+#define NUM_KERNELS ((int) (sizeof(kernels) / sizeof(kernels[0])))
+
+static int kernelSupported(integrator_t kernel) {
+#ifdef HAVE_X86
+  __builtin_cpu_init();
+  if(kernel == integrateAVX2) return __builtin_cpu_supports("avx2");
+  if(kernel == integrateSSE2) return __builtin_cpu_supports("sse2");
+#endif
+  return 1;
+}
+
+integrator_t integrateSelect(const char* name) {
+  for(int i = 0; i < NUM_KERNELS; i++) {
+    if(name == NULL || strcmp(name, kernels[i].name) == 0) {
+      if(kernelSupported(kernels[i].kernel)) return kernels[i].kernel;
+      if(name != NULL) return NULL;
+    }
+  }
+  return NULL;
+}
+
+const char* integrateName(integrator_t kernel) {
+  for(int i = 0; i < NUM_KERNELS; i++) {
+    if(kernels[i].kernel == kernel) return kernels[i].name;
+  }
+  return "unknown";
+}
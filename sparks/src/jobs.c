@@ -0,0 +1,140 @@
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "jobs.h"
+
+int jobsDefaultWorkers(void) {
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int) n : 1;
+}
+
+/*
+ * run tasks until there are none left anywhere, own range first
+ */
+static void jobsWork(jobs_t* jobs, int worker) {
+  for(int i = 0; i < jobs->numWorkers; i++) {
+    range_t* r = &jobs->ranges[(worker + i) % jobs->numWorkers];
+    int t;
+    while((t = atomic_fetch_add(&r->next, 1)) < r->end) {
+      jobs->task(jobs->ctx, t, worker);
+    }
+  }
+}
+
+static void* jobsThread(void* arg) {
+  struct worker* w = (struct worker*) arg;
+  jobs_t* jobs = w->jobs;
+  int seen = 0;
+
+  pthread_mutex_lock(&jobs->lock);
+  for(;;) {
+    while(jobs->generation == seen && !jobs->quit) {
+      pthread_cond_wait(&jobs->start, &jobs->lock);
+    }
+    if(jobs->quit) break;
+    seen = jobs->generation;
+    pthread_mutex_unlock(&jobs->lock);
+
+    jobsWork(jobs, w->index);
+
+    pthread_mutex_lock(&jobs->lock);
+    if(--jobs->busy == 0) pthread_cond_signal(&jobs->done);
+  }
+  pthread_mutex_unlock(&jobs->lock);
+
+  return NULL;
+}
+
+int jobsInit(jobs_t* jobs, int numWorkers) {
+  if(numWorkers < 1) numWorkers = 1;
+
+  jobs->numWorkers = numWorkers;
+  jobs->generation = jobs->busy = jobs->quit = 0;
+  jobs->threads = (pthread_t*) malloc(numWorkers * sizeof(pthread_t));
+  jobs->workers = (struct worker*) malloc(numWorkers * sizeof(struct worker));
+  if(posix_memalign((void**) &jobs->ranges, JOBS_CACHE_LINE, numWorkers * sizeof(range_t)) != 0) {
+    jobs->ranges = NULL;
+  }
+  if(!jobs->threads || !jobs->workers || !jobs->ranges) {
+    free(jobs->threads);
+    free(jobs->workers);
+    free(jobs->ranges);
+    return 0;
+  }
+
+  pthread_mutex_init(&jobs->lock, NULL);
+  pthread_cond_init(&jobs->start, NULL);
+  pthread_cond_init(&jobs->done, NULL);
+
+  for(int i = 0; i < numWorkers; i++) {
+    atomic_init(&jobs->ranges[i].next, 0);
+    jobs->ranges[i].end = 0;
+    jobs->workers[i].jobs = jobs;
+    jobs->workers[i].index = i;
+  }
+
+  /* worker 0 is whoever calls jobsRun */
+  for(int i = 1; i < numWorkers; i++) {
+    if(pthread_create(&jobs->threads[i], NULL, jobsThread, &jobs->workers[i]) != 0) {
+      jobs->numWorkers = i;
+      jobsFree(jobs);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void jobsFree(jobs_t* jobs) {
+  pthread_mutex_lock(&jobs->lock);
+  jobs->quit = 1;
+  pthread_cond_broadcast(&jobs->start);
+  pthread_mutex_unlock(&jobs->lock);
+
+  for(int i = 1; i < jobs->numWorkers; i++) {
+    pthread_join(jobs->threads[i], NULL);
+  }
+
+  pthread_cond_destroy(&jobs->done);
+  pthread_cond_destroy(&jobs->start);
+  pthread_mutex_destroy(&jobs->lock);
+
+  free(jobs->threads);
+  free(jobs->workers);
+  free(jobs->ranges);
+  jobs->threads = NULL;
+  jobs->workers = NULL;
+  jobs->ranges = NULL;
+  jobs->numWorkers = 0;
+}
+
+void jobsRun(jobs_t* jobs, int numTasks, task_t task, void* ctx) {
+  if(numTasks <= 0) return;
+
+  /* not worth waking anybody up */
+  if(jobs->numWorkers == 1 || numTasks == 1) {
+    for(int t = 0; t < numTasks; t++) task(ctx, t, 0);
+    return;
+  }
+
+  /* deal out an even share to every worker */
+  for(int i = 0; i < jobs->numWorkers; i++) {
+    atomic_store(&jobs->ranges[i].next, (int) ((long) numTasks * i / jobs->numWorkers));
+    jobs->ranges[i].end = (int) ((long) numTasks * (i + 1) / jobs->numWorkers);
+  }
+
+  pthread_mutex_lock(&jobs->lock);
+  jobs->task = task;
+  jobs->ctx = ctx;
+  jobs->busy = jobs->numWorkers - 1;
+  jobs->generation++;
+  pthread_cond_broadcast(&jobs->start);
+  pthread_mutex_unlock(&jobs->lock);
+
+  jobsWork(jobs, 0);
+
+  pthread_mutex_lock(&jobs->lock);
+  while(jobs->busy > 0) {
+    pthread_cond_wait(&jobs->done, &jobs->lock);
+  }
+  pthread_mutex_unlock(&jobs->lock);
+}
@@ -0,0 +1,250 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "pool.h"
+
+/* alignment of every pool array, one cache line */
+#define POOL_ALIGN 64
+
+/* # of chunks needed to cover n sparks */
+#define numChunks(n) (((n) + POOL_CHUNK - 1) / POOL_CHUNK)
+
+/* sparks moved per task when merging chunks */
+#define MOVE_CHUNK 16384
+
+/*
+ * cache-line aligned allocation, NULL on failure
+ */
+static void* poolAlloc(size_t size) {
+  void* p = NULL;
+  if(posix_memalign(&p, POOL_ALIGN, size) != 0) return NULL;
+  return p;
+}
+
+int poolInit(pool_t* pool, int capacity) {
+  pool->count = 0;
+  pool->capacity = capacity;
+  pool->integrate = integrateSelect(NULL);
+
+  pool->age = (float*) poolAlloc(capacity * sizeof(float));
+  pool->x = (float*) poolAlloc(capacity * sizeof(float));
+  pool->y = (float*) poolAlloc(capacity * sizeof(float));
+  pool->vx0 = (float*) poolAlloc(capacity * sizeof(float));
+  pool->vy0 = (float*) poolAlloc(capacity * sizeof(float));
+  pool->size = (float*) poolAlloc(capacity * sizeof(float));
+  pool->color = (struct color*) poolAlloc(capacity * sizeof(struct color));
+  pool->dead = (unsigned int*) poolAlloc(maskWords(capacity) * sizeof(unsigned int));
+  pool->survivors = (int*) poolAlloc((numChunks(capacity) + 1) * sizeof(int));
+  pool->holes = (int*) poolAlloc((numChunks(capacity) + 1) * sizeof(int));
+  pool->sources = (int*) poolAlloc((numChunks(capacity) + 1) * sizeof(int));
+
+  if(!pool->age || !pool->x || !pool->y || !pool->vx0 || !pool->vy0 ||
+     !pool->size || !pool->color || !pool->dead ||
+     !pool->survivors || !pool->holes || !pool->sources) {
+    poolFree(pool);
+    return 0;
+  }
+  return 1;
+}
+
+void poolFree(pool_t* pool) {
+  free(pool->age);
+  free(pool->x);
+  free(pool->y);
+  free(pool->vx0);
+  free(pool->vy0);
+  free(pool->size);
+  free(pool->color);
+  free(pool->dead);
+  free(pool->survivors);
+  free(pool->holes);
+  free(pool->sources);
+
+  pool->age = pool->x = pool->y = pool->vx0 = pool->vy0 = pool->size = NULL;
+  pool->color = NULL;
+  pool->dead = NULL;
+  pool->survivors = pool->holes = pool->sources = NULL;
+  pool->count = pool->capacity = 0;
+}
+
+int poolSpawn(pool_t* pool) {
+  if(pool->count >= pool->capacity) return -1;
+  return pool->count++;
+}
+
+/*
+ * move spark src into slot dst
+ */
+static void poolMove(pool_t* pool, int dst, int src) {
+  pool->age[dst] = pool->age[src];
+  pool->x[dst] = pool->x[src];
+  pool->y[dst] = pool->y[src];
+  pool->vx0[dst] = pool->vx0[src];
+  pool->vy0[dst] = pool->vy0[src];
+  pool->size[dst] = pool->size[src];
+  pool->color[dst] = pool->color[src];
+}
+
+/*
+ * move n sparks starting at src into the non-overlapping slots at dst
+ */
+static void poolMoveRange(pool_t* pool, int dst, int src, int n) {
+  memcpy(pool->age + dst, pool->age + src, n * sizeof(float));
+  memcpy(pool->x + dst, pool->x + src, n * sizeof(float));
+  memcpy(pool->y + dst, pool->y + src, n * sizeof(float));
+  memcpy(pool->vx0 + dst, pool->vx0 + src, n * sizeof(float));
+  memcpy(pool->vy0 + dst, pool->vy0 + src, n * sizeof(float));
+  memcpy(pool->size + dst, pool->size + src, n * sizeof(float));
+  memcpy(pool->color + dst, pool->color + src, n * sizeof(struct color));
+}
+
+/*
+ * is spark i marked in the dead mask?
+ */
+static int poolIsDead(const pool_t* pool, int i) {
+  return (pool->dead[i / MASK_BITS] >> (i % MASK_BITS)) & 1u;
+}
+
+int poolCompact(pool_t* pool, int begin, int end) {
+  for(int w = begin / MASK_BITS; w * MASK_BITS < end; w++) {
+    unsigned int bits = pool->dead[w];
+    while(bits != 0) {
+      const int i = w * MASK_BITS + __builtin_ctz(bits);
+      bits &= bits - 1;
+      if(i >= end) return end - begin;
+
+      /* drop dead sparks off the end, then swap the last live one in */
+      while(end - 1 > i && poolIsDead(pool, end - 1)) end--;
+      if(end - 1 > i) poolMove(pool, i, end - 1);
+      end--;
+    }
+  }
+  return end - begin;
+}
+
+void poolUpdate(pool_t* pool, float yg, int maxAge) {
+  pool->integrate(pool->x, pool->y, pool->age, pool->vx0, pool->vy0,
+                  pool->count, yg, maxAge, pool->dead);
+  pool->count = poolCompact(pool, 0, pool->count);
+}
+
+/* shared state of one parallel update */
+struct update {
+  pool_t* pool;
+  float yg;
+  int maxAge;
+
+  /* sparks alive after the update */
+  int total;
+  int chunks;
+};
+
+/*
+ * integrate and compact a single chunk
+ */
+static void updateChunk(void* ctx, int c, int worker) {
+  struct update* u = (struct update*) ctx;
+  pool_t* pool = u->pool;
+
+  const int begin = c * POOL_CHUNK;
+  const int end = begin + POOL_CHUNK < pool->count ? begin + POOL_CHUNK : pool->count;
+
+  pool->integrate(pool->x + begin, pool->y + begin, pool->age + begin,
+                  pool->vx0 + begin, pool->vy0 + begin, end - begin,
+                  u->yg, u->maxAge, pool->dead + begin / MASK_BITS);
+  pool->survivors[c] = poolCompact(pool, begin, end);
+}
+
+/*
+ * the holes chunk c leaves below total and the survivors it keeps at or above
+ * it.  together every chunk has as many of one as of the other.
+ */
+static void chunkHoles(const struct update* u, int c, int* start, int* len) {
+  const int begin = c * POOL_CHUNK + u->pool->survivors[c];
+  const int end = (c + 1) * POOL_CHUNK < u->total ? (c + 1) * POOL_CHUNK : u->total;
+  *start = begin;
+  *len = end > begin ? end - begin : 0;
+}
+
+static void chunkSources(const struct update* u, int c, int* start, int* len) {
+  const int begin = c * POOL_CHUNK > u->total ? c * POOL_CHUNK : u->total;
+  const int end = c * POOL_CHUNK + u->pool->survivors[c];
+  *start = begin;
+  *len = end > begin ? end - begin : 0;
+}
+
+/*
+ * last chunk whose exclusive prefix is <= k
+ */
+static int findChunk(const int* prefix, int chunks, int k) {
+  int lo = 0, hi = chunks;
+  while(hi - lo > 1) {
+    const int mid = (lo + hi) / 2;
+    if(prefix[mid] <= k) lo = mid; else hi = mid;
+  }
+  return lo;
+}
+
+/*
+ * fill holes [k, k + MOVE_CHUNK) from the matching survivors past the end
+ */
+static void mergeChunk(void* ctx, int t, int worker) {
+  struct update* u = (struct update*) ctx;
+  pool_t* pool = u->pool;
+
+  const int moves = pool->holes[u->chunks];
+  int k = t * MOVE_CHUNK;
+  const int kEnd = k + MOVE_CHUNK < moves ? k + MOVE_CHUNK : moves;
+
+  int hc = findChunk(pool->holes, u->chunks, k);
+  int sc = findChunk(pool->sources, u->chunks, k);
+  while(k < kEnd) {
+    int hStart, hLen, sStart, sLen;
+    chunkHoles(u, hc, &hStart, &hLen);
+    chunkSources(u, sc, &sStart, &sLen);
+
+    const int hOff = k - pool->holes[hc];
+    const int sOff = k - pool->sources[sc];
+    int n = kEnd - k;
+    if(hLen - hOff < n) n = hLen - hOff;
+    if(sLen - sOff < n) n = sLen - sOff;
+
+    if(n > 0) {
+      poolMoveRange(pool, hStart + hOff, sStart + sOff, n);
+      k += n;
+    }
+    if(hOff + n >= hLen) hc++;
+    if(sOff + n >= sLen) sc++;
+  }
+}
+
+void poolUpdateParallel(pool_t* pool, jobs_t* jobs, float yg, int maxAge) {
+  if(jobs->numWorkers == 1 || pool->count <= POOL_CHUNK) {
+    poolUpdate(pool, yg, maxAge);
+    return;
+  }
+
+  struct update u = { pool, yg, maxAge, 0, numChunks(pool->count) };
+  jobsRun(jobs, u.chunks, updateChunk, &u);
+
+  /* prefix sums over survivors, holes and the survivors that fill them */
+  for(int c = 0; c < u.chunks; c++) {
+    u.total += pool->survivors[c];
+  }
+  pool->holes[0] = pool->sources[0] = 0;
+  for(int c = 0; c < u.chunks; c++) {
+    int start, len;
+    chunkHoles(&u, c, &start, &len);
+    pool->holes[c + 1] = pool->holes[c] + len;
+    chunkSources(&u, c, &start, &len);
+    pool->sources[c + 1] = pool->sources[c] + len;
+  }
+
+  const int moves = pool->holes[u.chunks];
+  jobsRun(jobs, (moves + MOVE_CHUNK - 1) / MOVE_CHUNK, mergeChunk, &u);
+  pool->count = u.total;
+}
+
+void poolClear(pool_t* pool) {
+  pool->count = 0;
+}
@@ -0,0 +1,64 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "render.h"
+
+int renderInit(batch_t* batch, int capacity) {
+  batch->capacity = capacity;
+  batch->vertices = (vertex_t*) malloc(capacity * sizeof(vertex_t));
+  batch->bucket = (unsigned char*) malloc(capacity);
+  memset(batch->first, 0, sizeof(batch->first));
+  memset(batch->count, 0, sizeof(batch->count));
+
+  if(batch->vertices == NULL || batch->bucket == NULL) {
+    renderFree(batch);
+    return 0;
+  }
+  return 1;
+}
+
+void renderFree(batch_t* batch) {
+  free(batch->vertices);
+  free(batch->bucket);
+  batch->vertices = NULL;
+  batch->bucket = NULL;
+  batch->capacity = 0;
+}
+
+void renderPack(batch_t* batch, const pool_t* points, int maxAge) {
+  const int n = points->count < batch->capacity ? points->count : batch->capacity;
+
+  /* count sparks per point size, rounded the way GL rasterizes them */
+  memset(batch->count, 0, sizeof(batch->count));
+  for(int i = 0; i < n; i++) {
+    int s = (int) (points->size[i] + 0.5f);
+    if(s < 1) s = 1;
+    if(s > RENDER_MAX_SIZE) s = RENDER_MAX_SIZE;
+    batch->bucket[i] = (unsigned char) s;
+    batch->count[s]++;
+  }
+
+  /* bucket start offsets, reusing count as the fill cursor */
+  int first = 0;
+  for(int s = 0; s <= RENDER_MAX_SIZE; s++) {
+    batch->first[s] = first;
+    first += batch->count[s];
+    batch->count[s] = batch->first[s];
+  }
+
+  for(int i = 0; i < n; i++) {
+    vertex_t* v = &batch->vertices[batch->count[batch->bucket[i]]++];
+    const struct color c = points->color[i];
+    const float ageRatio = 1.0f - (points->age[i] / maxAge);
+    v->x = points->x[i];
+    v->y = points->y[i];
+    v->r = c.r * ageRatio;
+    v->g = c.g * ageRatio;
+    v->b = c.b * ageRatio;
+  }
+
+  /* turn the cursors back into counts */
+  for(int s = 0; s <= RENDER_MAX_SIZE; s++) {
+    batch->count[s] -= batch->first[s];
+  }
+}
@@ -0,0 +1,80 @@
+#include <inttypes.h>
+#include <string.h>
+
+#include "replay.h"
+
+/* log names of the event types, indexed by event_type_t */
+static const char* names[] = { "seed", "spark", "key", "tick", "clear", "reset" };
+
+#define NUM_NAMES ((int) (sizeof(names) / sizeof(names[0])))
+
+int eventWrite(FILE* log, const event_t* e) {
+  int n = 0;
+  switch(e->type) {
+  case EVENT_SEED:
+    n = fprintf(log, "%d seed %" PRIu64 "\n", e->time, e->seed);
+    break;
+  case EVENT_SPARK:
+    n = fprintf(log, "%d spark %.9g %.9g\n", e->time, e->x, e->y);
+    break;
+  case EVENT_KEY:
+    n = fprintf(log, "%d key %d\n", e->time, e->key);
+    break;
+  default:
+    n = fprintf(log, "%d %s\n", e->time, names[e->type]);
+  }
+  return n > 0;
+}
+
+int eventRead(FILE* log, event_t* e) {
+  char line[128], name[16];
+  int used = 0;
+
+  if(fgets(line, sizeof(line), log) == NULL) return 0;
+  if(sscanf(line, "%d %15s %n", &e->time, name, &used) != 2) return -1;
+
+  for(int t = 0; t < NUM_NAMES; t++) {
+    if(strcmp(name, names[t]) == 0) {
+      const char* args = line + used;
+      int key;
+      e->type = (event_type_t) t;
+
+      switch(e->type) {
+      case EVENT_SEED:
+        return sscanf(args, "%" SCNu64, &e->seed) == 1 ? 1 : -1;
+      case EVENT_SPARK:
+        return sscanf(args, "%f %f", &e->x, &e->y) == 2 ? 1 : -1;
+      case EVENT_KEY:
+        if(sscanf(args, "%d", &key) != 1) return -1;
+        e->key = (unsigned char) key;
+        return 1;
+      default:
+        return 1;
+      }
+    }
+  }
+  return -1;
+}
+
+void eventApply(sim_t* sim, const event_t* e) {
+  switch(e->type) {
+  case EVENT_SEED:
+    simSeed(sim, e->seed);
+    break;
+  case EVENT_SPARK:
+    simAddSpark(sim, e->x, e->y);
+    break;
+  case EVENT_KEY:
+    simKeyPress(sim, e->key);
+    break;
+  case EVENT_TICK:
+    simUpdate(sim);
+    break;
+  case EVENT_CLEAR:
+    simClear(sim);
+    break;
+  case EVENT_RESET:
+    simResetSettings(sim);
+    break;
+  }
+}
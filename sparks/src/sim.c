@@ -0,0 +1,230 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "sim.h"
+
+#define TWOPI (2.0 * 3.14159f)
+
+/* wrapper around rngFloat() to provide min/max bounds */
+#define boundedRandom(rng, min, max) ((max - min) * rngFloat(rng)) + min
+
+/* initial capacity of a spawn queue, in bursts */
+#define SPAWNQ_INITIAL 64
+
+int simInit(sim_t* sim, int capacity, int numWorkers) {
+  simResetSettings(sim);
+  simSeed(sim, 1);
+  sim->nextQueue = 0;
+
+  if(!poolInit(&sim->points, capacity)) return 0;
+  if(!jobsInit(&sim->jobs, numWorkers)) {
+    poolFree(&sim->points);
+    return 0;
+  }
+
+  /* one spawn queue per worker */
+  sim->queues = (spawnq_t*) calloc(sim->jobs.numWorkers, sizeof(spawnq_t));
+  if(sim->queues == NULL) {
+    jobsFree(&sim->jobs);
+    poolFree(&sim->points);
+    return 0;
+  }
+  return 1;
+}
+
+void simFree(sim_t* sim) {
+  for(int q = 0; q < sim->jobs.numWorkers; q++) {
+    free(sim->queues[q].bursts);
+  }
+  free(sim->queues);
+  sim->queues = NULL;
+
+  jobsFree(&sim->jobs);
+  poolFree(&sim->points);
+}
+
+void simSeed(sim_t* sim, uint64_t seed) {
+  sim->seed = seed;
+  sim->bursts = 0;
+  rngSeed(&sim->rng, seed, 0);
+}
+
+void simResetSettings(sim_t* sim) {
+  sim->settings.sparks = SPARKS_INITIAL;
+  sim->settings.maxAge = SPARK_MAX_AGE_INITIAL;
+  sim->settings.maxSize = SPARK_MAX_SIZE_INITIAL;
+  sim->settings.yg = YG_INITIAL;
+}
+
+void simAddSpark(sim_t* sim, float x, float y) {
+  /* hand bursts out to the workers in turn */
+  spawnq_t* q = &sim->queues[sim->nextQueue];
+  sim->nextQueue = (sim->nextQueue + 1) % sim->jobs.numWorkers;
+
+  if(q->count == q->capacity) {
+    const int capacity = q->capacity ? 2 * q->capacity : SPAWNQ_INITIAL;
+    burst_t* bursts = (burst_t*) realloc(q->bursts, capacity * sizeof(burst_t));
+    if(bursts == NULL) return;
+    q->bursts = bursts;
+    q->capacity = capacity;
+  }
+
+  burst_t* b = &q->bursts[q->count++];
+  b->x = x;
+  b->y = y;
+  b->count = (int) boundedRandom(&sim->rng, 1, sim->settings.sparks);
+  b->stream = ++sim->bursts;
+  q->sparks += b->count;
+}
+
+/*
+ * fill the slots reserved for spawn queue q with its bursts
+ */
+static void spawnQueue(void* ctx, int qIndex, int worker) {
+  sim_t* sim = (sim_t*) ctx;
+  spawnq_t* q = &sim->queues[qIndex];
+  pool_t* points = &sim->points;
+
+  /* number of sides of the regular polygon from which the x and y initial velocities
+   * will be selected.  the equations are influenced by those on pg. 111 in the Hill book */
+  const int numSides = 10;
+
+  /* x and y radii of the regular polygon */
+  const float xr = 4.0f, yr = 5.0f;
+
+  int s = q->base;
+  const int end = q->base + q->sparks;
+  for(int b = 0; b < q->count && s < end; b++) {
+    const burst_t* burst = &q->bursts[b];
+    rng_t rng;
+    rngSeed(&rng, sim->seed, burst->stream);
+
+    for(int i = 0; i < burst->count && s < end; i++, s++) {
+      /* assign model attributes */
+      points->age[s] = 0.0f;
+      points->x[s] = burst->x;
+      points->y[s] = burst->y;
+
+      /* select a radius within the polygon */
+      float radius = TWOPI * boundedRandom(&rng, 1, numSides) / numSides;
+
+      /* compute initial velocities */
+      points->vx0[s] = (xr * boundedRandom(&rng, 0.2f, 1.0f)) * cos(radius);
+      points->vy0[s] = (yr * boundedRandom(&rng, 0.2f, 1.0f)) * sin(radius) - 3.0f;
+
+      /* assign view attributes */
+      points->size[s] = boundedRandom(&rng, 1.0f, sim->settings.maxSize);
+      points->color[s].r = boundedRandom(&rng, 0.5f, 1.0f);
+      points->color[s].g = boundedRandom(&rng, 0.5f, 1.0f);
+      points->color[s].b = boundedRandom(&rng, 0.5f, 1.0f);
+    }
+  }
+
+  q->count = q->sparks = 0;
+}
+
+void simUpdate(sim_t* sim) {
+  pool_t* points = &sim->points;
+
+  /* reserve pool slots for every queue, silently dropping what does not fit */
+  int pending = 0;
+  for(int q = 0; q < sim->jobs.numWorkers; q++) {
+    spawnq_t* queue = &sim->queues[q];
+    const int room = points->capacity - points->count;
+    if(queue->sparks > room) queue->sparks = room;
+    queue->base = points->count;
+    points->count += queue->sparks;
+    pending += queue->count;
+  }
+  if(pending > 0) {
+    jobsRun(&sim->jobs, sim->jobs.numWorkers, spawnQueue, sim);
+  }
+
+  poolUpdateParallel(points, &sim->jobs, sim->settings.yg, sim->settings.maxAge);
+}
+
+void simClear(sim_t* sim) {
+  for(int q = 0; q < sim->jobs.numWorkers; q++) {
+    sim->queues[q].count = sim->queues[q].sparks = 0;
+  }
+  poolClear(&sim->points);
+}
+
+int simKeyPress(sim_t* sim, unsigned char key) {
+  struct settings* settings = &sim->settings;
+
+  switch(key) {
+  case 'a':
+  case 'A':
+    settings->sparks++;
+    break;
+  case 'z':
+  case 'Z':
+    if(settings->sparks > 1) settings->sparks--;
+    break;
+  case 's':
+  case 'S':
+    settings->yg += settings->yg;
+    break;
+  case 'x':
+  case 'X':
+    settings->yg /= 2.0f;
+    break;
+  case 'd':
+  case 'D':
+    settings->maxSize++;
+    break;
+  case 'c':
+  case 'C':
+    if(settings->maxSize > 1) settings->maxSize--;
+    break;
+  case 'f':
+  case 'F':
+    settings->maxAge++;
+    break;
+  case 'v':
+  case 'V':
+    if(settings->maxAge > 1) settings->maxAge--;
+    break;
+  default:
+    return 0;
+  }
+  return 1;
+}
+
+/*
+ * splitmix64 finalizer
+ */
+static uint64_t mix(uint64_t h) {
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+  return h ^ (h >> 31);
+}
+
+static uint64_t mixFloat(uint64_t h, float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  return mix(h ^ bits);
+}
+
+uint64_t simChecksum(const sim_t* sim) {
+  const pool_t* points = &sim->points;
+
+  /* hash each spark on its own and add them up, so their order is irrelevant */
+  uint64_t sum = mix(points->count);
+  for(int i = 0; i < points->count; i++) {
+    uint64_t h = 0;
+    h = mixFloat(h, points->age[i]);
+    h = mixFloat(h, points->x[i]);
+    h = mixFloat(h, points->y[i]);
+    h = mixFloat(h, points->vx0[i]);
+    h = mixFloat(h, points->vy0[i]);
+    h = mixFloat(h, points->size[i]);
+    h = mixFloat(h, points->color[i].r);
+    h = mixFloat(h, points->color[i].g);
+    h = mixFloat(h, points->color[i].b);
+    sum += h;
+  }
+  return sum;
+}
@@ -1,20 +1,18 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <glut.h>
 
+#include "render.h"
+#include "replay.h"
+#include "sim.h"
+
 /* escape key for keyboard func */
 #define KEY_ESC 27
 
 #define SHOWFPS 1
 #define TITLEBASE "Sparks!"
-#define TWOPI (2.0 * 3.14159f)
-
-/* initial physical settings */
-#define SPARK_MAX_SIZE_INITIAL 4
-#define SPARK_MAX_AGE_INITIAL 80
-#define SPARKS_INITIAL 20
-#define YG_INITIAL 0.0055f
 
 /* world x/y bounds */
 #define x0 0.0f
@@ -22,54 +20,32 @@
 #define y0 0.0f
 #define y1 1000.0f
 
-/* wrapper around rand() to provide min/max bounds */
-#define boundedRandom(min, max) ((max - min) * (float) rand() / RAND_MAX) + min
-
 /* assigns the timer function to updatePositions */
 /* 1000 * 1.0 / (FRAMERATE) */
 #define setTimerFunc() glutTimerFunc((int) (1000 * (1.0f / 60.0f)), updatePositions, 0)
 
-/* frees point and node */
-#define freeNode(n) free(n->p); free(n)
-
-/* stores application data */
-struct settings {
-  int sparks, maxAge, maxSize;
-  float yg;
-} settings;
-
 enum {
   CLEAR_POINTS, RESET_SETTINGS
 };
 
-/* stores a rgb color */
-struct color {
-  GLfloat r, g, b;
-};
+/* command line options */
+struct options {
+  const char* kernel;
+  int threads;
+  unsigned long long seed;
+  const char* record;
+} options = { NULL, 0, 1, NULL };
 
-/* models a single point in the world */
-typedef struct {
-  /* model attributes */
-  float age;
-  GLfloat x,y;	/* positions */
-  float vx0, vy0;	/* velocities */
-
-  /* visual attributes */
-  float size;
-  struct color color;
-} point_t;
-
-/* singly linked-list structure to hold points */
-struct node {
-  point_t* p;
-  struct node* next;
-};
+/* input log being recorded, if any */
+FILE* recording = NULL;
 
-/* the points */
-struct points {
-  struct node* head;
-  struct node* tail;
-} points;
+/* the simulation, with its settings and points */
+sim_t sim;
+struct settings* settings = &sim.settings;
+pool_t* points = &sim.points;
+
+/* vertex array the points are drawn from */
+batch_t batch;
 
 /*
  * calculate frames-per-second
@@ -89,39 +65,26 @@ void fps() {
   }
 }
 
+/*
+ * append an input event to the recording, if there is one
+ */
+void record(event_type_t type, float x, float y, unsigned char key) {
+  if(recording == NULL) return;
+
+  event_t e = { glutGet(GLUT_ELAPSED_TIME), type, x, y, key, options.seed };
+  if(!eventWrite(recording, &e)) {
+    fprintf(stderr, "Unable to write recording, stopping\n");
+    fclose(recording);
+    recording = NULL;
+  }
+}
+
 /*
  * update point positions, called by timer
  */
 void updatePositions(int timerCallbackValue) {
-  struct node* prev = NULL;
-  struct node* cur = points.head;
-  while(cur != NULL) 	{
-    point_t* p = cur->p;
-
-    /* are we off the world or 'dead'? */
-    if(p->y <= 0.0 || p->age >= settings.maxAge) {
-      /* save head pointer */
-      struct node* temp = cur;
-
-      if(cur == points.head) {
-        points.head = cur = cur->next;
-      } else {
-        prev->next = cur->next;
-        cur = cur->next;
-      }
-
-      /* release */
-      freeNode(temp);
-    } else {
-      /* update position */
-      p->age++;
-      p->x += p->vx0;
-      p->y -= p->vy0 + 0.5f * settings.yg * p->age * p->age;
-
-      prev = cur;
-      cur = cur->next;
-    }
-  }
+  record(EVENT_TICK, 0, 0, 0);
+  simUpdate(&sim);
 
   glutPostRedisplay();
   setTimerFunc();
@@ -131,17 +94,15 @@ void drawScene() {
   /* clear window */
   glClear(GL_COLOR_BUFFER_BIT);
 
-  struct node* cur = points.head;
-  while(cur != NULL) {
-    point_t* p = cur->p;
-    glPointSize(p->size);
-    struct color c = p->color;
-    float ageRatio = 1.0f - (p->age / settings.maxAge);
-    glColor3f(c.r * ageRatio, c.g * ageRatio, c.b * ageRatio);
-    glBegin(GL_POINTS);
-      glVertex2f(p->x, p->y);
-    glEnd();
-    cur = cur->next;
+  /* one draw call per point size */
+  renderPack(&batch, points, settings->maxAge);
+  glVertexPointer(2, GL_FLOAT, sizeof(vertex_t), &batch.vertices[0].x);
+  glColorPointer(3, GL_FLOAT, sizeof(vertex_t), &batch.vertices[0].r);
+  for(int s = 1; s <= RENDER_MAX_SIZE; s++) {
+    if(batch.count[s] > 0) {
+      glPointSize(s);
+      glDrawArrays(GL_POINTS, batch.first[s], batch.count[s]);
+    }
   }
 
   /* flush GL buffers */
@@ -167,45 +128,8 @@ void addSpark(int x, int y) {
   x = (int) (x1 * (x / (float) width));
     y = (int) (y1 * (height - y) / height);
 
-  /* number of sides of the regular polygon from which the x and y initial velocities
-   * will be selected.  the equations are influenced by those on pg. 111 in the Hill book */
-  const int numSides = 10;
-
-  /* x and y radii of the regular polygon */
-  const float xr = 4.0f, yr = 5.0f;
-
-  const int numSparks = (int) boundedRandom(1, settings.sparks);
-  for(int i = 0; i < numSparks; i++) {
-    /* allocate point and assign model attributes */
-    point_t* p = (point_t*) malloc(sizeof(point_t));
-    p->age = 0.0f;
-    p->x = x;
-    p->y = y;
-
-    /* select a radius within the polygon */
-    float radius = TWOPI * boundedRandom(1, numSides) / numSides;
-
-    /* compute initial velocities */
-    p->vx0 = (xr * boundedRandom(0.2f, 1.0f)) * cos(radius);
-    p->vy0 = (yr * boundedRandom(0.2f, 1.0f)) * sin(radius) - 3.0f;
-
-    /* assign view attributes */
-    p->size = boundedRandom(1.0f, settings.maxSize);
-    p->color.r = boundedRandom(0.5f, 1.0f);
-    p->color.g = boundedRandom(0.5f, 1.0f);
-    p->color.b = boundedRandom(0.5f, 1.0f);
-
-    /* build ll node and attach the point */
-    struct node* n = (struct node*) malloc(sizeof(struct node));
-    n->p = p;
-    n->next = NULL;
-    if(points.head == NULL) {
-      points.tail = points.head = n;
-    } else {
-      points.tail->next = n;
-      points.tail = n;
-    }
-  }
+  record(EVENT_SPARK, x, y, 0);
+  simAddSpark(&sim, x, y);
 }
 
 void mouseClicked(int buttonNum, int state, int x, int y) {
@@ -222,15 +146,8 @@ void mouseMoved(int x, int y) {
  * clear all currently displayed points
  */
 void clearPoints() {
-  struct node* cur = points.head;
-  while(cur != NULL) {
-    /* store current, walk over and free */
-    struct node* temp = cur;
-    cur = cur->next;
-    freeNode(temp);
-  }
-
-  points.head = points.tail = NULL;
+  record(EVENT_CLEAR, 0, 0, 0);
+  simClear(&sim);
 }
 
 /*
@@ -242,10 +159,8 @@ void handleMenu(int sel) {
     clearPoints();
     break;
   case RESET_SETTINGS:
-    settings.sparks = SPARKS_INITIAL;
-    settings.maxAge = SPARK_MAX_AGE_INITIAL;
-    settings.maxSize = SPARK_MAX_SIZE_INITIAL;
-    settings.yg = YG_INITIAL;
+    record(EVENT_RESET, 0, 0, 0);
+    simResetSettings(&sim);
     break;
   }
 }
@@ -257,61 +172,47 @@ void handleMenu(int sel) {
  * X: Less Gravity
  */
 void keyPress(unsigned char key, int x, int y) {
+  if(key == KEY_ESC) exit(0);
+
+  if(!simKeyPress(&sim, key)) {
+    printf("Unknown key '%c', keys:\n", key);
+    printf(" A: More Sparks\n");
+    printf(" Z: Less Sparks\n");
+    printf(" S: More Gravity\n");
+    printf(" X: Less Gravity\n");
+    printf(" D: Bigger Sparks\n");
+    printf(" C: Smaller Sparks\n");
+    printf(" F: Longer Life\n");
+    printf(" V: Shorter Life\n");
+    return;
+  }
+  record(EVENT_KEY, 0, 0, key);
+
   switch(key) {
   case 'a':
   case 'A':
-    settings.sparks++;
-    printf("Sparks: %d\n", settings.sparks);
-    break;
   case 'z':
   case 'Z':
-    if(settings.sparks > 1) settings.sparks--;
-    printf("Sparks: %d\n", settings.sparks);
+    printf("Sparks: %d\n", settings->sparks);
     break;
   case 's':
   case 'S':
-    settings.yg += settings.yg;
-    printf("Gravity: %2.20f\n", settings.yg);
-    break;
   case 'x':
   case 'X':
-    settings.yg /= 2.0f;
-    printf("Gravity: %2.20f\n", settings.yg);
+    printf("Gravity: %2.20f\n", settings->yg);
     break;
   case 'd':
   case 'D':
-    settings.maxSize++;
-    printf("Max Size: %d\n", settings.maxSize);
-    break;
   case 'c':
   case 'C':
-    if(settings.maxSize > 1) settings.maxSize--;
-    printf("Max Size: %d\n", settings.maxSize);
+    printf("Max Size: %d\n", settings->maxSize);
     break;
   case 'f':
   case 'F':
-    settings.maxAge++;
-    printf("Max Age: %d\n", settings.maxAge);
-    break;
   case 'v':
   case 'V':
-    if(settings.maxAge > 1) settings.maxAge--;
-    printf("Max Age: %d\n", settings.maxAge);
-    break;
-    break;
-  case KEY_ESC:
-    exit(0);
+    printf("Max Age: %d\n", settings->maxAge);
     break;
-  default:
-    printf("Unknown key '%c', keys:\n", key);
-    printf(" A: More Sparks\n");
-    printf(" Z: Less Sparks\n");
-    printf(" S: More Gravity\n");
-    printf(" X: Less Gravity\n");
-    printf(" D: Bigger Sparks\n");
-    printf(" C: Smaller Sparks\n");
-    printf(" F: Longer Life\n");
-    printf(" V: Shorter Life\n");
   }
 }
 
@@ -323,14 +224,38 @@ void init(int w, int h) {
   gluOrtho2D(x0, x1, y0, y1);
   glViewport(0, 0, w, h);
 
-  /* fill in initial settings */
-  settings.sparks = SPARKS_INITIAL;
-  settings.maxAge = SPARK_MAX_AGE_INITIAL;
-  settings.maxSize = SPARK_MAX_SIZE_INITIAL;
-  settings.yg = YG_INITIAL;
+  /* initialize the simulation, which fills in initial settings */
+  const int threads = options.threads > 0 ? options.threads : jobsDefaultWorkers();
+  if(!simInit(&sim, POOL_CAPACITY_INITIAL, threads)) {
+    fprintf(stderr, "Unable to allocate %d sparks\n", POOL_CAPACITY_INITIAL);
+    exit(1);
+  }
+  simSeed(&sim, options.seed);
+
+  if(options.record != NULL) {
+    recording = fopen(options.record, "w");
+    if(recording == NULL) {
+      fprintf(stderr, "Unable to record to '%s'\n", options.record);
+      exit(1);
+    }
+    record(EVENT_SEED, 0, 0, 0);
+  }
+
+  if(options.kernel != NULL) {
+    points->integrate = integrateSelect(options.kernel);
+    if(points->integrate == NULL) {
+      fprintf(stderr, "Unsupported kernel '%s'\n", options.kernel);
+      exit(1);
+    }
+  }
+  if(!renderInit(&batch, POOL_CAPACITY_INITIAL)) {
+    fprintf(stderr, "Unable to allocate %d vertices\n", POOL_CAPACITY_INITIAL);
+    exit(1);
+  }
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
 
-  /* initialize the linked list */
-  points.head = points.tail = NULL;
+  printf("Integrator: %s, %d thread(s)\n", integrateName(points->integrate), sim.jobs.numWorkers);
 
   /* utility popup */
   glutCreateMenu(handleMenu);
@@ -339,6 +264,29 @@ void init(int w, int h) {
   glutAttachMenu(GLUT_RIGHT_BUTTON);
 }
 
+/*
+ * handle the command line left over once glut has taken its own options
+ *   -kernel <avx2|sse2|scalar>: force a spark integration kernel
+ *   -threads <n>: simulation worker threads, one per cpu by default
+ *   -seed <n>: seed for the spark random numbers, 1 by default
+ *   -record <file>: log all input for sparks_replay
+ */
+void parseArgs(int argc, char** argv) {
+  for(int i = 1; i < argc; i++) {
+    if(strcmp(argv[i], "-kernel") == 0 && i + 1 < argc) {
+      options.kernel = argv[++i];
+    } else if(strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+      options.threads = atoi(argv[++i]);
+    } else if(strcmp(argv[i], "-seed") == 0 && i + 1 < argc) {
+      options.seed = strtoull(argv[++i], NULL, 10);
+    } else if(strcmp(argv[i], "-record") == 0 && i + 1 < argc) {
+      options.record = argv[++i];
+    } else {
+      fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+    }
+  }
+}
+
 int main(int argc, char** argv) {
   const int w = 640, h = 480;
 
@@ -355,6 +303,7 @@ int main(int argc, char** argv) {
   glutMotionFunc(mouseMoved);
   glutKeyboardFunc(keyPress);
 
+  parseArgs(argc, argv);
   init(w, h);
   glutMainLoop();
 
@@ -0,0 +1,139 @@
+/*
+ * sparks_integrate_test: integrate randomized pools with every kernel this
+ * cpu supports and check that each leaves the pool and the dead mask
+ * bit-identical to the scalar kernel, step after step
+ *
+ * usage: sparks_integrate_test [-seed n]
+ *
+ * counts are picked to leave 1 to 7 sparks for the vector kernels' tails,
+ * and sparks are spawned on the edges of the dead tests (y at or just above
+ * zero, age at or just below maxAge) as well as well clear of them.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pool.h"
+#include "rng.h"
+
+/* timesteps integrated per pool, enough for most sparks to die */
+#define STEPS 48
+
+/* sparks die at this age */
+#define MAX_AGE 32
+
+/* gravity, as the simulation uses it */
+#define GRAVITY 0.05f
+
+/* pool sizes tested, around the 4 and 8 wide vector loops and mask words */
+static const int counts[] = {
+  0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 65, 100, 1001, 4099, 16389
+};
+
+#define NUM_COUNTS ((int) (sizeof(counts) / sizeof(counts[0])))
+
+/* the kernels compared against scalar */
+static const char* vectorKernels[] = { "sse2", "avx2" };
+
+#define NUM_KERNELS ((int) (sizeof(vectorKernels) / sizeof(vectorKernels[0])))
+
+/*
+ * spawn n sparks, drawing their attributes from a stream the caller seeded.
+ * a fifth of them start dead, and another fifth on the edge of dying
+ */
+static void fill(pool_t* pool, int n, rng_t* rng) {
+  for(int i = 0; i < n; i++) {
+    const int s = poolSpawn(pool);
+    pool->x[s] = 640.0f * rngFloat(rng);
+    pool->y[s] = 480.0f * rngFloat(rng);
+    pool->age[s] = (float) (rngNext(rng) % MAX_AGE);
+    pool->vx0[s] = 4.0f * rngFloat(rng) - 2.0f;
+    pool->vy0[s] = 8.0f * rngFloat(rng) - 6.0f;
+
+    switch(rngNext(rng) % 10) {
+    case 0: pool->y[s] = 0.0f; break;
+    case 1: pool->y[s] = -0.0f; break;
+    case 2: pool->y[s] = -480.0f * rngFloat(rng); break;
+    case 3: pool->age[s] = (float) MAX_AGE; break;
+    case 4: pool->age[s] = (float) (MAX_AGE - 1); break;
+    case 5: pool->y[s] = 1e-30f; break;
+    default: break;
+    }
+  }
+}
+
+/*
+ * integrate pool STEPS times with kernel, stale bits in the dead mask each
+ * time so that a kernel which fails to clear it shows up
+ */
+static void run(pool_t* pool, integrator_t kernel) {
+  for(int step = 0; step < STEPS; step++) {
+    memset(pool->dead, 0xa5, maskWords(pool->capacity) * sizeof(unsigned int));
+    kernel(pool->x, pool->y, pool->age, pool->vx0, pool->vy0, pool->count,
+           GRAVITY, MAX_AGE, pool->dead);
+  }
+}
+
+/*
+ * 0 if the first n sparks and their dead mask are bit-identical
+ */
+static int compare(const pool_t* a, const pool_t* b, int n) {
+  const size_t size = n * sizeof(float);
+  return memcmp(a->x, b->x, size) || memcmp(a->y, b->y, size) ||
+         memcmp(a->age, b->age, size) || memcmp(a->vx0, b->vx0, size) ||
+         memcmp(a->vy0, b->vy0, size) ||
+         memcmp(a->dead, b->dead, maskWords(n) * sizeof(unsigned int));
+}
+
+int main(int argc, char** argv) {
+  unsigned long long seed = 1;
+  for(int i = 1; i < argc; i++) {
+    if(i + 1 < argc && strcmp(argv[i], "-seed") == 0) {
+      seed = strtoull(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+      return 1;
+    }
+  }
+
+  const int capacity = counts[NUM_COUNTS - 1];
+  pool_t reference, pool;
+  if(!poolInit(&reference, capacity) || !poolInit(&pool, capacity)) {
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+
+  int failures = 0;
+  for(int k = 0; k < NUM_KERNELS; k++) {
+    const integrator_t kernel = integrateSelect(vectorKernels[k]);
+    if(kernel == NULL) {
+      printf("%-6s skipped, not supported by this cpu\n", vectorKernels[k]);
+      continue;
+    }
+
+    int mismatches = 0;
+    for(int c = 0; c < NUM_COUNTS; c++) {
+      rng_t rng;
+      poolClear(&reference);
+      rngSeed(&rng, seed, c);
+      fill(&reference, counts[c], &rng);
+      run(&reference, integrateSelect("scalar"));
+
+      poolClear(&pool);
+      rngSeed(&rng, seed, c);
+      fill(&pool, counts[c], &rng);
+      run(&pool, kernel);
+
+      if(compare(&reference, &pool, counts[c]) != 0) {
+        printf("%-6s differs from scalar with %d sparks\n", vectorKernels[k], counts[c]);
+        mismatches++;
+      }
+    }
+    if(mismatches == 0) printf("%-6s matches scalar\n", vectorKernels[k]);
+    failures += mismatches;
+  }
+
+  poolFree(&reference);
+  poolFree(&pool);
+  return failures == 0 ? 0 : 1;
+}